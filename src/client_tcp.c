@@ -13,13 +13,20 @@
 
 #include "net_utils.h"
 #include "net_global.h"
+#include "net_protocol.h"
 
 void parse_arguments(
     int argc,
     char** argv,
     char** address,
     uint32_t* port,
-    uint32_t* crypto_seed
+    uint32_t* crypto_seed,
+    uint32_t* crypto_modes,
+    uint32_t* crypto_bits,
+    uint32_t* crypto_workers,
+    char** ticket_path,
+    uint32_t* caps_flags,
+    uint32_t* compression_modes
 ) {
     for ( int i = 0; i < argc; i++ ) {
         if ( argv[ i ][ 0 ] != '-' )
@@ -29,26 +36,242 @@ void parse_arguments(
             case 'p' : (*port) = parse_uint32( argv[ i ] + 2 ); break;
             case 'a' : (*address) = argv[ i ] + 2; break;
             case 's' : (*crypto_seed) = parse_uint32( argv[ i ] + 2 ); break;
+            case 'm' : (*crypto_modes) = parse_uint32( argv[ i ] + 2 ); break;
+            case 'k' : (*crypto_bits) = parse_uint32( argv[ i ] + 2 ); break;
+            case 'w' : (*crypto_workers) = parse_uint32( argv[ i ] + 2 ); break;
+            case 't' : (*ticket_path) = argv[ i ] + 2; break;
+            case 'f' : (*caps_flags) = parse_uint32( argv[ i ] + 2 ); break;
+            case 'z' : (*compression_modes) = parse_uint32( argv[ i ] + 2 ); break;
 
             default : break;
         }
     }
 }
 
+#define CLIENT_PIPELINE_DEPTH 64
+#define CLIENT_PIPELINE_BUDGET ( 64 * 1024 )
+#define CLIENT_NAME_LENGTH 256
+#define CLIENT_INPUT_LENGTH ( 16 * 1024 )
+#define CLIENT_STREAM_WINDOW ( 256 * 1024 )
+#define CLIENT_CHUNK_SIZE ( 64 * 1024 )
+#define CLIENT_HASH_MIN_SIZE ( 64 * 1024 )
+#define CLIENT_PART_SIZE ( 1024 * 1024 )
+
+/**
+ * client_request_t struct
+ * @field id request id echoed back by the server.
+ * @field command request command.
+ * @field size request message size, counted against CLIENT_PIPELINE_BUDGET.
+ * @field crc local content checksum of send requests, server checksum of pull streams.
+ * @field name file or user name the request is about.
+ * @field is_streaming true while a pull stream still has chunks to come.
+ * @field file destination file of a pull stream.
+ * @field remaining pull stream bytes not received yet.
+ * @field received pull stream bytes received since the last window update.
+ * @field stream_crc checksum of the pull stream bytes received so far.
+ * @field is_range true for a range pull, the file is updated in place from offset.
+ * @field offset first byte of a range pull.
+ * @field length bytes asked by a range pull, 0 up to the end of the entry.
+ * @field is_checked true when the local bytes before offset were hashed, the range
+ * then completes the file and is checked against crc.
+ * @field has_stat true for a list asking for the stat of each entry.
+ **/
+typedef struct client_request_t {
+    uint32_t id;
+    enet_command_t command;
+    uint32_t size;
+    uint32_t crc;
+    char name[ CLIENT_NAME_LENGTH ];
+    enet_booleans is_streaming;
+    net_file_t file;
+    uint32_t remaining;
+    uint32_t received;
+    uint32_t stream_crc;
+    enet_booleans is_range;
+    uint32_t offset;
+    uint32_t length;
+    enet_booleans is_checked;
+    enet_booleans has_stat;
+} client_request_t;
+
+/**
+ * client_resend_t struct
+ * @field name file to upload.
+ * @field missing_map chunks the server lacks, one bit per chunk, NULL to send it whole.
+ * @field map_size size of missing_map.
+ **/
+typedef struct client_resend_t {
+    char name[ CLIENT_NAME_LENGTH ];
+    uint8_t* missing_map;
+    uint32_t map_size;
+} client_resend_t;
+
+/**
+ * client_context_t struct
+ * @field request_list requests sent and waiting for their reply, oldest first.
+ * @field request_count request_list length.
+ * @field request_size sum of request_list message sizes.
+ * @field request_id id of the next request.
+ * @field control_buffer buffer for window updates, sent while a request may be built.
+ * @field caps capabilities agreed with the server during the handshake.
+ * @field compress_buffer buffer for compressed requests and decoded chunks.
+ * @field inflate_buffer buffer for the payload of compressed replies.
+ * @field resend_list files the server asked for after a send_hash, uploaded once
+ * the reply handling is over.
+ * @field resend_count resend_list length.
+ **/
 typedef struct client_context_t {
     net_socket_t socket;
-    net_crypto_key_t server_public;
-    net_crypto_key_t client_private;
+    net_crypto_session_t crypto;
     net_buffer_t cypher_buffer;
     net_buffer_t decypher_buffer;
-    net_buffer_io_t buffer_write;
-    net_buffer_io_t buffer_read;
+    client_request_t request_list[ CLIENT_PIPELINE_DEPTH ];
+    uint32_t request_count;
+    uint32_t request_size;
+    uint32_t request_id;
+    net_buffer_t control_buffer;
+    net_message_caps_t caps;
+    net_buffer_t compress_buffer;
+    net_buffer_t inflate_buffer;
+    client_resend_t resend_list[ CLIENT_PIPELINE_DEPTH ];
+    uint32_t resend_count;
 } client_context_t;
 
+enet_booleans connect_open_secret(
+    client_context_t* context,
+    net_buffer_io_t* buffer_io
+) {
+    uint32_t sealed_size = 0;
+
+    if (
+        net_buffer_io_read_uint32( buffer_io, &sealed_size ) == enet_false ||
+        sealed_size == 0 ||
+        buffer_io->head + sealed_size > buffer_io->buffer->size
+    )
+        return enet_false;
+
+    net_buffer_t sealed = net_buffer_reference( buffer_io->buffer, buffer_io->head );
+    net_buffer_resize( &sealed, sealed_size );
+
+    net_buffer_t secret;
+    memset( &secret, 0x00, sizeof( net_buffer_t ) );
+
+    if ( 
+        net_crypto_decrypt( &context->crypto.encrypt_key, &sealed, &secret ) == enet_false ||
+        secret.size < NET_CRYPTO_SECRET_SIZE
+    ) {
+        if ( net_buffer_is_valid( &secret ) == enet_true )
+            net_buffer_destroy( &secret );
+
+        return enet_false;
+    }
+
+    net_crypto_session_start_stream( &context->crypto, net_buffer_get_raw( &secret ), enet_false );
+    net_buffer_destroy( &secret );
+    net_buffer_io_jump( buffer_io, sealed_size );
+
+    return enet_true;
+}
+
+/**
+ * Ticket files hold the client key pair followed by the last ticket issued for it.
+ **/
+enet_booleans connect_load_ticket(
+    const char* path,
+    net_crypto_key_t* client_public,
+    net_crypto_key_t* client_private,
+    uint8_t ticket[ NET_CRYPTO_TICKET_SIZE ]
+) {
+    FILE* file = fopen( path, "rb" );
+
+    if ( file == NULL )
+        return enet_false;
+
+    const enet_booleans result = (
+        fread( client_public, sizeof( net_crypto_key_t ), 1, file ) == 1 &&
+        fread( client_private, sizeof( net_crypto_key_t ), 1, file ) == 1 &&
+        fread( ticket, sizeof( uint8_t ), NET_CRYPTO_TICKET_SIZE, file ) == NET_CRYPTO_TICKET_SIZE
+    ) ? enet_true : enet_false;
+
+    fclose( file );
+
+    if ( result == enet_true && net_crypto_is_key_valid( client_private ) == enet_true )
+        return enet_true;
+
+    return enet_false;
+}
+
+void connect_save_ticket(
+    const char* path,
+    const net_crypto_key_t* client_public,
+    const net_crypto_key_t* client_private,
+    const uint8_t ticket[ NET_CRYPTO_TICKET_SIZE ]
+) {
+    // The file holds the client private key, only its owner may read it.
+    const int descriptor = open( path, O_CREAT | O_WRONLY | O_TRUNC, 0600 );
+    FILE* file = NULL;
+
+    if ( descriptor >= 0 && fchmod( descriptor, 0600 ) == 0 )
+        file = fdopen( descriptor, "wb" );
+
+    if ( file == NULL ) {
+        printf( "> Can't save session ticket to %s.\n", path );
+
+        if ( descriptor >= 0 )
+            close( descriptor );
+        return;
+    }
+
+    fwrite( client_public, sizeof( net_crypto_key_t ), 1, file );
+    fwrite( client_private, sizeof( net_crypto_key_t ), 1, file );
+    fwrite( ticket, sizeof( uint8_t ), NET_CRYPTO_TICKET_SIZE, file );
+    fclose( file );
+}
+
+/**
+ * Read the ticket closing the handshake answer, it is only skipped without ticket_path.
+ **/
+enet_booleans connect_read_ticket(
+    const char* ticket_path,
+    const net_crypto_key_t* client_public,
+    const net_crypto_key_t* client_private,
+    net_buffer_io_t* buffer_io
+) {
+    uint8_t ticket[ NET_CRYPTO_TICKET_SIZE ];
+    uint32_t ticket_size = 0;
+
+    // Legacy servers and servers with tickets disabled don't issue any.
+    if ( net_buffer_io_is_eof( buffer_io ) == enet_false )
+        net_buffer_io_read_uint32( buffer_io, &ticket_size );
+
+    if ( ticket_size == 0 ) {
+        if ( ticket_path != NULL )
+            remove( ticket_path );
+
+        return enet_true;
+    }
+
+    if ( 
+        ticket_size != NET_CRYPTO_TICKET_SIZE ||
+        buffer_io->head + ticket_size > buffer_io->buffer->size ||
+        net_buffer_io_read_raw( buffer_io, (char*)ticket, ticket_size, NULL ) == enet_false
+    )
+        return enet_false;
+
+    if ( ticket_path != NULL )
+        connect_save_ticket( ticket_path, client_public, client_private, ticket );
+
+    return enet_true;
+}
+
 enet_booleans connect_to(
     client_context_t* context,
     const char* address,
-    uint32_t port
+    uint32_t port,
+    uint32_t crypto_modes,
+    uint32_t caps_flags,
+    uint32_t compression_modes,
+    const char* ticket_path
 ) {
     if ( net_socket_create_client( &context->socket, address, port, enet_socket_tcp ) == enet_false )
         return enet_false;
@@ -56,14 +279,21 @@ enet_booleans connect_to(
     net_buffer_t buffer;
     memset( &buffer, 0x00, sizeof( net_buffer_t ) );
 
-    if ( net_buffer_create( &buffer, 2 * sizeof(uint64_t) ) == enet_false ) {
+    if ( net_buffer_create( &buffer, 2 * sizeof(uint64_t) + 2 * sizeof( uint32_t ) + NET_CRYPTO_TICKET_SIZE ) == enet_false ) {
         net_socket_destroy( &context->socket );
         return enet_false;
     }
 
     net_crypto_key_t client_public;
+    uint8_t ticket[ NET_CRYPTO_TICKET_SIZE ];
+    uint32_t ticket_size = ( ticket_path != NULL ) ? 0 : NET_CRYPTO_TICKET_NONE;
 
-    if ( net_crypto_generate_keys( &client_public, &context->client_private ) == enet_false ) {
+    net_crypto_session_init( &context->crypto );
+
+    // A stored ticket brings back the key pair it was issued to, no keygen needed.
+    if ( ticket_path != NULL && connect_load_ticket( ticket_path, &client_public, &context->crypto.encrypt_key, ticket ) == enet_true )
+        ticket_size = NET_CRYPTO_TICKET_SIZE;
+    else if ( net_crypto_generate_keys( &client_public, &context->crypto.encrypt_key ) == enet_false ) {
         net_buffer_destroy( &buffer );
         net_socket_destroy( &context->socket );
         return enet_false;
@@ -71,9 +301,19 @@ enet_booleans connect_to(
 
     net_buffer_io_t buffer_io = net_buffer_io_acquire( &buffer, enet_buffer_io_read_write );
 
+    // The ticket field is always sent so the caps block after it has a fixed place.
+    const net_message_caps_t client_caps = { 
+        NET_FRAME_VERSION, caps_flags, NET_CAPS_MAX_FRAME, 
+        CLIENT_CHUNK_SIZE, compression_modes, CLIENT_PIPELINE_DEPTH 
+    };
+
     if (
         net_buffer_io_write_uint64( &buffer_io, client_public.exponent ) == enet_false ||
         net_buffer_io_write_uint64( &buffer_io, client_public.modulus ) == enet_false ||
+        net_buffer_io_write_uint32( &buffer_io, crypto_modes ) == enet_false ||
+        net_buffer_io_write_uint32( &buffer_io, ticket_size ) == enet_false ||
+        ( ticket_size == NET_CRYPTO_TICKET_SIZE && net_buffer_io_write_raw( &buffer_io, (const char*)ticket, ticket_size, NULL ) == enet_false ) ||
+        net_message_caps_write( &buffer, &client_caps ) == enet_false ||
         net_socket_send( &context->socket, &buffer ) == enet_false
     ) {
         net_buffer_destroy( &buffer );
@@ -85,19 +325,80 @@ enet_booleans connect_to(
 
     if ( 
         net_socket_recv( &context->socket, &buffer ) == enet_false ||
-        net_buffer_io_read_uint64( &buffer_io, &context->server_public.exponent ) == enet_false ||
-        net_buffer_io_read_uint64( &buffer_io, &context->server_public.modulus ) == enet_false 
+        net_buffer_io_read_uint64( &buffer_io, &context->crypto.decrypt_key.exponent ) == enet_false ||
+        net_buffer_io_read_uint64( &buffer_io, &context->crypto.decrypt_key.modulus ) == enet_false 
     ) {
         net_buffer_destroy( &buffer );
         net_socket_destroy( &context->socket );
         return enet_false;
     }
+
+    net_crypto_key_prepare( &context->crypto.decrypt_key );
+
+    // Legacy servers only answer with their public key, stay on RSA-TOY blocks.
+    uint32_t mode = enet_crypto_rsa;
+
+    if ( net_buffer_io_is_eof( &buffer_io ) == enet_false )
+        net_buffer_io_read_uint32( &buffer_io, &mode );
+
+    if ( ( mode & crypto_modes ) == 0 ) {
+        printf( "> Server selected an unsupported cipher mode %u.\n", mode );
+        net_buffer_destroy( &buffer );
+        net_socket_destroy( &context->socket );
+        return enet_false;
+    }
+
+    context->crypto.mode = (enet_crypto_modes)mode;
+
+    if ( mode == enet_crypto_chacha20 && connect_open_secret( context, &buffer_io ) == enet_false ) {
+        net_buffer_destroy( &buffer );
+        net_socket_destroy( &context->socket );
+        return enet_false;
+    }
+
+    if ( connect_read_ticket( ticket_path, &client_public, &context->crypto.encrypt_key, &buffer_io ) == enet_false ) {
+        net_buffer_destroy( &buffer );
+        net_socket_destroy( &context->socket );
+        return enet_false;
+    }
+
+    // Servers answering without caps block get the conservative legacy set.
+    net_message_caps_t server_caps;
+
+    if ( net_caps_read( &buffer_io, &server_caps ) == enet_true )
+        context->caps = net_caps_select( &client_caps, &server_caps );
+    else
+        context->caps = net_caps_legacy( );
+
+    net_buffer_destroy( &buffer );
     
     return enet_true;
 }
 
+void print_help( ) {
+    printf( "> Commands :\n" );
+    printf( "> name user_name -> Set the current user name, must be the first command.\n" );
+    printf( "> send file_name -> Send file to the server for the current user.\n" );
+    printf( "> list -> List all file for the current user\n" );
+    printf( "> list -l -> List all file with their size, write time and record offset.\n" );
+    printf( "> stat file_name -> Show the size, checksum and write time of a file without pulling it.\n" );
+    printf( "> pull file_name -> Pull a file from the server for the current user.\n" );
+    printf( "> pull_range file_name offset [length] -> Pull a byte range of a file, written in place.\n" );
+    printf( "> resume file_name -> Pull the rest of a file a lost connection interrupted.\n" );
+    printf( "> send_many file_name ... -> Send several files in one request.\n" );
+    printf( "> pull_many file_name ... -> Pull several files in one request.\n" );
+    printf( "> command; command; ... -> Send commands back to back, replies come as they are ready.\n" );
+}
+
 enet_command_t parse_command( const net_buffer_t* input_buffer ) {
-    if ( net_buffer_contain( input_buffer, "send" ) == enet_true )
+    // Matched as a prefix only, stat is a common part of file names.
+    if ( strncmp( (const char*)input_buffer->data, "stat ", 5 ) == 0 )
+        return enet_command_stat;
+    else if ( net_buffer_contain( input_buffer, "send_many" ) == enet_true )
+        return enet_command_send_many;
+    else if ( net_buffer_contain( input_buffer, "pull_many" ) == enet_true )
+        return enet_command_pull_many;
+    else if ( net_buffer_contain( input_buffer, "send" ) == enet_true )
         return enet_command_send;
     else if ( net_buffer_contain( input_buffer, "list" ) == enet_true )
         return enet_command_list;
@@ -105,208 +406,1150 @@ enet_command_t parse_command( const net_buffer_t* input_buffer ) {
         return enet_command_pull;
     else if ( net_buffer_contain( input_buffer, "name" ) == enet_true )
         return enet_command_name;
+    else if ( net_buffer_contain( input_buffer, "resume" ) == enet_true )
+        return enet_command_pull;
 
     return enet_command_quit;
 }
 
-enet_booleans net_send( client_context_t* context ) {
-    assert( context != NULL );
+enet_booleans net_send( client_context_t* context ) {
+    assert( context != NULL );
+
+    const net_buffer_t* buffer = &context->decypher_buffer;
+
+    // Compressed before encryption, the cipher then has less to go through.
+    if ( 
+        ( context->caps.compression & enet_compression_lz ) && 
+        net_frame_compress( buffer, &context->compress_buffer ) == enet_true 
+    )
+        buffer = &context->compress_buffer;
+
+    return net_socket_send_encrypted( &context->socket, &context->crypto, buffer );
+}
+
+enet_booleans net_recv( client_context_t* context ) {
+    assert( context != NULL );
+
+    // Replies are bound by the negotiated frame size, the default one before the handshake.
+    const uint32_t max_frame = ( context->caps.max_frame > 0 ) ? context->caps.max_frame : NET_CAPS_MAX_FRAME;
+
+    return net_socket_recv_decrypted( &context->socket, &context->crypto, &context->cypher_buffer, max_frame );
+}
+
+net_frame_header_t client_header( const client_context_t* context, const enet_command_t command, const uint8_t flags ) {
+    return net_frame_header( command, flags, context->request_id );
+}
+
+enet_booleans client_on_reply( client_context_t* context, client_request_t* request, net_frame_t* frame );
+
+/**
+ * The request in flight of the given id, NULL once answered or when it wasn't posted.
+ **/
+client_request_t* client_find_request( client_context_t* context, const uint32_t id ) {
+    for ( uint32_t i = 0; i < context->request_count; i++ ) {
+        if ( context->request_list[ i ].id == id )
+            return context->request_list + i;
+    }
+
+    return NULL;
+}
+
+/**
+ * Receive the next reply and hand it to the request it answers.
+ **/
+enet_booleans client_receive( client_context_t* context ) {
+    if ( net_recv( context ) == enet_false ) {
+        printf( "> Connection lost.\n" );
+        return enet_false;
+    }
+
+    net_frame_t frame;
+
+    if ( net_frame_decode( &context->cypher_buffer, &frame ) == enet_false ) {
+        printf( "> Invalid reply ( version %u ).\n", frame.header.version );
+        return enet_false;
+    }
+
+    if ( net_frame_inflate( &frame, &context->inflate_buffer, context->caps.max_frame ) == enet_false ) {
+        printf( "> Corrupted compressed reply.\n" );
+        return enet_false;
+    }
+
+    const uint32_t id = frame.header.request_id;
+    uint32_t index = 0;
+
+    while ( index < context->request_count && context->request_list[ index ].id != id )
+        index += 1;
+
+    if ( index == context->request_count ) {
+        printf( "> Reply to unknown request %u.\n", id );
+        return enet_false;
+    }
+
+    client_request_t* request = context->request_list + index;
+
+    const enet_booleans result = client_on_reply( context, request, &frame );
+
+    // Pull streams answer with several frames, the request lives until the last one.
+    if ( request->is_streaming == enet_false ) {
+        context->request_count -= 1;
+        context->request_size  -= request->size;
+
+        memmove( 
+            request, request + 1, 
+            ( context->request_count - index ) * sizeof( client_request_t ) 
+        );
+    }
+
+    return result;
+}
+
+/**
+ * Wait for the replies of every request in flight.
+ **/
+enet_booleans client_drain( client_context_t* context ) {
+    enet_booleans result = enet_true;
+
+    while ( context->request_count > 0 ) {
+        if ( client_receive( context ) == enet_false )
+            result = enet_false;
+
+        if ( net_socket_is_valid( &context->socket ) == enet_false )
+            return enet_false;
+    }
+
+    return result;
+}
+
+/**
+ * Send the request encoded in decypher_buffer without waiting for its reply. Replies
+ * are received first while the pipeline is full, or while the request would
+ * overflow the socket buffers as the server may be blocked writing earlier replies.
+ **/
+enet_booleans client_post(
+    client_context_t* context,
+    const enet_command_t command,
+    const char* name,
+    const uint32_t crc
+) {
+    const uint32_t size = context->decypher_buffer.size;
+
+    if ( size > context->caps.max_frame ) {
+        printf( "> Request of %u bytes over the server limit of %u bytes.\n", size, context->caps.max_frame );
+        return enet_true;
+    }
+
+    while ( 
+        context->request_count > 0 && (
+            context->request_count >= context->caps.pipeline_depth ||
+            context->request_size + size > CLIENT_PIPELINE_BUDGET
+        )
+    ) {
+        if ( client_receive( context ) == enet_false )
+            return enet_false;
+    }
+
+    if ( net_send( context ) == enet_false ) {
+        printf( "> Connection lost.\n" );
+        return enet_false;
+    }
+
+    client_request_t* request = context->request_list + context->request_count++;
+
+    memset( request, 0x00, sizeof( client_request_t ) );
+
+    request->id      = context->request_id++;
+    request->command = command;
+    request->size    = size;
+    request->crc     = crc;
+
+    if ( name != NULL )
+        strncpy( request->name, name, CLIENT_NAME_LENGTH - 1 );
+
+    context->request_size += size;
+
+    return enet_true;
+}
+
+/**
+ * client_chunk_t struct
+ * @field hash SHA-256 of the chunk content.
+ * @field offset chunk position in the file.
+ * @field size chunk size, see net_cdc_cut.
+ **/
+typedef struct client_chunk_t {
+    uint8_t hash[ NET_SHA256_SIZE ];
+    uint32_t offset;
+    uint32_t size;
+} client_chunk_t;
+
+enet_booleans client_chunk_is_missing( const uint8_t* missing_map, const uint32_t map_size, const uint32_t index ) {
+    if ( missing_map == NULL )
+        return enet_false;
+
+    return ( index / 8 >= map_size || ( missing_map[ index / 8 ] & ( 1 << ( index % 8 ) ) ) ) ? enet_true : enet_false;
+}
+
+/**
+ * Upload the missing chunks ahead of the send_delta as put_chunks parts of about
+ * CLIENT_PART_SIZE bytes. The server keeps every part it received, after a lost
+ * connection sending the file again only uploads the chunks still missing.
+ **/
+enet_booleans client_put_chunks( 
+    client_context_t* context, 
+    const char* path, 
+    const uint8_t* data,
+    const client_chunk_t* chunk_list,
+    const uint32_t count,
+    const uint8_t* missing_map,
+    const uint32_t map_size
+) {
+    uint32_t part_count = 0;
+    uint32_t index = 0;
+
+    while ( index < count ) {
+        if ( net_frame_encode( &context->decypher_buffer, client_header( context, enet_command_put_chunks, 0 ) ) == enet_false )
+            return enet_false;
+
+        uint32_t part_size = 0;
+
+        for ( ; index < count && part_size < CLIENT_PART_SIZE; index++ ) {
+            const client_chunk_t* chunk = chunk_list + index;
+
+            if ( client_chunk_is_missing( missing_map, map_size, index ) == enet_false )
+                continue;
+
+            const net_message_delta_item_t item = { 
+                { chunk->hash, NET_SHA256_SIZE }, chunk->size, { data + chunk->offset, chunk->size } 
+            };
+
+            if ( net_message_delta_item_write( &context->decypher_buffer, &item ) == enet_false ) {
+                printf( "> Can't create buffer to send data.\n" );
+                return enet_false;
+            }
+
+            part_size += chunk->size;
+        }
+
+        if ( part_size == 0 )
+            break;
+
+        net_frame_seal( &context->decypher_buffer );
+
+        if ( client_post( context, enet_command_put_chunks, path, 0 ) == enet_false )
+            return enet_false;
+
+        part_count += 1;
+    }
+
+    printf( "> Uploaded %s in %u parts.\n", path, part_count );
+
+    return enet_true;
+}
+
+/**
+ * Announce a file by the chunk list of its content, the server links it when it
+ * has every chunk and answers with the ones it lacks otherwise. With a missing_map,
+ * the chunks it flags are uploaded as a send_delta, the server has the others.
+ * Large uploads go first as put_chunks parts, the send_delta then only links them.
+ **/
+enet_booleans client_send_chunks( 
+    client_context_t* context, 
+    const char* path, 
+    net_file_t* file,
+    const uint8_t* missing_map,
+    const uint32_t map_size
+) {
+    net_buffer_t content;
+    memset( &content, 0x00, sizeof( net_buffer_t ) );
+
+    const uint32_t max_count = file->size / NET_CDC_MIN_SIZE + 1;
+    client_chunk_t* chunk_list = malloc( max_count * sizeof( client_chunk_t ) );
+
+    if ( chunk_list == NULL || net_buffer_create( &content, file->size ) == enet_false ) {
+        printf( "> Can't create buffer to hash %s.\n", path );
+        free( chunk_list );
+        return enet_false;
+    }
+
+    net_buffer_resize( &content, file->size );
+    net_file_read( file, &content );
+
+    const uint8_t* data = net_buffer_get_raw( &content );
+    uint32_t count = 0;
+    uint32_t upload_count = 0;
+    uint32_t upload_size = 0;
+
+    for ( uint32_t offset = 0; offset < file->size; count++ ) {
+        client_chunk_t* chunk = chunk_list + count;
+
+        chunk->offset = offset;
+        chunk->size = net_cdc_cut( data + offset, file->size - offset );
+
+        net_sha256( data + offset, chunk->size, chunk->hash );
+
+        if ( client_chunk_is_missing( missing_map, map_size, count ) == enet_true ) {
+            upload_count += 1;
+            upload_size += chunk->size;
+        }
+
+        offset += chunk->size;
+    }
+
+    if ( missing_map != NULL )
+        printf( "> Uploading %u of the %u chunks of %s.\n", upload_count, count, path );
+
+    const enet_booleans is_parted = ( 
+        ( context->caps.flags & NET_CAPS_FLAG_RESUME ) && upload_size > CLIENT_PART_SIZE 
+    ) ? enet_true : enet_false;
+
+    enet_booleans result = enet_true;
+
+    if ( is_parted == enet_true )
+        result = client_put_chunks( context, path, data, chunk_list, count, missing_map, map_size );
+
+    const enet_command_t command = ( missing_map != NULL ) ? enet_command_send_delta : enet_command_send_hash;
+    const net_message_send_hash_t message = { net_frame_str( path ), file->size, net_crc32c( data, file->size ) };
+
+    if ( result == enet_true )
+        result = net_message_send_hash_encode( &context->decypher_buffer, client_header( context, command, 0 ), &message );
+
+    for ( uint32_t i = 0; result == enet_true && i < count; i++ ) {
+        const client_chunk_t* chunk = chunk_list + i;
+
+        if ( missing_map != NULL ) {
+            const enet_booleans is_sent = ( 
+                is_parted == enet_false && client_chunk_is_missing( missing_map, map_size, i ) == enet_true 
+            ) ? enet_true : enet_false;
+            const net_message_delta_item_t item = { 
+                { chunk->hash, NET_SHA256_SIZE }, chunk->size, { data + chunk->offset, ( is_sent == enet_true ) ? chunk->size : 0 } 
+            };
+
+            result = net_message_delta_item_write( &context->decypher_buffer, &item );
+        } else {
+            const net_message_chunk_ref_t ref = { { chunk->hash, NET_SHA256_SIZE }, chunk->size };
+
+            result = net_message_chunk_ref_write( &context->decypher_buffer, &ref );
+        }
+    }
+
+    net_buffer_destroy( &content );
+    free( chunk_list );
+
+    if ( result == enet_false ) {
+        printf( "> Can't create buffer to send data.\n" );
+        return enet_false;
+    }
+
+    net_frame_seal( &context->decypher_buffer );
+
+    return client_post( context, command, path, message.crc );
+}
+
+/**
+ * Send the file at path, announced by its hashes first when the server takes them.
+ **/
+enet_booleans client_send_file( client_context_t* context, const char* path, const enet_booleans use_hash ) {
+    net_file_t file;
+    memset( &file, 0x00, sizeof( net_file_t ) );
+
+    struct stat st;
+    if ( stat( path, &st ) != 0 || !S_ISREG( st.st_mode ) ) {
+        printf( "> You can't send a directory.\n" );
+        return enet_true;
+    }
+
+    if ( net_file_open( &file, enet_buffer_io_read, path ) == enet_false ) {
+        printf( "> File %s can't be sent.\n", path );
+        return enet_true;
+    }
+
+    if ( 
+        use_hash == enet_true && 
+        ( context->caps.flags & NET_CAPS_FLAG_HASH ) && 
+        file.size >= CLIENT_HASH_MIN_SIZE 
+    ) {
+        const enet_booleans result = client_send_chunks( context, path, &file, NULL, 0 );
+
+        net_file_close( &file );
+
+        return result;
+    }
+
+    // The content is read from the file straight into the frame.
+    const net_message_send_t message = { net_frame_str( path ), { NULL, file.size } };
+
+    if ( net_message_send_encode( &context->decypher_buffer, client_header( context, enet_command_send, 0 ), &message ) == enet_false ) {
+        printf( "> Can't create buffer to send data.\n" );
+        net_file_close( &file );
+        return enet_false;
+    }
+
+    net_buffer_t content = net_buffer_reference( &context->decypher_buffer, context->decypher_buffer.size - file.size );
+
+    net_file_read( &file, &content );
+    net_file_close( &file );
+
+    return client_post( context, enet_command_send, path, net_crc32c( content.data, content.size ) );
+}
+
+enet_booleans client_send( client_context_t* context, net_buffer_t* input_buffer ) {
+    const uint32_t cmd_length = 5;
+    const uint32_t length = (uint32_t)strlen( (const char*)input_buffer->data );
+
+    if ( length <= cmd_length ) {
+        printf( "> You can't send file without givin its path.\n" );
+        return enet_true;
+    }
+
+    return client_send_file( context, (const char*)input_buffer->data + cmd_length, enet_true );
+}
+
+/**
+ * Upload the files the server asked for, a request can't be posted while a reply
+ * is handled.
+ **/
+enet_booleans client_resend( client_context_t* context ) {
+    while ( context->resend_count > 0 ) {
+        client_resend_t resend = context->resend_list[ --context->resend_count ];
+        enet_booleans result = enet_true;
+
+        if ( resend.missing_map == NULL )
+            result = client_send_file( context, resend.name, enet_false );
+        else {
+            net_file_t file;
+            memset( &file, 0x00, sizeof( net_file_t ) );
+
+            if ( net_file_open( &file, enet_buffer_io_read, resend.name ) == enet_false )
+                printf( "> File %s can't be sent.\n", resend.name );
+            else {
+                result = client_send_chunks( context, resend.name, &file, resend.missing_map, resend.map_size );
+                net_file_close( &file );
+            }
+
+            free( resend.missing_map );
+        }
+
+        if ( result == enet_false )
+            return enet_false;
+    }
+
+    return enet_true;
+}
+
+enet_booleans client_send_reply( const client_request_t* request, net_frame_t* frame ) {
+    const uint32_t status = frame->header.command;
+
+    if ( status == enet_command_ok ) {
+        net_message_checksum_t message;
+
+        if ( net_message_checksum_decode( frame, &message ) == enet_false ) {
+            printf( "> Sending of %s, invalid reply.\n", request->name );
+            return enet_true;
+        }
+
+        if ( message.crc != request->crc ) {
+            printf( "> Sending of %s corrupted, crc32c %08x stored instead of %08x.\n", request->name, message.crc, request->crc );
+            return enet_true;
+        }
+
+        printf( "> Sending of %s succeded ( crc32c %08x ).\n", request->name, request->crc );
+        return enet_true;
+    } else if ( status == enet_command_bad_name ) {
+        printf( "> You must set your name with \"name\" command before using send.\n" );
+        return enet_true;
+    } else if ( status == enet_command_bad ) {
+        printf( "> Server can't store %s.\n", request->name );
+        return enet_true;
+    }
+    
+    printf( "> Sending failed.\n" );
+
+    return enet_false;
+}
+
+enet_booleans client_put_chunks_reply( const client_request_t* request, net_frame_t* frame ) {
+    if ( frame->header.command != enet_command_ok )
+        printf( "> Server can't store a part of %s.\n", request->name );
+
+    return enet_true;
+}
+
+enet_booleans client_send_hash_reply( client_context_t* context, const client_request_t* request, net_frame_t* frame ) {
+    if ( frame->header.command != enet_command_missing ) {
+        if ( frame->header.command == enet_command_ok )
+            printf( "> %s already on the server, nothing to upload.\n", request->name );
+
+        return client_send_reply( request, frame );
+    }
+
+    if ( context->resend_count == CLIENT_PIPELINE_DEPTH ) {
+        printf( "> Too many uploads pending, %s not sent.\n", request->name );
+        return enet_true;
+    }
+
+    client_resend_t* resend = context->resend_list + context->resend_count++;
+    net_message_missing_t message;
+
+    memcpy( resend->name, request->name, CLIENT_NAME_LENGTH );
+    resend->missing_map = NULL;
+    resend->map_size = 0;
+
+    // Without delta support, or for an unreadable reply, the file is sent whole.
+    if ( 
+        ( context->caps.flags & NET_CAPS_FLAG_DELTA ) &&
+        net_message_missing_decode( frame, &message ) == enet_true &&
+        message.bitmap.size > 0 
+    ) {
+        resend->missing_map = malloc( message.bitmap.size );
+
+        if ( resend->missing_map != NULL ) {
+            memcpy( resend->missing_map, message.bitmap.data, message.bitmap.size );
+            resend->map_size = message.bitmap.size;
+        }
+    }
+
+    return enet_true;
+}
+
+enet_booleans client_list( client_context_t* context, net_buffer_t* input_buffer ) {
+    const enet_booleans has_stat = ( 
+        strcmp( (const char*)input_buffer->data, "list -l" ) == 0 && ( context->caps.flags & NET_CAPS_FLAG_STAT ) 
+    ) ? enet_true : enet_false;
+    const uint8_t flags = ( has_stat == enet_true ) ? NET_FRAME_FLAG_STAT : 0;
+
+    if ( net_frame_encode( &context->decypher_buffer, client_header( context, enet_command_list, flags ) ) == enet_false )
+        return enet_false;
+
+    const uint32_t id = context->request_id;
+
+    if ( client_post( context, enet_command_list, NULL, 0 ) == enet_false )
+        return enet_false;
+
+    client_request_t* request = client_find_request( context, id );
+
+    if ( request != NULL )
+        request->has_stat = has_stat;
+
+    return enet_true;
+}
+
+/**
+ * Print the stat of an entry, the time in local time.
+ **/
+void client_print_stat( const char* name, const net_message_stat_t* stat ) {
+    char label[ 64 ] = "unknown";
+    const time_t seconds = (time_t)stat->time;
+    struct tm local;
+
+    if ( stat->time > 0 && localtime_r( &seconds, &local ) != NULL )
+        strftime( label, sizeof( label ), "%Y-%m-%d %H:%M:%S", &local );
+
+    printf( 
+        "> Entry : %s ( %u bytes, crc32c %08x, written %s, record at %u )\n", 
+        name, stat->size, stat->crc, label, stat->offset 
+    );
+}
+
+enet_booleans client_list_reply( const client_request_t* request, net_frame_t* frame ) {
+    const uint32_t status = frame->header.command;
+
+    if ( status == enet_command_bad ) {
+        printf( "> No entries in the file.\n" );
+        return enet_true;
+    } else if ( status == enet_command_bad_name ) {
+        printf( "> You must set your name with \"name\" command before using list.\n" );
+        return enet_true;
+    } else if ( status != enet_command_ok ) {
+        printf( "> Unknow error.\n" );
+        return enet_true;
+    }
+
+    while ( frame->head < frame->end ) {
+        net_message_list_entry_t message;
+
+        if ( net_message_list_entry_decode( frame, &message ) == enet_false ) {
+            printf( "> Error during listing.\n" );
+            return enet_false;
+        }
+
+        if ( request->has_stat == enet_true ) {
+            net_message_stat_t stat;
+
+            if ( net_message_stat_decode( frame, &stat ) == enet_false ) {
+                printf( "> Error during listing.\n" );
+                return enet_false;
+            }
+
+            client_print_stat( message.name.data, &stat );
+            continue;
+        }
+        
+        printf( "> Entry : %s ( crc32c %08x )\n", message.name.data, message.crc );
+    }
+
+    return enet_true;
+}
+
+/**
+ * Size and checksum of the local copy of a file, the validator of a pull.
+ * @return : enet_false when there is no readable local copy.
+ **/
+enet_booleans client_read_validator( const char* path, net_message_validator_t* validator ) {
+    struct stat st;
+
+    if ( stat( path, &st ) != 0 || !S_ISREG( st.st_mode ) )
+        return enet_false;
+
+    FILE* file = fopen( path, "rb" );
+
+    if ( file == NULL )
+        return enet_false;
+
+    uint8_t block[ 16 * 1024 ];
+    size_t readed = 0;
+
+    validator->size = 0;
+    validator->crc  = 0;
+
+    while ( ( readed = fread( block, sizeof( uint8_t ), sizeof( block ), file ) ) > 0 ) {
+        validator->crc   = net_crc32c_update( validator->crc, block, readed );
+        validator->size += (uint32_t)readed;
+    }
+
+    fclose( file );
+
+    return ( validator->size == (uint32_t)st.st_size ) ? enet_true : enet_false;
+}
+
+/**
+ * Post a pull of name, of the length bytes from offset when is_range is set. Whole
+ * pulls of a file already there carry its validator, the server only answers
+ * not_modified when its entry is the same.
+ **/
+enet_booleans client_pull_post( 
+    client_context_t* context, 
+    const char* name, 
+    const enet_booleans is_range, 
+    const uint32_t offset, 
+    const uint32_t length 
+) {
+    const net_message_pull_t message = { net_frame_str( name ), CLIENT_STREAM_WINDOW };
+    const net_message_range_t range = { offset, length };
+    net_message_validator_t validator = { 0, 0 };
+    uint8_t flags = ( context->caps.flags & NET_CAPS_FLAG_STREAM ) ? NET_FRAME_FLAG_STREAM : 0;
+
+    if ( is_range == enet_true )
+        flags |= NET_FRAME_FLAG_RANGE;
+    else if ( 
+        ( context->caps.flags & NET_CAPS_FLAG_VALIDATE ) && 
+        client_read_validator( name, &validator ) == enet_true 
+    )
+        flags |= NET_FRAME_FLAG_VALIDATOR;
+
+    if ( net_message_pull_encode( &context->decypher_buffer, client_header( context, enet_command_pull, flags ), &message ) == enet_false )
+        return enet_false;
+
+    if ( 
+        ( ( flags & NET_FRAME_FLAG_RANGE ) && net_message_range_write( &context->decypher_buffer, &range ) == enet_false ) ||
+        ( ( flags & NET_FRAME_FLAG_VALIDATOR ) && net_message_validator_write( &context->decypher_buffer, &validator ) == enet_false )
+    )
+        return enet_false;
+
+    net_frame_seal( &context->decypher_buffer );
+
+    const uint32_t id = context->request_id;
+
+    if ( client_post( context, enet_command_pull, name, validator.crc ) == enet_false )
+        return enet_false;
+
+    client_request_t* request = client_find_request( context, id );
+
+    if ( request != NULL ) {
+        request->is_range = is_range;
+        request->offset   = offset;
+        request->length   = length;
+    }
+
+    return enet_true;
+}
+
+/**
+ * Pull a byte range of a file, as pull_range file_name offset [length].
+ **/
+enet_booleans client_pull_range( client_context_t* context, char* arguments ) {
+    char* state = NULL;
+    char* name = strtok_r( arguments, " ", &state );
+    char* offset = strtok_r( NULL, " ", &state );
+    char* length = strtok_r( NULL, " ", &state );
+
+    if ( name == NULL || offset == NULL ) {
+        printf( "> You can't pull a range without givin the entry name and offset.\n" );
+        return enet_true;
+    }
+
+    return client_pull_post( context, name, enet_true, parse_uint32( offset ), ( length != NULL ) ? parse_uint32( length ) : 0 );
+}
+
+/**
+ * Pull the bytes of a file past the local copy, the whole file is then checked.
+ **/
+enet_booleans client_resume( client_context_t* context, const char* name ) {
+    struct stat st;
+    uint32_t offset = 0;
+
+    if ( stat( name, &st ) == 0 && S_ISREG( st.st_mode ) )
+        offset = (uint32_t)st.st_size;
+
+    printf( "> Resuming %s from byte %u.\n", name, offset );
+
+    return client_pull_post( context, name, enet_true, offset, 0 );
+}
+
+enet_booleans client_pull( client_context_t* context, net_buffer_t* input_buffer ) {
+    char* input = (char*)input_buffer->data;
+    const enet_booleans is_range  = ( strncmp( input, "pull_range", 10 ) == 0 ) ? enet_true : enet_false;
+    const enet_booleans is_resume = ( strncmp( input, "resume", 6 ) == 0 ) ? enet_true : enet_false;
+    const uint32_t cmd_length = ( is_range == enet_true ) ? 11 : ( is_resume == enet_true ) ? 7 : 5;
+    const uint32_t length = (uint32_t)strlen( input );
+
+    if ( length <= cmd_length ) {
+        printf( "> You can't pull file without givin its entry name.\n" );
+        return enet_true;
+    }
+
+    if ( ( is_range == enet_true || is_resume == enet_true ) && ( context->caps.flags & NET_CAPS_FLAG_RESUME ) == 0 ) {
+        printf( "> Server doesn't support range pulls, use pull.\n" );
+        return enet_true;
+    }
+
+    if ( is_range == enet_true )
+        return client_pull_range( context, input + cmd_length );
+    else if ( is_resume == enet_true )
+        return client_resume( context, input + cmd_length );
+
+    return client_pull_post( context, input + cmd_length, enet_false, 0, 0 );
+}
+
+/**
+ * Grant the server the bytes consumed since the last update of a pull stream.
+ **/
+enet_booleans client_send_window( client_context_t* context, client_request_t* request ) {
+    const net_message_window_t message = { request->received };
+
+    if ( net_message_window_encode( &context->control_buffer, net_frame_header( enet_command_window, 0, request->id ), &message ) == enet_false )
+        return enet_false;
+
+    request->received = 0;
+
+    return net_socket_send_encrypted( &context->socket, &context->crypto, &context->control_buffer );
+}
+
+/**
+ * Open the destination of a range pull, positioned on its offset. When the range runs
+ * to the end, the local bytes before it are hashed so the whole file is checked.
+ **/
+void client_pull_open_range( client_request_t* request ) {
+    FILE* file = fopen( request->name, "r+b" );
+
+    if ( file == NULL )
+        file = fopen( request->name, "w+b" );
+
+    request->file.file = file;
+    request->file.mode = enet_buffer_io_read_write;
+    request->is_checked = ( request->length == 0 ) ? enet_true : enet_false;
+
+    if ( file == NULL ) {
+        printf( "> Can't open destination file %s\n", request->name );
+        return;
+    }
+
+    uint8_t block[ 16 * 1024 ];
+    uint32_t left = ( request->is_checked == enet_true ) ? request->offset : 0;
+
+    while ( left > 0 ) {
+        const size_t readed = fread( block, sizeof( uint8_t ), ( left < sizeof( block ) ) ? left : sizeof( block ), file );
+
+        if ( readed == 0 )
+            break;
+
+        request->stream_crc = net_crc32c_update( request->stream_crc, block, readed );
+        left -= (uint32_t)readed;
+    }
+
+    // A local copy shorter than the offset leaves a hole, the file can't be checked.
+    if ( left > 0 )
+        request->is_checked = enet_false;
+
+    fseeko( file, (off_t)request->offset, SEEK_SET );
+}
+
+/**
+ * Start receiving an entry content of size bytes. The items of a pull_many share
+ * their stream window, bytes not granted back yet carry over to the next item.
+ **/
+void client_pull_begin( client_request_t* request, const uint32_t size, const uint32_t crc ) {
+    request->is_streaming = enet_true;
+    request->remaining    = size;
+    request->crc          = crc;
+    request->stream_crc   = 0;
+
+    if ( request->command != enet_command_pull_many )
+        request->received = 0;
+
+    if ( request->is_range == enet_true )
+        client_pull_open_range( request );
+    else if ( net_file_open( &request->file, enet_buffer_io_write, request->name ) == enet_false )
+        printf( "> Can't create destination file %s\n", request->name );
+}
+
+void client_pull_abort( client_request_t* request ) {
+    net_file_close( &request->file );
+
+    request->is_streaming = enet_false;
+}
+
+void client_pull_finish( client_request_t* request ) {
+    const char* name = request->name;
+
+    request->is_streaming = enet_false;
+
+    if ( net_file_is_valid( &request->file ) == enet_false )
+        return;
+
+    if ( request->is_range == enet_true ) {
+        const off_t end = ftello( request->file.file );
+
+        // A range up to the end drops whatever an older local copy had past it.
+        if ( request->length == 0 && ftruncate( fileno( request->file.file ), end ) != 0 )
+            printf( "> Can't truncate file %s.\n", name );
+
+        if ( request->is_checked == enet_false ) {
+            net_file_close( &request->file );
+
+            printf( "> File %s bytes %u to %u written.\n", name, request->offset, (uint32_t)end );
+            return;
+        }
+    }
+
+    net_file_close( &request->file );
+
+    if ( request->stream_crc != request->crc ) {
+        printf( "> File %s corrupted, crc32c %08x instead of %08x.\n", name, request->stream_crc, request->crc );
+        return;
+    }
+
+    printf( "> File %s writing completed ( crc32c %08x ).\n", name, request->stream_crc );
+}
+
+enet_booleans client_pull_chunk( client_context_t* context, client_request_t* request, net_frame_t* frame ) {
+    net_message_chunk_t message;
+    net_message_chunk_decode( frame, &message );
+
+    const uint32_t received = message.content.size;
+    net_frame_blob_t content = message.content;
+
+    // Stored chunks come as their LZ encoding, each one decoded on its own.
+    if ( frame->header.flags & NET_FRAME_FLAG_ENCODED ) {
+        net_buffer_t* raw = &context->compress_buffer;
+
+        content.size = net_lz_get_raw_size( message.content.data, message.content.size );
+        raw->size = 0;
+
+        if ( 
+            content.size == 0 || content.size > request->remaining ||
+            net_buffer_reserve( raw, content.size ) == enet_false ||
+            net_lz_decode( message.content.data, message.content.size, net_buffer_get_raw( raw ) ) == enet_false
+        )
+            content.size = UINT32_MAX;
+        else
+            content.data = net_buffer_get_raw( raw );
+    }
+
+    const uint32_t length = content.size;
+
+    if ( request->is_streaming == enet_false || length > request->remaining ) {
+        printf( "> Invalid chunk for %s.\n", request->name );
+
+        client_pull_abort( request );
 
-    if ( net_crypto_encrypt( &context->client_private, &context->decypher_buffer, &context->cypher_buffer ) == enet_false )
         return enet_false;
+    }
 
-    return net_socket_send( &context->socket, &context->cypher_buffer );
-}
+    if ( net_file_is_valid( &request->file ) == enet_true )
+        fwrite( content.data, sizeof( uint8_t ), length, request->file.file );
 
-enet_booleans net_recv( client_context_t* context ) {
-    assert( context != NULL );
+    request->stream_crc = net_crc32c_update( request->stream_crc, content.data, length );
+    request->remaining -= length;
+    request->received  += received;
 
-    if ( net_socket_recv( &context->socket, &context->decypher_buffer ) == enet_false )
-        return enet_false;
-    
-    net_crypto_decrypt( &context->server_public, &context->decypher_buffer, &context->cypher_buffer );
+    if ( request->remaining == 0 ) {
+        client_pull_finish( request );
+
+        // The next items of a pull_many need the window of this one back.
+        if ( request->command == enet_command_pull_many && request->received > 0 )
+            return client_send_window( context, request );
+
+        return enet_true;
+    }
+
+    if ( request->received >= CLIENT_STREAM_WINDOW / 2 )
+        return client_send_window( context, request );
 
     return enet_true;
 }
 
-enet_booleans client_send( client_context_t* context, net_buffer_t* input_buffer ) {
-    const uint32_t cmd_length = 5;
-    const uint32_t length = (uint32_t)strlen( (const char*)input_buffer->data );
+/**
+ * Write the content of a pull answered in a single frame, for servers without streams.
+ **/
+enet_booleans client_pull_entry( client_request_t* request, net_frame_t* frame ) {
+    const char* name = request->name;
+    net_message_entry_t message;
 
-    if ( length <= cmd_length ) {
-        printf( "> You can't send file without givin its path.\n" );
+    if ( net_message_entry_decode( frame, &message ) == enet_false ) {
+        printf( "> File %s, invalid reply.\n", name );
         return enet_true;
     }
 
-    net_file_t file;
-    memset( &file, 0x00, sizeof( net_file_t ) );
+    client_pull_begin( request, message.content.size, message.crc );
 
-    const char* path = (const char*)input_buffer->data + cmd_length;
+    request->stream_crc = net_crc32c_update( request->stream_crc, message.content.data, message.content.size );
 
-    struct stat st;
-    if ( stat( path, &st ) != 0 || !S_ISREG( st.st_mode ) ) {
-        printf( "> You can't send a directory.\n" );
+    if ( net_file_is_valid( &request->file ) == enet_true )
+        fwrite( message.content.data, sizeof( uint8_t ), message.content.size, request->file.file );
+
+    client_pull_finish( request );
+
+    return enet_true;
+}
+
+enet_booleans client_pull_reply( client_context_t* context, client_request_t* request, net_frame_t* frame ) {
+    const char* name = request->name;
+    const uint32_t status = frame->header.command;
+
+    if ( status == enet_command_chunk )
+        return client_pull_chunk( context, request, frame );
+
+    if ( request->is_streaming == enet_true ) {
+        client_pull_abort( request );
+
+        printf( "> File %s transfer aborted by the server.\n", name );
         return enet_true;
     }
 
-    if ( net_file_open( &file, enet_buffer_io_read, path ) == enet_false ) {
-        printf( "> File %s can't be sent.\n", path );
+    if ( status == enet_command_bad ) {
+        printf( "> File %s nof found.\n", name );
+        return enet_true;
+    } else if ( status == enet_command_not_modified ) {
+        printf( "> File %s up to date ( crc32c %08x ).\n", name, request->crc );
+        return enet_true;
+    } else if ( status == enet_command_bad_name ) {
+        printf( "> You must set your name with \"name\" command before using pull.\n" );
+        return enet_true;
+    } else if ( status != enet_command_ok ) {
+        printf( "> Unknow error.\n" );
         return enet_true;
     }
 
-    const uint32_t name_length = ( length - cmd_length ) + 1;
-    const uint32_t total_length = 3 * (uint32_t)sizeof( uint32_t ) + name_length + file.size;
-    
-    if ( net_buffer_create( &context->decypher_buffer, total_length ) == enet_false ) {
-        printf( "> Can't create buffer to send data.\n" );
-        return enet_false;
-    }
-        
-    net_buffer_io_reset( &context->buffer_write );
-    net_buffer_io_write_uint32( &context->buffer_write, enet_command_send );
-    net_buffer_io_write_uint32( &context->buffer_write, name_length );
-    net_buffer_io_write_uint32( &context->buffer_write, file.size );
-    net_buffer_io_write_raw( &context->buffer_write, path, name_length, NULL );
-
-    net_buffer_t ref = net_buffer_reference( &context->decypher_buffer, 3 * (uint32_t)sizeof( uint32_t ) + name_length );
-    net_buffer_resize( &ref, file.size );
-    net_file_read( &file, &ref );
-    net_file_close( &file );
-    net_buffer_resize( context->buffer_write.buffer, total_length );
+    if ( ( context->caps.flags & NET_CAPS_FLAG_STREAM ) == 0 )
+        return client_pull_entry( request, frame );
 
-    if (
-        net_send( context ) == enet_false ||
-        net_recv( context ) == enet_false
-    ) {
-        printf( "> Connection lost.\n" );
-        return enet_false;
+    // The content follows as chunk frames, interleaved with other replies.
+    net_message_stream_t message;
+
+    if ( net_message_stream_decode( frame, &message ) == enet_false ) {
+        printf( "> File %s, invalid reply.\n", name );
+        return enet_true;
     }
 
-    uint32_t status;
+    client_pull_begin( request, message.size, message.crc );
 
-    net_buffer_io_read_uint32( &context->buffer_read, &status );
+    if ( request->remaining == 0 )
+        client_pull_finish( request );
 
-    if ( status == enet_command_ok ) {
-        printf( "> Sending of %s succeded.\n", path );
-        return enet_true;
-    } else if ( status == enet_command_bad_name ) {
-        printf( "> You must set your name with \"name\" command before using send.\n" );
-        return enet_true;
-    } else if ( status == enet_command_bad ) {
-        printf( "> Server can't store %s.\n", path );
+    return enet_true;
+}
+
+enet_booleans client_send_many( client_context_t* context, net_buffer_t* input_buffer ) {
+    const uint32_t cmd_length = 10;
+    const uint32_t length = (uint32_t)strlen( (const char*)input_buffer->data );
+
+    if ( length <= cmd_length ) {
+        printf( "> You can't send files without givin their paths.\n" );
         return enet_true;
     }
-    
-    printf( "> Sending failed.\n" );
 
-    return enet_false;
-}
+    if ( ( context->caps.flags & NET_CAPS_FLAG_BATCH ) == 0 ) {
+        printf( "> Server doesn't support send_many, use send for each file.\n" );
+        return enet_true;
+    }
 
-enet_booleans client_list( client_context_t* context ) {
-    if (
-        net_send( context ) == enet_false ||
-        net_recv( context ) == enet_false
-    ) {
-        printf( "> Connection lost.\n" );
+    if ( net_frame_encode( &context->decypher_buffer, client_header( context, enet_command_send_many, 0 ) ) == enet_false )
         return enet_false;
-    }
 
-    uint32_t status;
-    net_buffer_io_read_uint32( &context->buffer_read, &status );
+    // The reply is checked against the checksum of the file checksums, in order.
+    uint32_t crc = 0;
+    uint32_t count = 0;
+    char* state = NULL;
+    char* path = strtok_r( (char*)input_buffer->data + cmd_length, " ", &state );
 
-    if ( status == enet_command_bad ) {
-        printf( "> No entries in the file.\n" );
+    for ( ; path != NULL; path = strtok_r( NULL, " ", &state ) ) {
+        net_file_t file;
+        memset( &file, 0x00, sizeof( net_file_t ) );
+
+        struct stat st;
+        if ( stat( path, &st ) != 0 || !S_ISREG( st.st_mode ) || net_file_open( &file, enet_buffer_io_read, path ) == enet_false ) {
+            printf( "> File %s can't be sent.\n", path );
+            continue;
+        }
+
+        const net_message_send_item_t message = { net_frame_str( path ), { NULL, file.size } };
+
+        if ( net_message_send_item_write( &context->decypher_buffer, &message ) == enet_false ) {
+            printf( "> Can't create buffer to send data.\n" );
+            net_file_close( &file );
+            return enet_false;
+        }
+
+        net_buffer_t content = net_buffer_reference( &context->decypher_buffer, context->decypher_buffer.size - file.size );
+
+        net_file_read( &file, &content );
+        net_file_close( &file );
+
+        const uint32_t file_crc = net_crc32c( content.data, content.size );
+
+        crc = net_crc32c_update( crc, (const uint8_t*)&file_crc, sizeof( uint32_t ) );
+        count += 1;
+    }
+
+    if ( count == 0 )
         return enet_true;
-    } else if ( status == enet_command_bad_name ) {
-        printf( "> You must set your name with \"name\" command before using list.\n" );
+
+    net_frame_seal( &context->decypher_buffer );
+
+    char label[ CLIENT_NAME_LENGTH ];
+    snprintf( label, CLIENT_NAME_LENGTH, "%u files", count );
+
+    return client_post( context, enet_command_send_many, label, crc );
+}
+
+enet_booleans client_send_many_reply( const client_request_t* request, net_frame_t* frame ) {
+    const uint32_t status = frame->header.command;
+
+    if ( status == enet_command_bad_name ) {
+        printf( "> You must set your name with \"name\" command before using send_many.\n" );
         return enet_true;
     } else if ( status != enet_command_ok ) {
-        printf( "> Unknow error.\n" );
+        printf( "> Server can't store %s.\n", request->name );
         return enet_true;
     }
 
-    uint32_t count = 0;
-    net_buffer_io_read_uint32( &context->buffer_read, &count );
+    uint32_t crc = 0;
 
-    char* out = (char*)net_buffer_get_raw( context->buffer_read.buffer );
+    while ( frame->head < frame->end ) {
+        net_message_list_entry_t message;
 
-    while ( count-- > 0 ) {
-        uint32_t length = 0;
-        net_buffer_io_read_uint32( &context->buffer_read, &length );
-    
-        if ( net_buffer_io_is_eof( &context->buffer_read ) == enet_true ) {
-            printf( "> Error during listing.\n" );
-            return enet_false;
-        }
-        
-        printf( "> Entry : %s\n", (const char*)out + context->buffer_read.head );
+        if ( net_message_list_entry_decode( frame, &message ) == enet_false )
+            break;
 
-        net_buffer_io_jump( &context->buffer_read, length );
+        printf( "> Sending of %s succeded ( crc32c %08x ).\n", message.name.data, message.crc );
+
+        crc = net_crc32c_update( crc, (const uint8_t*)&message.crc, sizeof( uint32_t ) );
     }
 
+    if ( crc != request->crc )
+        printf( "> Sending of %s corrupted.\n", request->name );
+
     return enet_true;
 }
 
-enet_booleans client_pull( client_context_t* context, net_buffer_t* input_buffer ) {
-    const uint32_t cmd_length = 5;
+enet_booleans client_pull_many( client_context_t* context, net_buffer_t* input_buffer ) {
+    const uint32_t cmd_length = 10;
     const uint32_t length = (uint32_t)strlen( (const char*)input_buffer->data );
 
     if ( length <= cmd_length ) {
-        printf( "> You can't pull file without givin its entry name.\n" );
+        printf( "> You can't pull files without givin their entry names.\n" );
+        return enet_true;
+    }
+
+    if ( ( context->caps.flags & NET_CAPS_FLAG_BATCH ) == 0 ) {
+        printf( "> Server doesn't support pull_many, use pull for each file.\n" );
         return enet_true;
     }
 
-    if ( net_buffer_create( &context->decypher_buffer, 2 * sizeof( uint32_t ) + length ) == enet_false )
+    const net_message_pull_many_t message = { CLIENT_STREAM_WINDOW };
+
+    if ( net_message_pull_many_encode( &context->decypher_buffer, client_header( context, enet_command_pull_many, 0 ), &message ) == enet_false )
         return enet_false;
 
-    const uint32_t name_length = ( length - cmd_length ) + 1;
-    const char* name = (const char*)input_buffer->data + cmd_length;
+    char* state = NULL;
+    char* name = strtok_r( (char*)input_buffer->data + cmd_length, " ", &state );
 
-    net_buffer_io_reset( &context->buffer_write );
-    net_buffer_io_write_uint32( &context->buffer_write, enet_command_pull );
-    net_buffer_io_write_uint32( &context->buffer_write, name_length );
-    net_buffer_io_write_raw( &context->buffer_write, name, name_length, NULL );
+    for ( ; name != NULL; name = strtok_r( NULL, " ", &state ) ) {
+        const net_message_name_t item = { net_frame_str( name ) };
 
-    if (
-        net_send( context ) == enet_false ||
-        net_recv( context ) == enet_false
-    ) {
-        printf( "> Connection lost.\n" );
-        return enet_false;
+        if ( net_message_name_write( &context->decypher_buffer, &item ) == enet_false )
+            return enet_false;
     }
 
-    uint32_t status;
-    net_buffer_io_read_uint32( &context->buffer_read, &status );
+    net_frame_seal( &context->decypher_buffer );
 
-    if ( status == enet_command_bad ) {
-        printf( "> File %s nof found.\n", name );
-        return enet_true;
-    } else if ( status == enet_command_bad_name ) {
-        printf( "> You must set your name with \"name\" command before using pull.\n" );
+    return client_post( context, enet_command_pull_many, NULL, 0 );
+}
+
+enet_booleans client_pull_many_reply( client_context_t* context, client_request_t* request, net_frame_t* frame ) {
+    const uint32_t status = frame->header.command;
+
+    // Entries follow each other on the same stream, the request ends with the last frame.
+    if ( status == enet_command_chunk ) {
+        const enet_booleans result = client_pull_chunk( context, request, frame );
+
+        if ( result == enet_true )
+            request->is_streaming = enet_true;
+
+        return result;
+    }
+
+    request->is_streaming = enet_false;
+
+    if ( status == enet_command_bad_name ) {
+        printf( "> You must set your name with \"name\" command before using pull_many.\n" );
         return enet_true;
     } else if ( status != enet_command_ok ) {
-        printf( "> Unknow error.\n" );
+        client_pull_abort( request );
+
+        printf( "> Files transfer aborted by the server.\n" );
         return enet_true;
     }
 
-    net_file_t file;
-    memset( &file, 0x00, sizeof( net_file_t ) );
+    if ( frame->header.flags & NET_FRAME_FLAG_LAST ) {
+        while ( frame->head < frame->end ) {
+            net_message_name_t message;
+
+            if ( net_message_name_decode( frame, &message ) == enet_false )
+                break;
+
+            printf( "> File %s nof found.\n", message.name.data );
+        }
 
-    if ( net_file_open( &file, enet_buffer_io_write, name ) == enet_false ) {
-        printf( "> Can't create destination file\n" );
         return enet_true;
     }
 
-    const uint8_t* src_buffer = (uint8_t*)net_buffer_get_raw( context->buffer_read.buffer ) + 2 * sizeof( uint32_t );
-    uint32_t file_length = 0;
-    
-    net_buffer_io_read_uint32( &context->buffer_read, &file_length );
-    
-    fwrite( src_buffer, sizeof( uint8_t ), file_length, file.file );
+    net_message_pull_item_t message;
 
-    net_file_close( &file );
+    if ( net_message_pull_item_decode( frame, &message ) == enet_false ) {
+        printf( "> Files transfer, invalid reply.\n" );
+        return enet_true;
+    }
+
+    strncpy( request->name, message.name.data, CLIENT_NAME_LENGTH - 1 );
 
-    printf( "> File %s writing completed.\n", name );
+    client_pull_begin( request, message.size, message.crc );
+
+    if ( request->remaining == 0 ) {
+        client_pull_finish( request );
+        request->is_streaming = enet_true;
+    }
 
     return enet_true;
 }
@@ -320,29 +1563,61 @@ enet_booleans client_name( client_context_t* context, net_buffer_t* input_buffer
         return enet_true;
     }
 
-    if ( net_buffer_create( &context->decypher_buffer, 2 * sizeof( uint32_t ) + length ) == enet_false )
+    const char* name = (const char*)input_buffer->data + cmd_length;
+    const net_message_name_t message = { net_frame_str( name ) };
+
+    if ( net_message_name_encode( &context->decypher_buffer, client_header( context, enet_command_name, 0 ), &message ) == enet_false )
         return enet_false;
 
-    const char* name = (const char*)input_buffer->data + cmd_length;
+    return client_post( context, enet_command_name, name, 0 );
+}
 
-    net_buffer_io_reset( &context->buffer_write );
-    net_buffer_io_write_uint32( &context->buffer_write, enet_command_name );
-    net_buffer_io_write_uint32( &context->buffer_write, length - cmd_length );
-    net_buffer_io_write_raw( &context->buffer_write, name, length, NULL );
+enet_booleans client_stat( client_context_t* context, net_buffer_t* input_buffer ) {
+    const uint32_t cmd_length = 5;
+    const uint32_t length = (uint32_t)strlen( (const char*)input_buffer->data );
 
-    if (
-        net_send( context ) == enet_false ||
-        net_recv( context ) == enet_false
-    ) {
-        printf( "> Connection lost.\n" );
+    if ( length <= cmd_length ) {
+        printf( "> You can't stat file without givin its entry name.\n" );
+        return enet_true;
+    }
+
+    if ( ( context->caps.flags & NET_CAPS_FLAG_STAT ) == 0 ) {
+        printf( "> Server doesn't support stat, use list.\n" );
+        return enet_true;
+    }
+
+    const char* name = (const char*)input_buffer->data + cmd_length;
+    const net_message_name_t message = { net_frame_str( name ) };
+
+    if ( net_message_name_encode( &context->decypher_buffer, client_header( context, enet_command_stat, 0 ), &message ) == enet_false )
         return enet_false;
+
+    return client_post( context, enet_command_stat, name, 0 );
+}
+
+enet_booleans client_stat_reply( const client_request_t* request, net_frame_t* frame ) {
+    const uint32_t status = frame->header.command;
+    net_message_stat_t message;
+
+    if ( status == enet_command_bad ) {
+        printf( "> File %s nof found.\n", request->name );
+        return enet_true;
+    } else if ( status == enet_command_bad_name ) {
+        printf( "> You must set your name with \"name\" command before using stat.\n" );
+        return enet_true;
+    } else if ( status != enet_command_ok || net_message_stat_decode( frame, &message ) == enet_false ) {
+        printf( "> Unknow error.\n" );
+        return enet_true;
     }
-    
-    uint32_t status;
-    net_buffer_io_read_uint32( &context->buffer_read, &status );
 
-    if ( status == enet_command_ok ) {
-        printf( "> Nammed : %s.\n", name );
+    client_print_stat( request->name, &message );
+
+    return enet_true;
+}
+
+enet_booleans client_name_reply( const client_request_t* request, const net_frame_t* frame ) {
+    if ( frame->header.command == enet_command_ok ) {
+        printf( "> Nammed : %s.\n", request->name );
         return enet_true;
     }
     
@@ -351,34 +1626,102 @@ enet_booleans client_name( client_context_t* context, net_buffer_t* input_buffer
     return enet_false;
 }
 
-void print_help( ) {
-    printf( "> Commands :\n" );
-    printf( "> name user_name -> Set the current user name, must be the first command.\n" );
-    printf( "> send file_name -> Send file to the server for the current user.\n" );
-    printf( "> list -> List all file for the current user\n" );
-    printf( "> pull file_name -> Pull a file from the server for the current user.\n" );
+enet_booleans client_on_reply( client_context_t* context, client_request_t* request, net_frame_t* frame ) {
+    switch ( request->command ) {
+        case enet_command_send : return client_send_reply( request, frame );
+        case enet_command_list : return client_list_reply( request, frame );
+        case enet_command_pull : return client_pull_reply( context, request, frame );
+        case enet_command_name : return client_name_reply( request, frame );
+        case enet_command_send_many : return client_send_many_reply( request, frame );
+        case enet_command_pull_many : return client_pull_many_reply( context, request, frame );
+        case enet_command_send_hash : return client_send_hash_reply( context, request, frame );
+        case enet_command_send_delta : return client_send_reply( request, frame );
+        case enet_command_put_chunks : return client_put_chunks_reply( request, frame );
+        case enet_command_stat : return client_stat_reply( request, frame );
+
+        default : break;
+    }
+
+    return enet_true;
+}
+
+/**
+ * Wait for the requests in flight, then close the session.
+ **/
+void client_quit( client_context_t* context ) {
+    do {
+        if ( client_drain( context ) == enet_false && net_socket_is_valid( &context->socket ) == enet_false )
+            return;
+    } while ( context->resend_count > 0 && client_resend( context ) == enet_true );
+
+    if ( net_frame_encode( &context->decypher_buffer, client_header( context, enet_command_quit, 0 ) ) == enet_false )
+        return;
+
+    net_send( context );
+}
+
+/**
+ * Run one command of an input line, replies are handled as they arrive by the main loop.
+ **/
+enet_booleans client_run( client_context_t* context, net_buffer_t* command_buffer ) {
+    if ( net_buffer_contain( command_buffer, "help" ) ) {
+        print_help( );
+        return enet_true;
+    }
+
+    const enet_command_t command = parse_command( command_buffer );
+
+    switch ( command ) {
+        case enet_command_quit :
+            client_quit( context );
+            return enet_false;
+
+        case enet_command_send : return client_send( context, command_buffer );
+        case enet_command_list : return client_list( context, command_buffer );
+        case enet_command_pull : return client_pull( context, command_buffer );
+        case enet_command_name : return client_name( context, command_buffer );
+        case enet_command_send_many : return client_send_many( context, command_buffer );
+        case enet_command_pull_many : return client_pull_many( context, command_buffer );
+        case enet_command_stat : return client_stat( context, command_buffer );
+
+        default : break;
+    }
+
+    return enet_true;
 }
 
 int main( int argc, char** argv ) {
     char* address = LOCAL_SERVER;
     uint32_t port = LOCAL_PORT;
     uint32_t crypto_seed = (uint32_t)time( NULL );
+    uint32_t crypto_modes = enet_crypto_all;
+    uint32_t crypto_bits = 0;
+    uint32_t crypto_workers = net_crypto_get_default_workers( );
+    char* ticket_path = NULL;
+    uint32_t caps_flags = NET_CAPS_FLAG_ALL;
+    uint32_t compression_modes = enet_compression_all;
 
     client_context_t context;
     memset( &context, 0x00, sizeof( client_context_t ) );
 
-    parse_arguments( argc, argv, &address, &port, &crypto_seed );
+    parse_arguments( argc, argv, &address, &port, &crypto_seed, &crypto_modes, &crypto_bits, &crypto_workers, &ticket_path, &caps_flags, &compression_modes );
 
     net_crypto_init_seed( crypto_seed );
+    net_crypto_init_key_size( crypto_bits );
+
+    if ( net_crypto_init_workers( crypto_workers ) == enet_false )
+        return -1;
 
-    if ( connect_to( &context, address, port ) == enet_false )
+    if ( connect_to( &context, address, port, crypto_modes, caps_flags, compression_modes, ticket_path ) == enet_false )
         return -1;
 
     print_help( );
     printf(
-        "RSA Keys [\n\tClient Private : { %lu - %lu }\n\tServer Public : { %lu - %lu }\n]\n",
-        context.client_private.exponent, context.client_private.modulus,
-        context.server_public.exponent, context.server_public.modulus
+        "RSA Keys [\n\tClient Private : { %lu - %lu }\n\tServer Public : { %lu - %lu }\n\tCipher : %s\n\tCaps : v%u flags %02x frame %u chunk %u compression %02x depth %u\n]\n",
+        context.crypto.encrypt_key.exponent, context.crypto.encrypt_key.modulus,
+        context.crypto.decrypt_key.exponent, context.crypto.decrypt_key.modulus,
+        net_crypto_session_get_name( &context.crypto ),
+        context.caps.version, context.caps.flags, context.caps.max_frame, context.caps.chunk_size, context.caps.compression, context.caps.pipeline_depth
     );
 
     if ( net_buffer_create( &context.cypher_buffer, 16 * sizeof(int32_t) ) == enet_false ) {
@@ -392,10 +1735,48 @@ int main( int argc, char** argv ) {
         return -1;
     }
 
+    if ( net_buffer_create( &context.control_buffer, 4 * sizeof(int32_t) ) == enet_false ) {
+        net_buffer_destroy( &context.cypher_buffer );
+        net_buffer_destroy( &context.decypher_buffer );
+        net_socket_destroy( &context.socket );
+        return -1;
+    }
+
+    if ( 
+        net_buffer_create( &context.compress_buffer, 16 * sizeof(int32_t) ) == enet_false ||
+        net_buffer_create( &context.inflate_buffer, 16 * sizeof(int32_t) ) == enet_false
+    ) {
+        if ( net_buffer_is_valid( &context.compress_buffer ) == enet_true )
+            net_buffer_destroy( &context.compress_buffer );
+
+        net_buffer_destroy( &context.control_buffer );
+        net_buffer_destroy( &context.cypher_buffer );
+        net_buffer_destroy( &context.decypher_buffer );
+        net_socket_destroy( &context.socket );
+        return -1;
+    }
+
     net_buffer_t input_buffer;
     memset( &input_buffer, 0x00, sizeof( net_buffer_t ) );
 
-    if ( net_buffer_create( &input_buffer, 256 * sizeof( char ) ) == enet_false ) {
+    if ( net_buffer_create( &input_buffer, CLIENT_INPUT_LENGTH * sizeof( char ) ) == enet_false ) {
+        net_buffer_destroy( &context.inflate_buffer );
+        net_buffer_destroy( &context.compress_buffer );
+        net_buffer_destroy( &context.control_buffer );
+        net_buffer_destroy( &context.cypher_buffer );
+        net_buffer_destroy( &context.decypher_buffer );
+        net_socket_destroy( &context.socket );
+        return -1;
+    }
+
+    net_buffer_t command_buffer;
+    memset( &command_buffer, 0x00, sizeof( net_buffer_t ) );
+
+    if ( net_buffer_create( &command_buffer, input_buffer.length ) == enet_false ) {
+        net_buffer_destroy( &input_buffer );
+        net_buffer_destroy( &context.inflate_buffer );
+        net_buffer_destroy( &context.compress_buffer );
+        net_buffer_destroy( &context.control_buffer );
         net_buffer_destroy( &context.cypher_buffer );
         net_buffer_destroy( &context.decypher_buffer );
         net_socket_destroy( &context.socket );
@@ -403,44 +1784,83 @@ int main( int argc, char** argv ) {
     }
 
     enet_booleans is_running  = enet_true;
-    context.buffer_write = net_buffer_io_acquire( &context.decypher_buffer, enet_buffer_io_write );
-    context.buffer_read  = net_buffer_io_acquire( &context.cypher_buffer, enet_buffer_io_read );
+
+    // Unbuffered so poll sees every pending line, stdio would otherwise hide them.
+    setvbuf( stdin, NULL, _IONBF, 0 );
+
+    printf( "> " );
+    fflush( stdout );
 
     while ( is_running == enet_true ) {
-        printf( "> " );
-        if ( net_read_input( &input_buffer, enet_true ) == enet_false )
+        // Replies are read while waiting for inputs, a pull stream never holds the prompt.
+        struct pollfd poll_list[ 2 ] = {
+            { .fd = STDIN_FILENO, .events = POLLIN, .revents = 0 },
+            { .fd = context.socket.descriptor, .events = POLLIN, .revents = 0 }
+        };
+        const nfds_t poll_count = ( context.request_count > 0 ) ? 2 : 1;
+
+        if ( poll( poll_list, poll_count, -1 ) < 0 ) {
+            if ( errno == EINTR )
+                continue;
+
             break;
+        }
+
+        if ( poll_count > 1 && poll_list[ 1 ].revents != 0 ) {
+            if ( client_receive( &context ) == enet_false || client_resend( &context ) == enet_false )
+                break;
 
-        if ( net_buffer_contain( &input_buffer, "help" ) ) {
-            print_help( );
             continue;
         }
 
-        enet_command_t command = parse_command( &input_buffer );
+        if ( poll_list[ 0 ].revents == 0 )
+            continue;
 
-        net_buffer_io_reset( &context.buffer_write );
-        net_buffer_io_reset( &context.buffer_read );
-        net_buffer_io_write_uint32( &context.buffer_write, command );
+        if ( net_read_input( &input_buffer, enet_true ) == enet_false ) {
+            if ( feof( stdin ) )
+                client_quit( &context );
 
-        switch ( command ) {
-            case enet_command_quit :
-                net_send( &context );
-                is_running = enet_false; 
-                break;
+            break;
+        }
 
-            case enet_command_send : is_running = client_send( &context, &input_buffer ); break;
-            case enet_command_list : is_running = client_list( &context ); break;
-            case enet_command_pull : is_running = client_pull( &context, &input_buffer ); break;
-            case enet_command_name : is_running = client_name( &context, &input_buffer ); break;
+        // Commands separated by ';' are pipelined, replies are read once all are sent.
+        char* state = NULL;
+        char* token = strtok_r( (char*)input_buffer.data, ";", &state );
 
-            default : break;
+        while ( is_running == enet_true && token != NULL ) {
+            while ( isspace( (unsigned char)*token ) )
+                token += 1;
+
+            uint32_t length = (uint32_t)strlen( token );
+
+            while ( length > 0 && isspace( (unsigned char)token[ length - 1 ] ) )
+                token[ --length ] = '\0';
+
+            memmove( command_buffer.data, token, length + 1 );
+            command_buffer.size = length;
+
+            if ( length > 0 )
+                is_running = client_run( &context, &command_buffer );
+
+            if ( is_running == enet_true )
+                is_running = client_resend( &context );
+
+            token = strtok_r( NULL, ";", &state );
         }
+
+        printf( "> " );
+        fflush( stdout );
     }
 
+    net_buffer_destroy( &context.inflate_buffer );
+    net_buffer_destroy( &context.compress_buffer );
+    net_buffer_destroy( &context.control_buffer );
     net_buffer_destroy( &context.cypher_buffer );
     net_buffer_destroy( &context.decypher_buffer );
+    net_buffer_destroy( &command_buffer );
     net_buffer_destroy( &input_buffer );
     net_socket_destroy( &context.socket );
+    net_crypto_destroy_workers( );
 
     return 0;
 }
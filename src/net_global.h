@@ -26,7 +26,17 @@ typedef enum enet_command_t {
     enet_command_name,
     enet_command_ok,
     enet_command_bad,
-    enet_command_bad_name
+    enet_command_bad_name,
+    enet_command_chunk,
+    enet_command_window,
+    enet_command_send_many,
+    enet_command_pull_many,
+    enet_command_send_hash,
+    enet_command_missing,
+    enet_command_send_delta,
+    enet_command_put_chunks,
+    enet_command_not_modified,
+    enet_command_stat
 } enet_command_t;
 
 #endif /* !_NET_GLOBALS_H_ */
@@ -0,0 +1,604 @@
+/************************************************************************************************
+ *
+ *  _   _      _                      _
+ * | \ | | ___| |___      _____  _ __| | __
+ * |  \| |/ _ \ __\ \ /\ / / _ \| '__| |/ /
+ * | |\  |  __/ |_ \ V  V / (_) | |  |   <
+ * |_| \_|\___|\__| \_/\_/ \___/|_|  |_|\_\
+ *
+ * @author ALVES Quentin
+ * @license MIT
+ *
+ ***********************************************************************************************/
+
+#ifndef _NET_PROTOCOL_H_
+#define _NET_PROTOCOL_H_
+
+#include "net_utils.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// FRAME
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#define NET_FRAME_MAGIC 0x4E57
+#define NET_FRAME_VERSION 1
+#define NET_FRAME_HEADER_SIZE 16
+
+// Set on a pull to receive the content as chunk frames bounded by a client window.
+#define NET_FRAME_FLAG_STREAM 0x01
+
+// Set on the frame closing a reply made of several frames.
+#define NET_FRAME_FLAG_LAST 0x02
+
+// The payload is the LZ encoding of the actual payload, see net_lz_encode.
+#define NET_FRAME_FLAG_LZ 0x04
+
+// Set on a chunk frame carrying a stored chunk as is : the LZ encoding of the next
+// bytes of the entry, decoded on its own.
+#define NET_FRAME_FLAG_ENCODED 0x08
+
+// Set on a pull followed by a range message, only the bytes it covers are sent.
+#define NET_FRAME_FLAG_RANGE 0x10
+
+// Set on a pull followed by a validator message, after the range if any.
+#define NET_FRAME_FLAG_VALIDATOR 0x20
+
+// Set on a list to receive the stat of each entry after its list_entry.
+#define NET_FRAME_FLAG_STAT 0x40
+
+// Payloads below are sent as is, their encoding wouldn't pay for itself.
+#define NET_FRAME_LZ_MIN_SIZE 128
+
+/**
+ * net_frame_header_t struct
+ * @note : Leads every command and reply, big endian on the wire.
+ * @field magic : NET_FRAME_MAGIC.
+ * @field version : Protocol version of the sender.
+ * @field flags : NET_FRAME_FLAG_* bits.
+ * @field command : enet_command_t of the frame.
+ * @field request_id : Id chosen by the client, echoed on every reply frame.
+ * @field length : Payload length, the bytes after the header.
+ **/
+typedef struct net_frame_header_t {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t flags;
+    uint32_t command;
+    uint32_t request_id;
+    uint32_t length;
+} net_frame_header_t;
+
+/**
+ * net_frame_t struct
+ * @note : Received frame, the payload is read in place from head to end.
+ **/
+typedef struct net_frame_t {
+    net_frame_header_t header;
+    const uint8_t* head;
+    const uint8_t* end;
+} net_frame_t;
+
+/**
+ * net_frame_str_t struct
+ * @note : Length prefixed string, the length counts the terminating zero.
+ **/
+typedef struct net_frame_str_t {
+    const char* data;
+    uint32_t length;
+} net_frame_str_t;
+
+/**
+ * net_frame_blob_t struct
+ * @note : Trailing bytes of a payload, their length comes from the frame header.
+ * A NULL data only reserves the bytes, for callers filling them in place.
+ **/
+typedef struct net_frame_blob_t {
+    const uint8_t* data;
+    uint32_t size;
+} net_frame_blob_t;
+
+static inline net_frame_header_t net_frame_header(
+    const uint32_t command,
+    const uint8_t flags,
+    const uint32_t request_id
+) {
+    net_frame_header_t header = { NET_FRAME_MAGIC, NET_FRAME_VERSION, flags, command, request_id, 0 };
+
+    return header;
+}
+
+static inline net_frame_str_t net_frame_str( const char* string ) {
+    net_frame_str_t str = { string, (uint32_t)strlen( string ) + 1 };
+
+    return str;
+}
+
+static inline uint8_t* net_frame_put_u32( uint8_t* dst, const uint32_t value ) {
+    const uint32_t tmp_val = htobe32( value );
+
+    memcpy( dst, &tmp_val, sizeof( uint32_t ) );
+
+    return dst + sizeof( uint32_t );
+}
+
+static inline uint8_t* net_frame_put_str( uint8_t* dst, const net_frame_str_t value ) {
+    dst = net_frame_put_u32( dst, value.length );
+
+    memcpy( dst, value.data, value.length );
+
+    return dst + value.length;
+}
+
+static inline uint8_t* net_frame_put_blob( uint8_t* dst, const net_frame_blob_t value ) {
+    if ( value.data != NULL && value.size > 0 )
+        memcpy( dst, value.data, value.size );
+
+    return dst + value.size;
+}
+
+static inline uint8_t* net_frame_put_bin( uint8_t* dst, const net_frame_blob_t value ) {
+    dst = net_frame_put_u32( dst, value.size );
+
+    return net_frame_put_blob( dst, value );
+}
+
+static inline void net_frame_put_header( uint8_t* dst, const net_frame_header_t* header ) {
+    const uint16_t magic = htobe16( header->magic );
+
+    memcpy( dst, &magic, sizeof( uint16_t ) );
+    dst[ 2 ] = header->version;
+    dst[ 3 ] = header->flags;
+    dst = net_frame_put_u32( dst + 4, header->command );
+    dst = net_frame_put_u32( dst, header->request_id );
+    net_frame_put_u32( dst, header->length );
+}
+
+static inline uint32_t net_frame_peek_u32( const uint8_t* src ) {
+    uint32_t value = 0;
+
+    memcpy( &value, src, sizeof( uint32_t ) );
+
+    return be32toh( value );
+}
+
+static inline enet_booleans net_frame_get_u32( net_frame_t* frame, uint32_t* out ) {
+    if ( frame->end - frame->head < (ptrdiff_t)sizeof( uint32_t ) )
+        return enet_false;
+
+    (*out) = net_frame_peek_u32( frame->head );
+    frame->head += sizeof( uint32_t );
+
+    return enet_true;
+}
+
+static inline enet_booleans net_frame_get_str( net_frame_t* frame, net_frame_str_t* out ) {
+    uint32_t length = 0;
+
+    if ( net_frame_get_u32( frame, &length ) == enet_false )
+        return enet_false;
+
+    // Strings are used in place, so they must be zero terminated inside the payload.
+    if ( length == 0 || frame->end - frame->head < (ptrdiff_t)length || frame->head[ length - 1 ] != '\0' )
+        return enet_false;
+
+    out->data   = (const char*)frame->head;
+    out->length = length;
+    frame->head += length;
+
+    return enet_true;
+}
+
+static inline enet_booleans net_frame_get_blob( net_frame_t* frame, net_frame_blob_t* out ) {
+    out->data = frame->head;
+    out->size = (uint32_t)( frame->end - frame->head );
+    frame->head = frame->end;
+
+    return enet_true;
+}
+
+static inline enet_booleans net_frame_get_bin( net_frame_t* frame, net_frame_blob_t* out ) {
+    uint32_t size = 0;
+
+    if ( net_frame_get_u32( frame, &size ) == enet_false || frame->end - frame->head < (ptrdiff_t)size )
+        return enet_false;
+
+    out->data = frame->head;
+    out->size = size;
+    frame->head += size;
+
+    return enet_true;
+}
+
+/**
+ * net_frame_encode function
+ * @note : Replace the buffer content with a frame made of the header alone.
+ **/
+static inline enet_booleans net_frame_encode( net_buffer_t* buffer, net_frame_header_t header ) {
+    buffer->size  = 0;
+    header.length = 0;
+
+    if ( net_buffer_reserve( buffer, NET_FRAME_HEADER_SIZE ) == enet_false )
+        return enet_false;
+
+    net_frame_put_header( net_buffer_get_raw( buffer ), &header );
+    buffer->size = NET_FRAME_HEADER_SIZE;
+
+    return enet_true;
+}
+
+/**
+ * net_frame_seal function
+ * @note : Set the header length of a frame once messages were appended to it.
+ **/
+static inline void net_frame_seal( net_buffer_t* buffer ) {
+    net_frame_put_u32( net_buffer_get_raw( buffer ) + NET_FRAME_HEADER_SIZE - sizeof( uint32_t ), buffer->size - NET_FRAME_HEADER_SIZE );
+}
+
+/**
+ * net_frame_decode function
+ * @note : Check the header of a received frame and point the frame on its payload.
+ * @return : enet_false for a foreign or truncated frame, or another protocol version.
+ **/
+static inline enet_booleans net_frame_decode( const net_buffer_t* buffer, net_frame_t* frame ) {
+    memset( frame, 0x00, sizeof( net_frame_t ) );
+
+    if ( buffer->size < NET_FRAME_HEADER_SIZE )
+        return enet_false;
+
+    const uint8_t* src = net_buffer_get_raw( buffer );
+    uint16_t magic = 0;
+
+    memcpy( &magic, src, sizeof( uint16_t ) );
+
+    frame->header.magic      = be16toh( magic );
+    frame->header.version    = src[ 2 ];
+    frame->header.flags      = src[ 3 ];
+    frame->header.command    = net_frame_peek_u32( src + 4 );
+    frame->header.request_id = net_frame_peek_u32( src + 8 );
+    frame->header.length     = net_frame_peek_u32( src + 12 );
+
+    if (
+        frame->header.magic != NET_FRAME_MAGIC ||
+        frame->header.version != NET_FRAME_VERSION ||
+        frame->header.length > buffer->size - NET_FRAME_HEADER_SIZE
+    )
+        return enet_false;
+
+    frame->head = src + NET_FRAME_HEADER_SIZE;
+    frame->end  = frame->head + frame->header.length;
+
+    return enet_true;
+}
+
+/**
+ * net_frame_compress function
+ * @note : Build in out the NET_FRAME_FLAG_LZ version of an encoded frame. Frames
+ * carrying NET_FRAME_FLAG_ENCODED content are left alone, it is already compressed.
+ * @return : enet_false when the frame is better sent as is.
+ **/
+static inline enet_booleans net_frame_compress( const net_buffer_t* buffer, net_buffer_t* out ) {
+    const uint8_t* src = net_buffer_get_raw( buffer );
+
+    if ( 
+        buffer->size < NET_FRAME_HEADER_SIZE + NET_FRAME_LZ_MIN_SIZE ||
+        ( src[ 3 ] & ( NET_FRAME_FLAG_LZ | NET_FRAME_FLAG_ENCODED ) ) != 0
+    )
+        return enet_false;
+
+    out->size = 0;
+
+    if ( net_buffer_reserve( out, NET_FRAME_HEADER_SIZE ) == enet_false )
+        return enet_false;
+
+    uint8_t* dst = net_buffer_get_raw( out );
+
+    memcpy( dst, src, NET_FRAME_HEADER_SIZE );
+    dst[ 3 ] |= NET_FRAME_FLAG_LZ;
+    out->size = NET_FRAME_HEADER_SIZE;
+
+    if ( net_lz_encode( src + NET_FRAME_HEADER_SIZE, buffer->size - NET_FRAME_HEADER_SIZE, out ) == enet_false )
+        return enet_false;
+
+    net_frame_seal( out );
+
+    return enet_true;
+}
+
+/**
+ * net_frame_inflate function
+ * @note : Decode the payload of a NET_FRAME_FLAG_LZ frame into out and point the frame
+ * on it, other frames are left untouched.
+ * @return : enet_false for a corrupted payload, or one inflating past max_size.
+ **/
+static inline enet_booleans net_frame_inflate( net_frame_t* frame, net_buffer_t* out, const uint32_t max_size ) {
+    if ( ( frame->header.flags & NET_FRAME_FLAG_LZ ) == 0 )
+        return enet_true;
+
+    const uint32_t size = (uint32_t)( frame->end - frame->head );
+    const uint32_t raw_size = net_lz_get_raw_size( frame->head, size );
+
+    if ( raw_size == 0 || raw_size > max_size || net_buffer_create( out, raw_size ) == enet_false )
+        return enet_false;
+
+    if ( net_lz_decode( frame->head, size, net_buffer_get_raw( out ) ) == enet_false )
+        return enet_false;
+
+    net_buffer_resize( out, raw_size );
+
+    frame->header.flags &= ~NET_FRAME_FLAG_LZ;
+    frame->header.length = raw_size;
+    frame->head = net_buffer_get_raw( out );
+    frame->end  = frame->head + raw_size;
+
+    return enet_true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// MESSAGES
+/////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Payload schemas, as FIELD( kind, name ) lists with kind among u32, str, bin and
+ * blob. A bin is length prefixed bytes, a blob takes the rest of the payload so it
+ * can only come last. Commands absent from the table ( quit, list and the bare ok,
+ * bad, bad_name and not_modified statuses ) are frames made of the header alone.
+ **/
+#define NET_MESSAGE_NAME( FIELD )       FIELD( str, name )
+#define NET_MESSAGE_SEND( FIELD )       FIELD( str, name ) FIELD( blob, content )
+#define NET_MESSAGE_PULL( FIELD )       FIELD( str, name ) FIELD( u32, window )
+#define NET_MESSAGE_WINDOW( FIELD )     FIELD( u32, increment )
+#define NET_MESSAGE_CHUNK( FIELD )      FIELD( blob, content )
+#define NET_MESSAGE_CHECKSUM( FIELD )   FIELD( u32, crc )
+#define NET_MESSAGE_ENTRY( FIELD )      FIELD( u32, crc ) FIELD( blob, content )
+#define NET_MESSAGE_STREAM( FIELD )     FIELD( u32, size ) FIELD( u32, crc )
+#define NET_MESSAGE_LIST_ENTRY( FIELD ) FIELD( u32, crc ) FIELD( str, name )
+#define NET_MESSAGE_SEND_ITEM( FIELD )  FIELD( str, name ) FIELD( bin, content )
+#define NET_MESSAGE_PULL_MANY( FIELD )  FIELD( u32, window )
+#define NET_MESSAGE_PULL_ITEM( FIELD )  FIELD( str, name ) FIELD( u32, size ) FIELD( u32, crc )
+#define NET_MESSAGE_SEND_HASH( FIELD )  FIELD( str, name ) FIELD( u32, size ) FIELD( u32, crc )
+#define NET_MESSAGE_CHUNK_REF( FIELD )  FIELD( bin, hash ) FIELD( u32, size )
+#define NET_MESSAGE_MISSING( FIELD )    FIELD( blob, bitmap )
+#define NET_MESSAGE_DELTA_ITEM( FIELD ) FIELD( bin, hash ) FIELD( u32, size ) FIELD( bin, content )
+#define NET_MESSAGE_RANGE( FIELD )      FIELD( u32, offset ) FIELD( u32, length )
+#define NET_MESSAGE_VALIDATOR( FIELD )  FIELD( u32, size ) FIELD( u32, crc )
+#define NET_MESSAGE_STAT( FIELD )       FIELD( u32, size ) FIELD( u32, crc ) FIELD( u32, time ) FIELD( u32, offset )
+#define NET_MESSAGE_CAPS( FIELD )       FIELD( u32, version ) FIELD( u32, flags ) FIELD( u32, max_frame ) \
+                                        FIELD( u32, chunk_size ) FIELD( u32, compression ) FIELD( u32, pipeline_depth )
+
+/**
+ * MESSAGE( name, schema ), in order :
+ *  name       : name command.
+ *  send       : send command.
+ *  pull       : pull command, window only read for streamed pulls.
+ *  window     : window command, credit granted to a pull stream.
+ *  chunk      : chunk reply, a piece of a pull stream.
+ *  checksum   : ok reply to send.
+ *  entry      : ok reply to a pull.
+ *  stream     : ok reply to a streamed pull, chunks follow.
+ *  list_entry : ok reply to list and send_many, repeated for each entry.
+ *  send_item  : send_many command, repeated for each file.
+ *  pull_many  : pull_many command, followed by a name message for each entry.
+ *  pull_item  : ok reply to pull_many before the chunks of each entry found, the
+ *               last frame lists the missing entries as name messages.
+ *  send_hash  : send_hash command, followed by a chunk_ref message for each content
+ *               defined chunk of the file. Answered by a checksum, or by missing
+ *               when the server lacks some chunks. Also the head of send_delta.
+ *  chunk_ref  : SHA-256 and size of a chunk, see net_cdc_cut.
+ *  missing    : missing reply to send_hash, bit i ( LSB first ) set when the server
+ *               lacks chunk i.
+ *  delta_item : send_delta command, repeated after the send_hash head for each
+ *               chunk, the content is only sent for the missing ones. Also the
+ *               put_chunks command, content always sent and without head.
+ *  range      : follows a pull flagged NET_FRAME_FLAG_RANGE, a length of 0 reads
+ *               to the end. The reply carries the size of the range and the crc of
+ *               the whole entry.
+ *  validator  : follows a pull flagged NET_FRAME_FLAG_VALIDATOR, size and crc of
+ *               the copy the client has. A pull of an entry still matching it is
+ *               answered by a bare not_modified.
+ *  stat       : ok reply to stat, a name command. Decoded size, checksum, write
+ *               time in seconds since the epoch ( 0 when unknown ) and offset of the
+ *               record in the user file. Also follows each list_entry of a list
+ *               flagged NET_FRAME_FLAG_STAT.
+ *  caps       : capability block closing the handshake, sent without frame header.
+ **/
+#define NET_MESSAGE_LIST( MESSAGE )             \
+    MESSAGE( name,       NET_MESSAGE_NAME )       \
+    MESSAGE( send,       NET_MESSAGE_SEND )       \
+    MESSAGE( pull,       NET_MESSAGE_PULL )       \
+    MESSAGE( window,     NET_MESSAGE_WINDOW )     \
+    MESSAGE( chunk,      NET_MESSAGE_CHUNK )      \
+    MESSAGE( checksum,   NET_MESSAGE_CHECKSUM )   \
+    MESSAGE( entry,      NET_MESSAGE_ENTRY )      \
+    MESSAGE( stream,     NET_MESSAGE_STREAM )     \
+    MESSAGE( list_entry, NET_MESSAGE_LIST_ENTRY ) \
+    MESSAGE( send_item,  NET_MESSAGE_SEND_ITEM )  \
+    MESSAGE( pull_many,  NET_MESSAGE_PULL_MANY )  \
+    MESSAGE( pull_item,  NET_MESSAGE_PULL_ITEM )  \
+    MESSAGE( send_hash,  NET_MESSAGE_SEND_HASH )  \
+    MESSAGE( chunk_ref,  NET_MESSAGE_CHUNK_REF )  \
+    MESSAGE( missing,    NET_MESSAGE_MISSING )    \
+    MESSAGE( delta_item, NET_MESSAGE_DELTA_ITEM ) \
+    MESSAGE( range,      NET_MESSAGE_RANGE )      \
+    MESSAGE( validator,  NET_MESSAGE_VALIDATOR )  \
+    MESSAGE( stat,       NET_MESSAGE_STAT )       \
+    MESSAGE( caps,       NET_MESSAGE_CAPS )
+
+#define NET_FIELD_TYPE_u32 uint32_t
+#define NET_FIELD_TYPE_str net_frame_str_t
+#define NET_FIELD_TYPE_bin net_frame_blob_t
+#define NET_FIELD_TYPE_blob net_frame_blob_t
+
+#define NET_FIELD_SIZE_u32( value ) (uint32_t)sizeof( uint32_t )
+#define NET_FIELD_SIZE_str( value ) ( (uint32_t)sizeof( uint32_t ) + (value).length )
+#define NET_FIELD_SIZE_bin( value ) ( (uint32_t)sizeof( uint32_t ) + (value).size )
+#define NET_FIELD_SIZE_blob( value ) (value).size
+
+#define NET_MESSAGE_FIELD_DECLARE( kind, name ) NET_FIELD_TYPE_##kind name;
+#define NET_MESSAGE_FIELD_SIZE( kind, name ) + NET_FIELD_SIZE_##kind( message->name )
+#define NET_MESSAGE_FIELD_PUT( kind, name ) dst = net_frame_put_##kind( dst, message->name );
+#define NET_MESSAGE_FIELD_GET( kind, name )                              \
+    if ( net_frame_get_##kind( frame, &message->name ) == enet_false )   \
+        return enet_false;
+
+/**
+ * For each message X :
+ *  net_message_X_t : Decoded fields, strings and blobs point inside the frame.
+ *  net_message_X_size : Payload size.
+ *  net_message_X_write : Append the payload to a buffer, growing it once.
+ *  net_message_X_encode : Replace the buffer content with a full frame.
+ *  net_message_X_decode : Read the payload at the frame head, bounds checked.
+ **/
+#define NET_MESSAGE_DEFINE( name, SCHEMA )                                                          \
+    typedef struct net_message_##name##_t {                                                         \
+        SCHEMA( NET_MESSAGE_FIELD_DECLARE )                                                         \
+    } net_message_##name##_t;                                                                       \
+                                                                                                    \
+    static inline uint32_t net_message_##name##_size( const net_message_##name##_t* message ) {     \
+        (void)message;                                                                              \
+                                                                                                    \
+        return 0 SCHEMA( NET_MESSAGE_FIELD_SIZE );                                                  \
+    }                                                                                               \
+                                                                                                    \
+    static inline enet_booleans net_message_##name##_write(                                         \
+        net_buffer_t* buffer,                                                                       \
+        const net_message_##name##_t* message                                                       \
+    ) {                                                                                             \
+        const uint32_t size = net_message_##name##_size( message );                                 \
+                                                                                                    \
+        if ( net_buffer_reserve( buffer, size ) == enet_false )                                     \
+            return enet_false;                                                                      \
+                                                                                                    \
+        uint8_t* dst = net_buffer_get_raw( buffer ) + buffer->size;                                 \
+                                                                                                    \
+        SCHEMA( NET_MESSAGE_FIELD_PUT )                                                             \
+        buffer->size += size;                                                                       \
+                                                                                                    \
+        return enet_true;                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    static inline enet_booleans net_message_##name##_encode(                                        \
+        net_buffer_t* buffer,                                                                       \
+        net_frame_header_t header,                                                                  \
+        const net_message_##name##_t* message                                                       \
+    ) {                                                                                             \
+        header.length = net_message_##name##_size( message );                                       \
+        buffer->size  = 0;                                                                          \
+                                                                                                    \
+        if ( net_buffer_reserve( buffer, NET_FRAME_HEADER_SIZE + header.length ) == enet_false )    \
+            return enet_false;                                                                      \
+                                                                                                    \
+        net_frame_put_header( net_buffer_get_raw( buffer ), &header );                              \
+        buffer->size = NET_FRAME_HEADER_SIZE;                                                       \
+                                                                                                    \
+        return net_message_##name##_write( buffer, message );                                       \
+    }                                                                                               \
+                                                                                                    \
+    static inline enet_booleans net_message_##name##_decode(                                        \
+        net_frame_t* frame,                                                                         \
+        net_message_##name##_t* message                                                             \
+    ) {                                                                                             \
+        SCHEMA( NET_MESSAGE_FIELD_GET )                                                             \
+                                                                                                    \
+        return enet_true;                                                                           \
+    }
+
+NET_MESSAGE_LIST( NET_MESSAGE_DEFINE )
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CAPABILITIES
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Pulls may be answered as chunk frames bounded by a client window.
+#define NET_CAPS_FLAG_STREAM 0x01
+
+// send_many and pull_many are understood.
+#define NET_CAPS_FLAG_BATCH 0x02
+
+// send_hash is understood, content the server already has isn't uploaded again.
+#define NET_CAPS_FLAG_HASH 0x04
+
+// send_delta is understood, only the chunks missing after a send_hash are uploaded.
+#define NET_CAPS_FLAG_DELTA 0x08
+
+// Pulls take a byte range and put_chunks is understood, transfers resume where they stopped.
+#define NET_CAPS_FLAG_RESUME 0x10
+
+// Pulls may carry a validator, unchanged entries aren't sent again.
+#define NET_CAPS_FLAG_VALIDATE 0x20
+
+// stat is understood and list may return the stat of each entry.
+#define NET_CAPS_FLAG_STAT 0x40
+
+#define NET_CAPS_FLAG_ALL ( \
+    NET_CAPS_FLAG_STREAM | NET_CAPS_FLAG_BATCH | NET_CAPS_FLAG_HASH | \
+    NET_CAPS_FLAG_DELTA | NET_CAPS_FLAG_RESUME | NET_CAPS_FLAG_VALIDATE | NET_CAPS_FLAG_STAT \
+)
+
+#define NET_CAPS_MAX_FRAME ( 64 * 1024 * 1024 )
+#define NET_CAPS_MIN_CHUNK_SIZE 1024
+
+/**
+ * net_caps_legacy function
+ * @note : Capabilities assumed for peers closing the handshake without a caps block,
+ * a single request in flight and whole entries in one frame.
+ **/
+static inline net_message_caps_t net_caps_legacy( ) {
+    net_message_caps_t caps = { NET_FRAME_VERSION, 0, NET_CAPS_MAX_FRAME, 16 * 1024, 0, 1 };
+
+    return caps;
+}
+
+/**
+ * net_caps_select function
+ * @note : Best common set, both sides compute the same from the blocks they traded.
+ * Cipher modes are not part of it, they are settled by the handshake mode field
+ * before the session secret is sent. compression holds enet_compression_modes bits.
+ **/
+static inline net_message_caps_t net_caps_select( const net_message_caps_t* local, const net_message_caps_t* remote ) {
+    net_message_caps_t caps;
+
+    caps.version        = ( local->version < remote->version ) ? local->version : remote->version;
+    caps.flags          = local->flags & remote->flags;
+    caps.max_frame      = ( local->max_frame < remote->max_frame ) ? local->max_frame : remote->max_frame;
+    caps.chunk_size     = ( local->chunk_size < remote->chunk_size ) ? local->chunk_size : remote->chunk_size;
+    caps.compression    = local->compression & remote->compression;
+    caps.pipeline_depth = ( local->pipeline_depth < remote->pipeline_depth ) ? local->pipeline_depth : remote->pipeline_depth;
+
+    if ( caps.max_frame < NET_FRAME_HEADER_SIZE + NET_CAPS_MIN_CHUNK_SIZE )
+        caps.max_frame = NET_FRAME_HEADER_SIZE + NET_CAPS_MIN_CHUNK_SIZE;
+
+    if ( caps.chunk_size < NET_CAPS_MIN_CHUNK_SIZE )
+        caps.chunk_size = NET_CAPS_MIN_CHUNK_SIZE;
+    else if ( caps.chunk_size > caps.max_frame - NET_FRAME_HEADER_SIZE )
+        caps.chunk_size = caps.max_frame - NET_FRAME_HEADER_SIZE;
+
+    if ( caps.pipeline_depth == 0 )
+        caps.pipeline_depth = 1;
+
+    return caps;
+}
+
+/**
+ * net_caps_read function
+ * @note : Read the caps block left in a handshake buffer, trailing bytes are kept for
+ * fields appended by later versions.
+ * @return : enet_false when the peer sent no block or a truncated one.
+ **/
+static inline enet_booleans net_caps_read( net_buffer_io_t* buffer_io, net_message_caps_t* caps ) {
+    if ( net_buffer_io_is_eof( buffer_io ) == enet_true )
+        return enet_false;
+
+    const uint8_t* head = net_buffer_get_raw( buffer_io->buffer );
+    net_frame_t frame;
+
+    memset( &frame, 0x00, sizeof( net_frame_t ) );
+
+    frame.head = head + buffer_io->head;
+    frame.end  = head + buffer_io->buffer->size;
+
+    if ( net_message_caps_decode( &frame, caps ) == enet_false )
+        return enet_false;
+
+    buffer_io->head = (uint32_t)( frame.end - head );
+
+    return enet_true;
+}
+
+#endif /* !_NET_PROTOCOL_H_ */
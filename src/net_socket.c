@@ -288,6 +288,195 @@ enet_booleans net_socket_recv( net_socket_t* socket, net_buffer_t* buffer ) {
     return net_socket_udp_recv( socket, buffer );
 }
 
+enet_booleans net_socket_send_encrypted(
+    net_socket_t* socket,
+    net_crypto_session_t* session,
+    const net_buffer_t* buffer
+) {
+    assert( net_socket_is( socket, enet_socket_tcp ) == enet_true );
+    assert( net_buffer_is_valid( buffer ) == enet_true );
+
+    // The receiver takes an empty message for a broken one, it never goes out.
+    if ( buffer->size == 0 ) {
+        net_print_error( "Can't send an empty message with socket %p", socket );
+
+        return enet_false;
+    }
+
+    const size_t cypher_size = net_crypto_session_get_cypher_size( session, buffer->size );
+
+    if ( cypher_size > UINT32_MAX ) {
+        net_print_error( "Can't send %zu bytes cypher with socket %p", cypher_size, socket );
+
+        return enet_false;
+    }
+
+    // The length prefix rides in front of the first window.
+    uint8_t window[ sizeof( uint32_t ) + NET_SOCKET_CRYPTO_WINDOW ];
+    net_buffer_t window_buffer = { sizeof( window ), 0, window };
+    net_buffer_io_t buffer_io = net_buffer_io_acquire( &window_buffer, enet_buffer_io_write );
+
+    net_buffer_io_write_uint32( &buffer_io, (uint32_t)cypher_size );
+
+    size_t plain_window  = 0;
+    size_t cypher_window = 0;
+
+    net_crypto_session_get_encrypt_window( session, NET_SOCKET_CRYPTO_WINDOW, &plain_window, &cypher_window );
+
+    const uint8_t* src = (const uint8_t*)net_buffer_get_raw( buffer );
+    size_t offset = 0;
+    uint32_t header = sizeof( uint32_t );
+
+    do {
+        size_t length = buffer->size - offset;
+
+        if ( length > plain_window )
+            length = plain_window;
+
+        window_buffer.size = header + (uint32_t)net_crypto_session_encrypt_raw( session, src + offset, length, window + header );
+
+        if ( net_socket_tcp_send( socket, &window_buffer ) == enet_false )
+            return enet_false;
+
+        offset += length;
+        header  = 0;
+    } while ( offset < buffer->size );
+
+    return enet_true;
+}
+
+enet_booleans net_socket_queue_encrypted(
+    net_crypto_session_t* session,
+    const net_buffer_t* buffer,
+    net_buffer_t* output
+) {
+    assert( net_buffer_is_valid( buffer ) == enet_true );
+    assert( net_buffer_is_valid( output ) == enet_true );
+
+    if ( buffer->size == 0 ) {
+        net_print_error( "Can't queue an empty message in buffer %p", output );
+
+        return enet_false;
+    }
+
+    const size_t cypher_size = net_crypto_session_get_cypher_size( session, buffer->size );
+
+    if ( cypher_size > UINT32_MAX - sizeof( uint32_t ) - output->size ) {
+        net_print_error( "Can't queue %zu bytes cypher in buffer %p", cypher_size, output );
+
+        return enet_false;
+    }
+
+    if ( net_buffer_reserve( output, sizeof( uint32_t ) + (uint32_t)cypher_size ) == enet_false )
+        return enet_false;
+
+    size_t plain_window  = 0;
+    size_t cypher_window = 0;
+
+    net_crypto_session_get_encrypt_window( session, NET_SOCKET_CRYPTO_WINDOW, &plain_window, &cypher_window );
+
+    // Same windows as net_socket_send_encrypted, the receiver can't tell them apart.
+    uint8_t* dst = net_buffer_get_raw( output ) + output->size;
+    const uint32_t prefix = htobe32( (uint32_t)cypher_size );
+    const uint8_t* src = (const uint8_t*)net_buffer_get_raw( buffer );
+    size_t written = sizeof( uint32_t );
+    size_t offset = 0;
+
+    memcpy( dst, &prefix, sizeof( uint32_t ) );
+
+    do {
+        size_t length = buffer->size - offset;
+
+        if ( length > plain_window )
+            length = plain_window;
+
+        written += net_crypto_session_encrypt_raw( session, src + offset, length, dst + written );
+        offset  += length;
+    } while ( offset < buffer->size );
+
+    output->size += (uint32_t)written;
+
+    return enet_true;
+}
+
+enet_booleans net_socket_flush( net_socket_t* socket, net_buffer_t* output ) {
+    assert( net_socket_is( socket, enet_socket_tcp ) == enet_true );
+
+    if ( output->size == 0 )
+        return enet_true;
+
+    const enet_booleans result = net_socket_tcp_send( socket, output );
+
+    output->size = 0;
+
+    return result;
+}
+
+enet_booleans net_socket_recv_decrypted(
+    net_socket_t* socket,
+    net_crypto_session_t* session,
+    net_buffer_t* buffer,
+    const uint32_t max_size
+) {
+    assert( net_socket_is( socket, enet_socket_tcp ) == enet_true );
+
+    uint8_t window[ NET_SOCKET_CRYPTO_WINDOW ];
+    net_buffer_t window_buffer = { sizeof( window ), sizeof( uint32_t ), window };
+    net_buffer_io_t buffer_io = net_buffer_io_acquire( &window_buffer, enet_buffer_io_read );
+    uint32_t cypher_size = 0;
+
+    if ( 
+        net_socket_tcp_recv( socket, &window_buffer ) == enet_false ||
+        net_buffer_io_read_uint32( &buffer_io, &cypher_size ) == enet_false
+    ) {
+        printf( "Can't receive message length\n" );
+
+        return enet_false;
+    }
+
+    // Block modes pad the plain text, the limit is compared on the cypher side.
+    if ( max_size > 0 && cypher_size > net_crypto_session_get_cypher_size( session, max_size ) ) {
+        printf( "Can't receive %u bytes message over the %u bytes limit\n", cypher_size, max_size );
+
+        return enet_false;
+    }
+
+    const size_t plain_size = net_crypto_session_get_plain_size( session, cypher_size );
+
+    if ( plain_size == 0 || plain_size > UINT32_MAX ) {
+        printf( "Can't decrypt %u bytes message\n", cypher_size );
+
+        return enet_false;
+    }
+
+    if ( net_buffer_create( buffer, (uint32_t)plain_size ) == enet_false )
+        return enet_false;
+
+    size_t plain_window  = 0;
+    size_t cypher_window = 0;
+
+    net_crypto_session_get_decrypt_window( session, NET_SOCKET_CRYPTO_WINDOW, &plain_window, &cypher_window );
+
+    uint8_t* dst = (uint8_t*)net_buffer_get_raw( buffer );
+    size_t offset = 0;
+    size_t length = 0;
+
+    for ( uint32_t received = 0; received < cypher_size; received += (uint32_t)window_buffer.size ) {
+        window_buffer.size = cypher_size - received;
+
+        if ( window_buffer.size > cypher_window )
+            window_buffer.size = (uint32_t)cypher_window;
+
+        if ( net_socket_tcp_recv( socket, &window_buffer ) == enet_false )
+            return enet_false;
+
+        length  = net_crypto_session_decrypt_raw( session, window, window_buffer.size, dst + offset );
+        offset += length;
+    }
+
+    return net_buffer_resize( buffer, (uint32_t)offset );
+}
+
 enet_booleans net_socket_is_valid( const net_socket_t* socket ) {
     assert( socket != NULL );
 
@@ -97,6 +97,25 @@ enet_booleans net_buffer_resize( net_buffer_t* buffer, const uint32_t size ) {
     return enet_false;
 }
 
+enet_booleans net_buffer_reserve( net_buffer_t* buffer, const uint32_t extra ) {
+    assert( net_buffer_is_valid( buffer ) == enet_true );
+
+    const uint32_t size = buffer->size;
+
+    if ( size + extra <= buffer->length )
+        return enet_true;
+
+    uint32_t length = 2 * buffer->length;
+
+    if ( length < size + extra )
+        length = size + extra;
+
+    if ( net_buffer_create( buffer, length ) == enet_false )
+        return enet_false;
+
+    return net_buffer_resize( buffer, size );
+}
+
 void net_buffer_clear( net_buffer_t* buffer ) {
     assert( net_buffer_is_valid( buffer ) == enet_true );
 
@@ -382,7 +401,7 @@ enet_booleans net_buffer_io_write_raw(
     assert( in != NULL );
     assert( in_length > 0 );
 
-    size_t remaining = buffer_io->buffer->size - buffer_io->head;
+    size_t remaining = buffer_io->buffer->length - buffer_io->buffer->size;
     size_t length = in_length;
 
     if ( remaining < length ) {
@@ -560,7 +579,10 @@ enet_booleans net_read_input( net_buffer_t* buffer, enet_booleans wait_for_input
             return enet_false;
         }
     } else
-        while ( fgets( buffer->data, buffer->length - 1, stdin ) == NULL );
+        while ( fgets( buffer->data, buffer->length - 1, stdin ) == NULL ) {
+            if ( feof( stdin ) )
+                return enet_false;
+        }
 
     buffer->size = strlen( (const char*)buffer->data );
 
@@ -579,234 +601,3014 @@ enet_booleans net_read_input( net_buffer_t* buffer, enet_booleans wait_for_input
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
-// CRYPTO ( RSA-TOY )
+// CHECKSUM
 /////////////////////////////////////////////////////////////////////////////////////////////////
-void net_crypto_init_seed( uint32_t seed ) {
-    srand( seed );
-}
-
-uint64_t net_crypto_modular_pow(
-    uint64_t base,
-    const net_crypto_key_t* key
-) {
-    if ( key == NULL || key->modulus == 1 )
-        return 0;
+#define NET_CRC32C_POLYNOMIAL 0x82F63B78
 
-    uint64_t exponent = key->exponent;
-    uint64_t result = 1;
+typedef uint32_t (*net_crc32c_kernel_t)( uint32_t crc, const uint8_t* data, size_t size );
 
-    base %= key->modulus;
+uint32_t net_crc32c_table[ 8 ][ 256 ];
+pthread_once_t net_crc32c_table_once = PTHREAD_ONCE_INIT;
 
-    while ( exponent > 0 ) {
-        if ( exponent & 1 )
-            result = (result * base) % key->modulus;
+void net_crc32c_table_init( ) {
+    for ( uint32_t byte = 0; byte < 256; byte++ ) {
+        uint32_t crc = byte;
 
-        base = (base * base) % key->modulus;
+        for ( uint32_t bit = 0; bit < 8; bit++ )
+            crc = ( crc >> 1 ) ^ ( NET_CRC32C_POLYNOMIAL & ( 0 - ( crc & 1 ) ) );
 
-        exponent >>= 1;
+        net_crc32c_table[ 0 ][ byte ] = crc;
     }
 
-    return result;
-}
+    for ( uint32_t byte = 0; byte < 256; byte++ ) {
+        for ( uint32_t slice = 1; slice < 8; slice++ ) {
+            const uint32_t crc = net_crc32c_table[ slice - 1 ][ byte ];
 
-uint64_t net_crypto_rand( const uint64_t modulus, uint64_t offset ) {
-    return ( rand( ) % modulus ) + offset;
+            net_crc32c_table[ slice ][ byte ] = ( crc >> 8 ) ^ net_crc32c_table[ 0 ][ crc & 0xFF ];
+        }
+    }
 }
 
-enet_booleans net_crypto_is_prime( uint64_t num ) {
-    if ( num < 2 || num % 2 == 0 || num % 3 == 0 )
-        return enet_false;
+uint32_t net_crc32c_table_kernel( uint32_t crc, const uint8_t* data, size_t size ) {
+    pthread_once( &net_crc32c_table_once, net_crc32c_table_init );
 
-    if ( num < 4 )
-        return enet_true;
+    while ( size >= 8 ) {
+        const uint32_t low  = crc ^ ( (uint32_t)data[ 0 ] | (uint32_t)data[ 1 ] << 8 | (uint32_t)data[ 2 ] << 16 | (uint32_t)data[ 3 ] << 24 );
+        const uint32_t high = (uint32_t)data[ 4 ] | (uint32_t)data[ 5 ] << 8 | (uint32_t)data[ 6 ] << 16 | (uint32_t)data[ 7 ] << 24;
 
-    for ( uint64_t i = 5; i * i <= num; i = i + 6 ) {
-        if ( num % i == 0 || num % (i + 2) == 0 )
-            return enet_false;
+        crc = net_crc32c_table[ 7 ][ low & 0xFF ] ^ net_crc32c_table[ 6 ][ ( low >> 8 ) & 0xFF ] ^
+              net_crc32c_table[ 5 ][ ( low >> 16 ) & 0xFF ] ^ net_crc32c_table[ 4 ][ low >> 24 ] ^
+              net_crc32c_table[ 3 ][ high & 0xFF ] ^ net_crc32c_table[ 2 ][ ( high >> 8 ) & 0xFF ] ^
+              net_crc32c_table[ 1 ][ ( high >> 16 ) & 0xFF ] ^ net_crc32c_table[ 0 ][ high >> 24 ];
+
+        data += 8;
+        size -= 8;
     }
 
-    return enet_true;
+    while ( size-- > 0 )
+        crc = ( crc >> 8 ) ^ net_crc32c_table[ 0 ][ ( crc ^ *data++ ) & 0xFF ];
+
+    return crc;
 }
 
-uint64_t net_crypto_next_prime( const uint64_t base ) {
-    uint64_t num = ( base <= 1 ) ? 2 : base;
+#ifdef NET_ARCH_X86
+__attribute__(( target( "sse4.2" ) ))
+uint32_t net_crc32c_sse42_kernel( uint32_t crc, const uint8_t* data, size_t size ) {
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
 
-    while ( net_crypto_is_prime( num ) == enet_false )
-        num += 1;
+    while ( size >= sizeof( uint64_t ) ) {
+        uint64_t word;
+        memcpy( &word, data, sizeof( uint64_t ) );
 
-    return num;
-}
+        crc64 = _mm_crc32_u64( crc64, word );
+        data += sizeof( uint64_t );
+        size -= sizeof( uint64_t );
+    }
 
-uint64_t net_crypto_gcd( uint64_t a, uint64_t b ) {
-    while ( b ) {
-        a %= b;
+    crc = (uint32_t)crc64;
+#endif
 
-        uint64_t t = a;
-        a = b;
-        b = t;
+    while ( size >= sizeof( uint32_t ) ) {
+        uint32_t word;
+        memcpy( &word, data, sizeof( uint32_t ) );
+
+        crc = _mm_crc32_u32( crc, word );
+        data += sizeof( uint32_t );
+        size -= sizeof( uint32_t );
     }
 
-    return a;
+    while ( size-- > 0 )
+        crc = _mm_crc32_u8( crc, *data++ );
+
+    return crc;
 }
+#endif
 
-enet_booleans net_crypto_generate_keys(
-    net_crypto_key_t* restrict public,
-    net_crypto_key_t* restrict private
-) {
-    uint64_t p = 0;
-    uint64_t q = 0;
-    uint64_t n = p * q;
-    uint64_t phi_n = ( p - 1 ) * ( q - 1 );
-    uint64_t e = 7;
+net_crc32c_kernel_t net_crc32c_get_kernel( ) {
+    static net_crc32c_kernel_t kernel = NULL;
 
-    do {
-        p = net_crypto_rand( 500, 1000 );
-        q = net_crypto_rand( 500, 1500 );
-        p = net_crypto_next_prime( p );
-        q = net_crypto_next_prime( q );
+    if ( kernel != NULL )
+        return kernel;
 
-        if ( p == q )
-            q = net_crypto_next_prime( q + 1 );
+#ifdef NET_ARCH_X86
+    __builtin_cpu_init( );
 
-        n = p * q;
-        phi_n = ( p - 1 ) * ( q - 1 );
-    } while( net_crypto_gcd( e, phi_n ) != 1 );
+    if ( __builtin_cpu_supports( "sse4.2" ) )
+        kernel = net_crc32c_sse42_kernel;
+    else
+#endif
+        kernel = net_crc32c_table_kernel;
 
-    public->exponent = e;
-    public->modulus = n;
-    private->modulus = n;
+    return kernel;
+}
 
-    for ( uint64_t k = 1; k < phi_n; k++ ) {
-        if ( (k * e) % phi_n == 1 ) {
-            private->exponent = k;
+uint32_t net_crc32c_update( uint32_t crc, const void* data, const size_t size ) {
+    assert( data != NULL || size == 0 );
 
-            return enet_true;
+    const net_crc32c_kernel_t kernel = net_crc32c_get_kernel( );
+
+    return ~kernel( ~crc, (const uint8_t*)data, size );
+}
+
+uint32_t net_crc32c( const void* data, const size_t size ) {
+    return net_crc32c_update( 0, data, size );
+}
+
+uint32_t net_crc32c_x2n_table[ 32 ];
+pthread_once_t net_crc32c_x2n_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Product of two polynomials modulo the CRC32C polynomial, bits reflected.
+ **/
+uint32_t net_crc32c_multiply( uint32_t left, uint32_t right ) {
+    uint32_t mask = (uint32_t)1 << 31;
+    uint32_t product = 0;
+
+    for ( ; mask != 0; mask >>= 1 ) {
+        if ( left & mask ) {
+            product ^= right;
+
+            if ( ( left & ( mask - 1 ) ) == 0 )
+                break;
         }
+
+        right = ( right >> 1 ) ^ ( NET_CRC32C_POLYNOMIAL & ( 0 - ( right & 1 ) ) );
     }
 
-    return enet_false;
+    return product;
 }
 
-size_t net_crypto_get_block_bytes( const uint64_t modulus ) {
-    assert( modulus != 0 );
+void net_crc32c_x2n_init( ) {
+    // x^1 reflected, each next entry squares the previous one : x^( 2^n ).
+    uint32_t power = (uint32_t)1 << 30;
 
-    size_t block_size = 0;
-    size_t temp_m = modulus;
+    for ( uint32_t n = 0; n < 32; n++ ) {
+        net_crc32c_x2n_table[ n ] = power;
+        power = net_crc32c_multiply( power, power );
+    }
+}
 
-    while ( temp_m > 0 ) {
-        temp_m >>= 1;
-        block_size += 1;
+uint32_t net_crc32c_combine( const uint32_t crc, const uint32_t next_crc, size_t next_size ) {
+    pthread_once( &net_crc32c_x2n_once, net_crc32c_x2n_init );
+
+    // crc shifted over next_size zero bytes is crc times x^( 8 * next_size ).
+    uint32_t shift = (uint32_t)1 << 31;
+
+    for ( uint32_t n = 3; next_size != 0; next_size >>= 1, n = ( n + 1 ) & 31 ) {
+        if ( next_size & 1 )
+            shift = net_crc32c_multiply( net_crc32c_x2n_table[ n ], shift );
     }
 
-    const size_t byte_count = (block_size - 1) / 8;
+    return net_crc32c_multiply( shift, crc ) ^ next_crc;
+}
 
-    if ( byte_count > 0 )
-        return byte_count;
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// COMPRESSION
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#define NET_LZ_HASH_BITS 12
+#define NET_LZ_MIN_MATCH 4
+#define NET_LZ_MAX_OFFSET 0xFFFF
+#define NET_LZ_LAST_LITERALS 5
+#define NET_LZ_MF_LIMIT 12
+#define NET_LZ_SKIP_TRIGGER 6
+#define NET_LZ_WINDOW_SIZE ( 2 * NET_LZ_MAX_OFFSET )
 
-    return 1;
+uint32_t net_lz_bound( const uint32_t size ) {
+    return size + size / 255 + 16;
 }
 
-uint64_t net_crypto_pack_block( const uint8_t *data, const size_t length ) {
-    assert( data != NULL );
+static uint32_t net_lz_read32( const uint8_t* src ) {
+    uint32_t value = 0;
 
-    uint64_t packed = 0;
+    memcpy( &value, src, sizeof( uint32_t ) );
 
-    for ( size_t i = 0; i < length; i++ )
-        packed = (packed << 8) | data[i];
+    return value;
+}
 
-    return packed;
+static uint32_t net_lz_hash( const uint32_t sequence ) {
+    return ( sequence * 2654435761u ) >> ( 32 - NET_LZ_HASH_BITS );
 }
 
-void net_crypto_unpack_block(
-    const uint64_t packed,
-    uint8_t* data, 
-    const size_t length
+static uint8_t* net_lz_put_length( uint8_t* dst, uint32_t length ) {
+    for ( ; length >= 255; length -= 255 )
+        *dst++ = 255;
+
+    *dst++ = (uint8_t)length;
+
+    return dst;
+}
+
+static uint32_t net_lz_length_size( const uint32_t length ) {
+    return ( length >= 15 ) ? ( length - 15 ) / 255 + 1 : 0;
+}
+
+/**
+ * Write one sequence, match_length 0 closes the block with literals only.
+ * @return : NULL when the sequence would overflow end.
+ **/
+static uint8_t* net_lz_put_sequence(
+    uint8_t* dst,
+    const uint8_t* end,
+    const uint8_t* literals,
+    const uint32_t literal_length,
+    const uint32_t offset,
+    const uint32_t match_length
 ) {
-    assert( data != NULL );
+    const uint32_t match_code = ( match_length > 0 ) ? match_length - NET_LZ_MIN_MATCH : 0;
+    const size_t need = 1 + net_lz_length_size( literal_length ) + literal_length + 
+        ( ( match_length > 0 ) ? 2 + net_lz_length_size( match_code ) : 0 );
 
-    uint64_t temp_p = packed;
+    if ( (size_t)( end - dst ) < need )
+        return NULL;
 
-    for ( size_t i = 0; i < length; i++ ) {
-        data[length - i - 1] = temp_p & 0xFF;
+    uint8_t* token = dst++;
 
-        temp_p >>= 8;
+    (*token) = (uint8_t)( ( ( literal_length < 15 ) ? literal_length : 15 ) << 4 );
+
+    if ( literal_length >= 15 )
+        dst = net_lz_put_length( dst, literal_length - 15 );
+
+    memcpy( dst, literals, literal_length );
+    dst += literal_length;
+
+    if ( match_length == 0 )
+        return dst;
+
+    (*token) |= (uint8_t)( ( match_code < 15 ) ? match_code : 15 );
+
+    *dst++ = (uint8_t)( offset & 0xFF );
+    *dst++ = (uint8_t)( offset >> 8 );
+
+    if ( match_code >= 15 )
+        dst = net_lz_put_length( dst, match_code - 15 );
+
+    return dst;
+}
+
+uint32_t net_lz_compress( const uint8_t* src, const uint32_t size, uint8_t* dst, const uint32_t capacity ) {
+    assert( src != NULL || size == 0 );
+    assert( dst != NULL );
+
+    uint32_t table[ 1 << NET_LZ_HASH_BITS ];
+    memset( table, 0x00, sizeof( table ) );
+
+    // Matches end at least NET_LZ_LAST_LITERALS before the end and start at least
+    // NET_LZ_MF_LIMIT before it, LZ4 decoders rely on both.
+    uint8_t* out = dst;
+    const uint8_t* end = dst + capacity;
+    const uint32_t limit = ( size > NET_LZ_MF_LIMIT ) ? size - NET_LZ_LAST_LITERALS : 0;
+    const uint32_t match_limit = ( size > NET_LZ_MF_LIMIT ) ? size - NET_LZ_MF_LIMIT : 0;
+    uint32_t anchor = 0;
+    uint32_t pos = 1;
+
+    while ( pos <= match_limit ) {
+        const uint32_t sequence = net_lz_read32( src + pos );
+        const uint32_t hash = net_lz_hash( sequence );
+        uint32_t candidate = table[ hash ];
+
+        table[ hash ] = pos;
+
+        if ( pos - candidate > NET_LZ_MAX_OFFSET || net_lz_read32( src + candidate ) != sequence ) {
+            // Incompressible runs are crossed faster the longer they get.
+            pos += 1 + ( ( pos - anchor ) >> NET_LZ_SKIP_TRIGGER );
+            continue;
+        }
+
+        uint32_t length = NET_LZ_MIN_MATCH;
+
+        while ( pos + length < limit && src[ candidate + length ] == src[ pos + length ] )
+            length += 1;
+
+        while ( pos > anchor && candidate > 0 && src[ pos - 1 ] == src[ candidate - 1 ] ) {
+            pos -= 1;
+            candidate -= 1;
+            length += 1;
+        }
+
+        out = net_lz_put_sequence( out, end, src + anchor, pos - anchor, pos - candidate, length );
+
+        if ( out == NULL )
+            return 0;
+
+        pos += length;
+        anchor = pos;
+
+        if ( pos >= 2 && pos <= match_limit )
+            table[ net_lz_hash( net_lz_read32( src + pos - 2 ) ) ] = pos - 2;
     }
+
+    out = net_lz_put_sequence( out, end, src + anchor, size - anchor, 0, 0 );
+
+    return ( out != NULL ) ? (uint32_t)( out - dst ) : 0;
 }
 
-enet_booleans net_crypto_encrypt(
-    const net_crypto_key_t* key,
-    const net_buffer_t* restrict src,
-    net_buffer_t* restrict dst
-) {
-    assert(net_crypto_is_key_valid(key) == enet_true);
-    assert(net_buffer_is_valid(src) == enet_true);
-    assert(src->size > 0);
+static enet_booleans net_lz_get_length( const uint8_t** src, const uint8_t* end, uint32_t* length ) {
+    uint8_t value = 255;
 
-    const size_t block_bytes = net_crypto_get_block_bytes( key->modulus );
-    const size_t block_count = ( src->size + block_bytes - 1 ) / block_bytes;
-    const size_t out_size = block_count * sizeof(uint64_t);
+    while ( value == 255 ) {
+        if ( (*src) == end || (*length) > UINT32_MAX - 255 )
+            return enet_false;
 
-    if ( net_buffer_create( dst, out_size ) == enet_false )
-        return enet_false;
+        value = *(*src)++;
+        (*length) += value;
+    }
 
-    net_buffer_resize( dst, out_size );
+    return enet_true;
+}
+
+enet_booleans net_lz_decompress( const uint8_t* src, const uint32_t size, uint8_t* dst, const uint32_t raw_size ) {
+    const uint8_t* end = src + size;
+    uint32_t written = 0;
+
+    while ( src < end ) {
+        const uint8_t token = *src++;
+        uint32_t length = token >> 4;
+
+        if ( length == 15 && net_lz_get_length( &src, end, &length ) == enet_false )
+            return enet_false;
+
+        if ( length > (uint32_t)( end - src ) || length > raw_size - written )
+            return enet_false;
+
+        memcpy( dst + written, src, length );
+        src += length;
+        written += length;
+
+        if ( src == end )
+            break;
+
+        if ( end - src < 2 )
+            return enet_false;
+
+        const uint32_t offset = (uint32_t)src[ 0 ] | ( (uint32_t)src[ 1 ] << 8 );
+
+        src += 2;
+        length = token & 0x0F;
 
-    const uint8_t* src_buffer = (const uint8_t*)src->data;
-    uint64_t* dst_buffer = (uint64_t*)dst->data;
+        if ( length == 15 && net_lz_get_length( &src, end, &length ) == enet_false )
+            return enet_false;
 
-    for ( size_t i = 0; i < block_count; i++ ) {
-        const size_t offset = i * block_bytes;
-        size_t len = block_bytes;
+        length += NET_LZ_MIN_MATCH;
 
-        if ( offset + len > src->size )
-            len = src->size - offset;
+        if ( offset == 0 || offset > written || length > raw_size - written )
+            return enet_false;
 
-        const uint64_t packed = net_crypto_pack_block( src_buffer + offset, len );
+        const uint8_t* match = dst + written - offset;
 
-        assert( packed < key->modulus );
+        // Overlapping matches repeat the last offset bytes, they are copied one by one.
+        if ( offset >= length )
+            memcpy( dst + written, match, length );
+        else {
+            for ( uint32_t i = 0; i < length; i++ )
+                dst[ written + i ] = match[ i ];
+        }
 
-        dst_buffer[ i ] = net_crypto_modular_pow( packed, key );
+        written += length;
     }
 
+    return ( written == raw_size ) ? enet_true : enet_false;
+}
+
+enet_booleans net_lz_encode( const uint8_t* src, const uint32_t size, net_buffer_t* out ) {
+    if ( size <= sizeof( uint32_t ) )
+        return enet_false;
+
+    // Encodings that don't save anything are dropped, so the block never exceeds size.
+    const uint32_t capacity = size - sizeof( uint32_t );
+
+    if ( net_buffer_reserve( out, sizeof( uint32_t ) + capacity ) == enet_false )
+        return enet_false;
+
+    uint8_t* dst = net_buffer_get_raw( out ) + out->size;
+    const uint32_t block_size = net_lz_compress( src, size, dst + sizeof( uint32_t ), capacity );
+
+    if ( block_size == 0 || block_size >= capacity )
+        return enet_false;
+
+    const uint32_t raw_size = htobe32( size );
+
+    memcpy( dst, &raw_size, sizeof( uint32_t ) );
+    out->size += sizeof( uint32_t ) + block_size;
+
     return enet_true;
 }
 
-enet_booleans net_crypto_decrypt(
-    const net_crypto_key_t* key,
-    const net_buffer_t* restrict src,
-    net_buffer_t* restrict dst
-) {
-    assert( net_crypto_is_key_valid( key ) == enet_true );
-    assert( net_buffer_is_valid( src ) == enet_true );
-    assert( src->size > 0 );
+uint32_t net_lz_get_raw_size( const uint8_t* src, const uint32_t size ) {
+    if ( size < sizeof( uint32_t ) )
+        return 0;
 
-    const size_t block_bytes = net_crypto_get_block_bytes( key->modulus );
-    const size_t block_count = src->size / sizeof(uint64_t);
-    const size_t out_size = block_bytes * block_count;
+    uint32_t raw_size = 0;
 
-    if ( net_buffer_create( dst, out_size ) == enet_false )
+    memcpy( &raw_size, src, sizeof( uint32_t ) );
+
+    return be32toh( raw_size );
+}
+
+enet_booleans net_lz_decode( const uint8_t* src, const uint32_t size, uint8_t* dst ) {
+    const uint32_t raw_size = net_lz_get_raw_size( src, size );
+
+    if ( raw_size == 0 )
         return enet_false;
 
-    net_buffer_resize( dst, out_size );
+    return net_lz_decompress( src + sizeof( uint32_t ), size - sizeof( uint32_t ), dst, raw_size );
+}
+
+enet_booleans net_lz_stream_begin( net_lz_stream_t* stream, const uint8_t* src, const uint32_t size ) {
+    assert( stream != NULL );
+
+    memset( stream, 0x00, sizeof( net_lz_stream_t ) );
+
+    stream->raw_left = net_lz_get_raw_size( src, size );
+
+    if ( stream->raw_left == 0 )
+        return enet_false;
+
+    stream->src = src + sizeof( uint32_t );
+    stream->end = src + size;
+    stream->window = malloc( NET_LZ_WINDOW_SIZE );
+
+    return ( stream->window != NULL ) ? enet_true : enet_false;
+}
+
+/**
+ * Read the token and the literal length of the next sequence.
+ **/
+static enet_booleans net_lz_stream_next( net_lz_stream_t* stream ) {
+    if ( stream->src == stream->end )
+        return enet_false;
+
+    stream->token = *stream->src++;
+    stream->literal_left = stream->token >> 4;
+    stream->has_match = enet_true;
+
+    if ( stream->literal_left == 15 && net_lz_get_length( &stream->src, stream->end, &stream->literal_left ) == enet_false )
+        return enet_false;
+
+    return ( stream->literal_left <= (uint32_t)( stream->end - stream->src ) ) ? enet_true : enet_false;
+}
 
-    const uint64_t* src_buffer = (const uint64_t*)src->data;
-    uint8_t* dst_buffer = (uint8_t*)dst->data;
+/**
+ * Read the offset and the match length of the current sequence, once its literals are copied.
+ **/
+static enet_booleans net_lz_stream_match( net_lz_stream_t* stream ) {
+    stream->has_match = enet_false;
 
-    for ( size_t i = 0; i < block_count; i++ ) {
-        const size_t offset = i * block_bytes;
-        const uint64_t packed = net_crypto_modular_pow( src_buffer[ i ], key );
+    if ( stream->end - stream->src < 2 )
+        return enet_false;
+
+    stream->offset = (uint32_t)stream->src[ 0 ] | ( (uint32_t)stream->src[ 1 ] << 8 );
+    stream->src += 2;
+    stream->match_left = stream->token & 0x0F;
+
+    if ( stream->match_left == 15 && net_lz_get_length( &stream->src, stream->end, &stream->match_left ) == enet_false )
+        return enet_false;
+
+    stream->match_left += NET_LZ_MIN_MATCH;
+
+    return ( stream->offset > 0 && stream->offset <= stream->window_size ) ? enet_true : enet_false;
+}
+
+enet_booleans net_lz_stream_read( net_lz_stream_t* stream, uint8_t* dst, const uint32_t length ) {
+    assert( stream != NULL );
+    assert( stream->window != NULL );
+
+    if ( length > stream->raw_left )
+        return enet_false;
+
+    uint32_t produced = 0;
+
+    while ( produced < length ) {
+        if ( stream->literal_left == 0 && stream->match_left == 0 ) {
+            const enet_booleans result = ( stream->has_match == enet_true ) ? 
+                net_lz_stream_match( stream ) : net_lz_stream_next( stream );
+
+            if ( result == enet_false )
+                return enet_false;
+
+            continue;
+        }
+
+        // A full window drops all but the farthest history a match can reach.
+        if ( stream->window_size == NET_LZ_WINDOW_SIZE ) {
+            memmove( stream->window, stream->window + NET_LZ_WINDOW_SIZE - NET_LZ_MAX_OFFSET, NET_LZ_MAX_OFFSET );
+            stream->window_size = NET_LZ_MAX_OFFSET;
+        }
+
+        uint8_t* out = stream->window + stream->window_size;
+        uint32_t count = length - produced;
+
+        if ( count > NET_LZ_WINDOW_SIZE - stream->window_size )
+            count = NET_LZ_WINDOW_SIZE - stream->window_size;
+
+        if ( stream->literal_left > 0 ) {
+            if ( count > stream->literal_left )
+                count = stream->literal_left;
+
+            memcpy( out, stream->src, count );
+            stream->src += count;
+            stream->literal_left -= count;
+        } else {
+            if ( count > stream->match_left )
+                count = stream->match_left;
+
+            const uint8_t* match = out - stream->offset;
+
+            // Overlapping matches repeat the last offset bytes, they are copied one by one.
+            if ( stream->offset >= count )
+                memcpy( out, match, count );
+            else {
+                for ( uint32_t i = 0; i < count; i++ )
+                    out[ i ] = match[ i ];
+            }
+
+            stream->match_left -= count;
+        }
 
-        net_crypto_unpack_block(packed, dst_buffer + offset, block_bytes);
+        memcpy( dst + produced, out, count );
+        stream->window_size += count;
+        produced += count;
     }
 
+    stream->raw_left -= length;
+
+    // The last sequence is literals only and closes the block.
+    if ( stream->raw_left == 0 )
+        return ( stream->src == stream->end && stream->literal_left == 0 && stream->match_left == 0 ) ? enet_true : enet_false;
+
     return enet_true;
 }
 
-enet_booleans net_crypto_is_key_valid( const net_crypto_key_t* key ) {
-    assert( key != NULL );
+enet_booleans net_lz_stream_skip( net_lz_stream_t* stream, uint32_t length ) {
+    uint8_t buffer[ 4096 ];
 
-    if ( key->exponent == 0 || key->modulus == 0 )
-        return enet_false;
+    while ( length > 0 ) {
+        const uint32_t count = ( length < sizeof( buffer ) ) ? length : sizeof( buffer );
+
+        if ( net_lz_stream_read( stream, buffer, count ) == enet_false )
+            return enet_false;
+
+        length -= count;
+    }
+
+    return enet_true;
+}
+
+void net_lz_stream_end( net_lz_stream_t* stream ) {
+    assert( stream != NULL );
+
+    free( stream->window );
+
+    stream->window = NULL;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// HASH
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#define NET_SHA256_BLOCK_SIZE 64
+#define NET_SHA256_ROTR( x, n ) ( ( ( x ) >> ( n ) ) | ( ( x ) << ( 32 - ( n ) ) ) )
+
+static const uint32_t net_sha256_constants[ 64 ] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+static void net_sha256_block( uint32_t state[ 8 ], const uint8_t* block ) {
+    uint32_t schedule[ 64 ];
+
+    for ( uint32_t i = 0; i < 16; i++ ) {
+        schedule[ i ] = (uint32_t)block[ i * 4 ] << 24 | (uint32_t)block[ i * 4 + 1 ] << 16 |
+                        (uint32_t)block[ i * 4 + 2 ] << 8 | (uint32_t)block[ i * 4 + 3 ];
+    }
+
+    for ( uint32_t i = 16; i < 64; i++ ) {
+        const uint32_t s0 = NET_SHA256_ROTR( schedule[ i - 15 ], 7 ) ^ NET_SHA256_ROTR( schedule[ i - 15 ], 18 ) ^ ( schedule[ i - 15 ] >> 3 );
+        const uint32_t s1 = NET_SHA256_ROTR( schedule[ i - 2 ], 17 ) ^ NET_SHA256_ROTR( schedule[ i - 2 ], 19 ) ^ ( schedule[ i - 2 ] >> 10 );
+
+        schedule[ i ] = schedule[ i - 16 ] + s0 + schedule[ i - 7 ] + s1;
+    }
+
+    uint32_t a = state[ 0 ], b = state[ 1 ], c = state[ 2 ], d = state[ 3 ];
+    uint32_t e = state[ 4 ], f = state[ 5 ], g = state[ 6 ], h = state[ 7 ];
+
+    for ( uint32_t i = 0; i < 64; i++ ) {
+        const uint32_t s1 = NET_SHA256_ROTR( e, 6 ) ^ NET_SHA256_ROTR( e, 11 ) ^ NET_SHA256_ROTR( e, 25 );
+        const uint32_t t1 = h + s1 + ( ( e & f ) ^ ( ~e & g ) ) + net_sha256_constants[ i ] + schedule[ i ];
+        const uint32_t s0 = NET_SHA256_ROTR( a, 2 ) ^ NET_SHA256_ROTR( a, 13 ) ^ NET_SHA256_ROTR( a, 22 );
+        const uint32_t t2 = s0 + ( ( a & b ) ^ ( a & c ) ^ ( b & c ) );
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[ 0 ] += a;
+    state[ 1 ] += b;
+    state[ 2 ] += c;
+    state[ 3 ] += d;
+    state[ 4 ] += e;
+    state[ 5 ] += f;
+    state[ 6 ] += g;
+    state[ 7 ] += h;
+}
+
+void net_sha256( const void* data, const size_t size, uint8_t digest[ NET_SHA256_SIZE ] ) {
+    assert( data != NULL || size == 0 );
+    assert( digest != NULL );
+
+    uint32_t state[ 8 ] = {
+        0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+    };
+    const uint8_t* src = (const uint8_t*)data;
+    size_t remaining = size;
+
+    while ( remaining >= NET_SHA256_BLOCK_SIZE ) {
+        net_sha256_block( state, src );
+
+        src += NET_SHA256_BLOCK_SIZE;
+        remaining -= NET_SHA256_BLOCK_SIZE;
+    }
+
+    // Padding : 0x80, zeros, then the message length in bits, on one or two blocks.
+    uint8_t tail[ NET_SHA256_BLOCK_SIZE * 2 ] = { 0 };
+    const uint32_t tail_size = ( remaining < NET_SHA256_BLOCK_SIZE - 8 ) ? NET_SHA256_BLOCK_SIZE : NET_SHA256_BLOCK_SIZE * 2;
+    const uint64_t bits = (uint64_t)size * 8;
+
+    if ( remaining > 0 )
+        memcpy( tail, src, remaining );
+
+    tail[ remaining ] = 0x80;
+
+    for ( uint32_t i = 0; i < 8; i++ )
+        tail[ tail_size - 1 - i ] = (uint8_t)( bits >> ( i * 8 ) );
+
+    for ( uint32_t offset = 0; offset < tail_size; offset += NET_SHA256_BLOCK_SIZE )
+        net_sha256_block( state, tail + offset );
+
+    for ( uint32_t i = 0; i < 8; i++ ) {
+        digest[ i * 4 ]     = (uint8_t)( state[ i ] >> 24 );
+        digest[ i * 4 + 1 ] = (uint8_t)( state[ i ] >> 16 );
+        digest[ i * 4 + 2 ] = (uint8_t)( state[ i ] >> 8 );
+        digest[ i * 4 + 3 ] = (uint8_t)state[ i ];
+    }
+}
+
+// Cut masks sit in the high bits, the only ones a shifting gear hash mixes
+// the whole window into. The strict one is used below the average size.
+#define NET_CDC_MASK_STRICT ( (uint64_t)0x7FFF << 48 )
+#define NET_CDC_MASK_LOOSE ( (uint64_t)0x07FF << 48 )
+
+uint64_t net_cdc_gear[ 256 ];
+pthread_once_t net_cdc_gear_once = PTHREAD_ONCE_INIT;
+
+void net_cdc_gear_init( ) {
+    // Fixed seed splitmix64, chunk boundaries must be the same from run to run.
+    uint64_t seed = 0x9E3779B97F4A7C15;
+
+    for ( uint32_t byte = 0; byte < 256; byte++ ) {
+        uint64_t value = ( seed += 0x9E3779B97F4A7C15 );
+
+        value = ( value ^ ( value >> 30 ) ) * 0xBF58476D1CE4E5B9;
+        value = ( value ^ ( value >> 27 ) ) * 0x94D049BB133111EB;
+
+        net_cdc_gear[ byte ] = value ^ ( value >> 31 );
+    }
+}
+
+uint32_t net_cdc_cut( const uint8_t* src, const uint32_t size ) {
+    assert( src != NULL || size == 0 );
+
+    if ( size <= NET_CDC_MIN_SIZE )
+        return size;
+
+    pthread_once( &net_cdc_gear_once, net_cdc_gear_init );
+
+    const uint32_t limit = ( size < NET_CDC_MAX_SIZE ) ? size : NET_CDC_MAX_SIZE;
+    const uint32_t normal = ( limit < NET_CDC_AVERAGE_SIZE ) ? limit : NET_CDC_AVERAGE_SIZE;
+    uint64_t hash = 0;
+    uint32_t offset = NET_CDC_MIN_SIZE;
+
+    for ( ; offset < normal; offset++ ) {
+        hash = ( hash << 1 ) + net_cdc_gear[ src[ offset ] ];
+
+        if ( ( hash & NET_CDC_MASK_STRICT ) == 0 )
+            return offset + 1;
+    }
+
+    for ( ; offset < limit; offset++ ) {
+        hash = ( hash << 1 ) + net_cdc_gear[ src[ offset ] ];
+
+        if ( ( hash & NET_CDC_MASK_LOOSE ) == 0 )
+            return offset + 1;
+    }
+
+    return limit;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// BLOOM
+/////////////////////////////////////////////////////////////////////////////////////////////////
+enet_booleans net_bloom_create( net_bloom_t* bloom, const uint32_t capacity ) {
+    assert( bloom != NULL );
+
+    uint64_t bit_count = (uint64_t)capacity * NET_BLOOM_BITS_PER_ITEM;
+
+    if ( bit_count < NET_BLOOM_MIN_BITS )
+        bit_count = NET_BLOOM_MIN_BITS;
+
+    bit_count = ( bit_count + 7 ) & ~(uint64_t)7;
+
+    if ( bit_count > UINT32_MAX - 7 )
+        return enet_false;
+
+    bloom->bit_count  = (uint32_t)bit_count;
+    bloom->item_count = 0;
+    bloom->capacity   = capacity;
+    bloom->bits       = calloc( bloom->bit_count / 8, sizeof( uint8_t ) );
+
+    return ( bloom->bits != NULL ) ? enet_true : enet_false;
+}
+
+void net_bloom_destroy( net_bloom_t* bloom ) {
+    assert( bloom != NULL );
+
+    free( bloom->bits );
+    memset( bloom, 0x00, sizeof( net_bloom_t ) );
+}
+
+/**
+ * Two independent 32 bits hashes of an item, FNV-1a 64 run through the splitmix64
+ * finalizer. The k probes are derived from them ( Kirsch-Mitzenmacher ).
+ **/
+void net_bloom_hash( const void* data, const size_t size, uint32_t* h1, uint32_t* h2 ) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for ( size_t i = 0; i < size; i++ ) {
+        hash ^= bytes[ i ];
+        hash *= 0x100000001B3ULL;
+    }
+
+    hash = ( hash ^ ( hash >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    hash = ( hash ^ ( hash >> 27 ) ) * 0x94D049BB133111EBULL;
+    hash = hash ^ ( hash >> 31 );
+
+    (*h1) = (uint32_t)hash;
+    (*h2) = (uint32_t)( hash >> 32 ) | 1;
+}
+
+void net_bloom_add( net_bloom_t* bloom, const void* data, const size_t size ) {
+    assert( bloom != NULL && bloom->bits != NULL );
+
+    uint32_t h1 = 0;
+    uint32_t h2 = 0;
+
+    net_bloom_hash( data, size, &h1, &h2 );
+
+    for ( uint32_t i = 0; i < NET_BLOOM_HASH_COUNT; i++ ) {
+        const uint32_t bit = (uint32_t)( ( h1 + (uint64_t)i * h2 ) % bloom->bit_count );
+
+        bloom->bits[ bit / 8 ] |= (uint8_t)( 1 << ( bit % 8 ) );
+    }
+
+    bloom->item_count += 1;
+}
+
+enet_booleans net_bloom_test( const net_bloom_t* bloom, const void* data, const size_t size ) {
+    assert( bloom != NULL && bloom->bits != NULL );
+
+    uint32_t h1 = 0;
+    uint32_t h2 = 0;
+
+    net_bloom_hash( data, size, &h1, &h2 );
+
+    for ( uint32_t i = 0; i < NET_BLOOM_HASH_COUNT; i++ ) {
+        const uint32_t bit = (uint32_t)( ( h1 + (uint64_t)i * h2 ) % bloom->bit_count );
+
+        if ( ( bloom->bits[ bit / 8 ] & ( 1 << ( bit % 8 ) ) ) == 0 )
+            return enet_false;
+    }
+
+    return enet_true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CRYPTO ( RSA-TOY )
+/////////////////////////////////////////////////////////////////////////////////////////////////
+uint32_t net_crypto_modulus_bits = 0;
+
+void net_crypto_init_seed( uint32_t seed ) {
+    srand( seed );
+}
+
+void net_crypto_init_key_size( uint32_t modulus_bits ) {
+    if ( modulus_bits != 0 && modulus_bits < NET_CRYPTO_MIN_MODULUS_BITS )
+        modulus_bits = NET_CRYPTO_MIN_MODULUS_BITS;
+    else if ( modulus_bits > NET_CRYPTO_MAX_MODULUS_BITS )
+        modulus_bits = NET_CRYPTO_MAX_MODULUS_BITS;
+
+    net_crypto_modulus_bits = modulus_bits;
+}
+
+uint64_t net_crypto_mul_mod( const uint64_t a, const uint64_t b, const uint64_t modulus ) {
+    return (uint64_t)( ( (unsigned __int128)a * b ) % modulus );
+}
+
+uint64_t net_crypto_pow_mod( uint64_t base, uint64_t exponent, const uint64_t modulus ) {
+    uint64_t result = 1;
+
+    base %= modulus;
+
+    while ( exponent > 0 ) {
+        if ( exponent & 1 )
+            result = net_crypto_mul_mod( result, base, modulus );
+
+        base = net_crypto_mul_mod( base, base, modulus );
+
+        exponent >>= 1;
+    }
+
+    return result;
+}
+
+void net_crypto_montgomery_init(
+    net_crypto_montgomery_t* montgomery,
+    const uint64_t modulus,
+    const uint64_t exponent
+) {
+    memset( montgomery, 0x00, sizeof( net_crypto_montgomery_t ) );
+
+    if ( ( modulus & 1 ) == 0 || modulus >= ( (uint64_t)1 << 63 ) || exponent == 0 )
+        return;
+
+    uint64_t inverse = modulus;
+
+    for ( uint32_t i = 0; i < 5; i++ )
+        inverse *= 2 - modulus * inverse;
+
+    const uint64_t r = (uint64_t)( ( (unsigned __int128)1 << 64 ) % modulus );
+
+    montgomery->modulus = modulus;
+    montgomery->inverse = -inverse;
+    montgomery->square  = net_crypto_mul_mod( r, r, modulus );
+
+    uint32_t bit_count = 0;
+    uint64_t temp_e = exponent;
+
+    while ( temp_e > 0 ) {
+        temp_e >>= 1;
+        bit_count += 1;
+    }
+
+    if ( bit_count <= 8 )
+        montgomery->window_width = 1;
+    else if ( bit_count <= 24 )
+        montgomery->window_width = 3;
+    else
+        montgomery->window_width = 4;
+
+    const uint32_t width = montgomery->window_width;
+
+    montgomery->window_count = ( bit_count + width - 1 ) / width;
+
+    for ( uint32_t i = 0; i < montgomery->window_count; i++ ) {
+        const uint32_t shift = ( montgomery->window_count - i - 1 ) * width;
+
+        montgomery->window_list[ i ] = (uint8_t)( ( exponent >> shift ) & ( ( 1u << width ) - 1 ) );
+    }
+}
+
+uint64_t net_crypto_montgomery_reduce(
+    const net_crypto_montgomery_t* montgomery,
+    const unsigned __int128 value
+) {
+    const uint64_t m = (uint64_t)value * montgomery->inverse;
+    const unsigned __int128 sum = value + (unsigned __int128)m * montgomery->modulus;
+    uint64_t result = (uint64_t)( sum >> 64 );
+
+    if ( result >= montgomery->modulus )
+        result -= montgomery->modulus;
+
+    return result;
+}
+
+uint64_t net_crypto_montgomery_mul(
+    const net_crypto_montgomery_t* montgomery,
+    const uint64_t a,
+    const uint64_t b
+) {
+    return net_crypto_montgomery_reduce( montgomery, (unsigned __int128)a * b );
+}
+
+/**
+ * Fixed window exponentiation, the table hold base^0 to base^(2^width - 1)
+ * in Montgomery form and each window cost width squares plus one multiply.
+ **/
+uint64_t net_crypto_montgomery_pow(
+    const net_crypto_montgomery_t* montgomery,
+    const uint64_t base
+) {
+    uint64_t table[ 16 ];
+    const uint32_t table_size = 1u << montgomery->window_width;
+
+    table[ 0 ] = net_crypto_montgomery_reduce( montgomery, montgomery->square );
+    table[ 1 ] = net_crypto_montgomery_mul( montgomery, base % montgomery->modulus, montgomery->square );
+
+    for ( uint32_t i = 2; i < table_size; i++ )
+        table[ i ] = net_crypto_montgomery_mul( montgomery, table[ i - 1 ], table[ 1 ] );
+
+    uint64_t result = table[ montgomery->window_list[ 0 ] ];
+
+    for ( uint32_t i = 1; i < montgomery->window_count; i++ ) {
+        for ( uint32_t j = 0; j < montgomery->window_width; j++ )
+            result = net_crypto_montgomery_mul( montgomery, result, result );
+
+        const uint8_t digit = montgomery->window_list[ i ];
+
+        if ( digit != 0 )
+            result = net_crypto_montgomery_mul( montgomery, result, table[ digit ] );
+    }
+
+    return net_crypto_montgomery_reduce( montgomery, result );
+}
+
+enet_booleans net_crypto_montgomery_is_ready(
+    const net_crypto_montgomery_t* montgomery,
+    const uint64_t modulus
+) {
+    if ( montgomery->modulus == 0 || montgomery->modulus != modulus )
+        return enet_false;
+
+    return enet_true;
+}
+
+void net_crypto_key_prepare( net_crypto_key_t* key ) {
+    assert( key != NULL );
+
+    net_crypto_montgomery_init( &key->montgomery_n, key->modulus, key->exponent );
+
+    if ( key->p != 0 && key->q != 0 ) {
+        net_crypto_montgomery_init( &key->montgomery_p, key->p, key->dp );
+        net_crypto_montgomery_init( &key->montgomery_q, key->q, key->dq );
+    } else {
+        memset( &key->montgomery_p, 0x00, sizeof( net_crypto_montgomery_t ) );
+        memset( &key->montgomery_q, 0x00, sizeof( net_crypto_montgomery_t ) );
+    }
+}
+
+/**
+ * Private keys work modulo p and q then recombine with Garner's formula,
+ * each half use exponents and operands of half the modulus width.
+ **/
+uint64_t net_crypto_modular_pow_crt( uint64_t base, const net_crypto_key_t* key ) {
+    const uint64_t m1 = net_crypto_montgomery_pow( &key->montgomery_p, base % key->p );
+    const uint64_t m2 = net_crypto_montgomery_pow( &key->montgomery_q, base % key->q );
+    const uint64_t m2_p = m2 % key->p;
+    const uint64_t delta = ( m1 >= m2_p ) ? m1 - m2_p : key->p - ( m2_p - m1 );
+    const uint64_t h = net_crypto_mul_mod( key->qinv, delta, key->p );
+
+    return m2 + h * key->q;
+}
+
+uint64_t net_crypto_modular_pow(
+    uint64_t base,
+    const net_crypto_key_t* key
+) {
+    if ( key == NULL || key->modulus == 1 )
+        return 0;
+
+    if ( 
+        key->p != 0 &&
+        net_crypto_montgomery_is_ready( &key->montgomery_p, key->p ) == enet_true &&
+        net_crypto_montgomery_is_ready( &key->montgomery_q, key->q ) == enet_true
+    )
+        return net_crypto_modular_pow_crt( base, key );
+
+    if ( net_crypto_montgomery_is_ready( &key->montgomery_n, key->modulus ) == enet_true )
+        return net_crypto_montgomery_pow( &key->montgomery_n, base );
+
+    return net_crypto_pow_mod( base, key->exponent, key->modulus );
+}
+
+/**
+ * net_crypto_batch_t struct
+ * @field modulus odd modulus below 2^31, so a product plus its Montgomery
+ *        correction always fit in a 64 bits lane.
+ * @field inverse -modulus^-1 mod 2^32.
+ * @field square 2^64 mod modulus, used to enter Montgomery form.
+ * @field exponent exponent shared by every lane.
+ **/
+typedef struct net_crypto_batch_t {
+    uint64_t modulus;
+    uint64_t inverse;
+    uint64_t square;
+    uint64_t exponent;
+} net_crypto_batch_t;
+
+typedef void (*net_crypto_batch_pow_t)(
+    const net_crypto_batch_t* batch,
+    const uint64_t* in,
+    uint64_t* out,
+    const size_t count
+);
+
+uint64_t net_crypto_batch_mul( const net_crypto_batch_t* batch, const uint64_t a, const uint64_t b ) {
+    const uint64_t t = a * b;
+    const uint64_t m = (uint32_t)( (uint32_t)t * (uint32_t)batch->inverse );
+    const uint64_t u = ( t + m * batch->modulus ) >> 32;
+
+    return ( u >= batch->modulus ) ? u - batch->modulus : u;
+}
+
+void net_crypto_batch_pow_scalar(
+    const net_crypto_batch_t* batch,
+    const uint64_t* in,
+    uint64_t* out,
+    const size_t count
+) {
+    const uint32_t top = 63 - (uint32_t)__builtin_clzll( batch->exponent );
+
+    for ( size_t i = 0; i < count; i++ ) {
+        const uint64_t base = net_crypto_batch_mul( batch, in[ i ] % batch->modulus, batch->square );
+        uint64_t result = base;
+
+        for ( uint32_t bit = top; bit-- > 0; ) {
+            result = net_crypto_batch_mul( batch, result, result );
+
+            if ( ( batch->exponent >> bit ) & 1 )
+                result = net_crypto_batch_mul( batch, result, base );
+        }
+
+        out[ i ] = net_crypto_batch_mul( batch, result, 1 );
+    }
+}
+
+#ifdef NET_ARCH_X86
+__attribute__(( target( "avx2" ) ))
+__m256i net_crypto_batch_mul_avx2( const __m256i a, const __m256i b, const __m256i modulus, const __m256i inverse ) {
+    const __m256i t = _mm256_mul_epu32( a, b );
+    const __m256i m = _mm256_mul_epu32( t, inverse );
+    const __m256i u = _mm256_srli_epi64( _mm256_add_epi64( t, _mm256_mul_epu32( m, modulus ) ), 32 );
+    const __m256i keep = _mm256_cmpgt_epi64( modulus, u );
+
+    return _mm256_sub_epi64( u, _mm256_andnot_si256( keep, modulus ) );
+}
+
+/**
+ * Two vectors of four lanes walk the exponent bits in lockstep, the second
+ * vector hide the latency of the first one multiply chain.
+ **/
+__attribute__(( target( "avx2" ) ))
+void net_crypto_batch_pow_avx2(
+    const net_crypto_batch_t* batch,
+    const uint64_t* in,
+    uint64_t* out,
+    const size_t count
+) {
+    const __m256i modulus = _mm256_set1_epi64x( (long long)batch->modulus );
+    const __m256i inverse = _mm256_set1_epi64x( (long long)batch->inverse );
+    const __m256i square  = _mm256_set1_epi64x( (long long)batch->square );
+    const __m256i one     = _mm256_set1_epi64x( 1 );
+    const uint32_t top = 63 - (uint32_t)__builtin_clzll( batch->exponent );
+    size_t i = 0;
+
+    for ( ; i + 8 <= count; i += 8 ) {
+        uint64_t reduced[ 8 ];
+
+        for ( size_t j = 0; j < 8; j++ )
+            reduced[ j ] = in[ i + j ] % batch->modulus;
+
+        const __m256i base_0 = net_crypto_batch_mul_avx2( _mm256_loadu_si256( (const __m256i*)reduced ), square, modulus, inverse );
+        const __m256i base_1 = net_crypto_batch_mul_avx2( _mm256_loadu_si256( (const __m256i*)( reduced + 4 ) ), square, modulus, inverse );
+        __m256i result_0 = base_0;
+        __m256i result_1 = base_1;
+
+        for ( uint32_t bit = top; bit-- > 0; ) {
+            result_0 = net_crypto_batch_mul_avx2( result_0, result_0, modulus, inverse );
+            result_1 = net_crypto_batch_mul_avx2( result_1, result_1, modulus, inverse );
+
+            if ( ( batch->exponent >> bit ) & 1 ) {
+                result_0 = net_crypto_batch_mul_avx2( result_0, base_0, modulus, inverse );
+                result_1 = net_crypto_batch_mul_avx2( result_1, base_1, modulus, inverse );
+            }
+        }
+
+        _mm256_storeu_si256( (__m256i*)( out + i ), net_crypto_batch_mul_avx2( result_0, one, modulus, inverse ) );
+        _mm256_storeu_si256( (__m256i*)( out + i + 4 ), net_crypto_batch_mul_avx2( result_1, one, modulus, inverse ) );
+    }
+
+    net_crypto_batch_pow_scalar( batch, in + i, out + i, count - i );
+}
+
+__attribute__(( target( "avx512f" ) ))
+__m512i net_crypto_batch_mul_avx512( const __m512i a, const __m512i b, const __m512i modulus, const __m512i inverse ) {
+    const __m512i t = _mm512_mul_epu32( a, b );
+    const __m512i m = _mm512_mul_epu32( t, inverse );
+    const __m512i u = _mm512_srli_epi64( _mm512_add_epi64( t, _mm512_mul_epu32( m, modulus ) ), 32 );
+    const __mmask8 over = _mm512_cmpge_epu64_mask( u, modulus );
+
+    return _mm512_mask_sub_epi64( u, over, u, modulus );
+}
+
+/**
+ * Same schedule as the AVX2 kernel with two vectors of eight lanes.
+ **/
+__attribute__(( target( "avx512f" ) ))
+void net_crypto_batch_pow_avx512(
+    const net_crypto_batch_t* batch,
+    const uint64_t* in,
+    uint64_t* out,
+    const size_t count
+) {
+    const __m512i modulus = _mm512_set1_epi64( (long long)batch->modulus );
+    const __m512i inverse = _mm512_set1_epi64( (long long)batch->inverse );
+    const __m512i square  = _mm512_set1_epi64( (long long)batch->square );
+    const __m512i one     = _mm512_set1_epi64( 1 );
+    const uint32_t top = 63 - (uint32_t)__builtin_clzll( batch->exponent );
+    size_t i = 0;
+
+    for ( ; i + 16 <= count; i += 16 ) {
+        uint64_t reduced[ 16 ];
+
+        for ( size_t j = 0; j < 16; j++ )
+            reduced[ j ] = in[ i + j ] % batch->modulus;
+
+        const __m512i base_0 = net_crypto_batch_mul_avx512( _mm512_loadu_si512( reduced ), square, modulus, inverse );
+        const __m512i base_1 = net_crypto_batch_mul_avx512( _mm512_loadu_si512( reduced + 8 ), square, modulus, inverse );
+        __m512i result_0 = base_0;
+        __m512i result_1 = base_1;
+
+        for ( uint32_t bit = top; bit-- > 0; ) {
+            result_0 = net_crypto_batch_mul_avx512( result_0, result_0, modulus, inverse );
+            result_1 = net_crypto_batch_mul_avx512( result_1, result_1, modulus, inverse );
+
+            if ( ( batch->exponent >> bit ) & 1 ) {
+                result_0 = net_crypto_batch_mul_avx512( result_0, base_0, modulus, inverse );
+                result_1 = net_crypto_batch_mul_avx512( result_1, base_1, modulus, inverse );
+            }
+        }
+
+        _mm512_storeu_si512( out + i, net_crypto_batch_mul_avx512( result_0, one, modulus, inverse ) );
+        _mm512_storeu_si512( out + i + 8, net_crypto_batch_mul_avx512( result_1, one, modulus, inverse ) );
+    }
+
+    net_crypto_batch_pow_avx2( batch, in + i, out + i, count - i );
+}
+#endif
+
+net_crypto_batch_pow_t net_crypto_get_batch_pow( ) {
+    static net_crypto_batch_pow_t batch_pow = NULL;
+
+    if ( batch_pow != NULL )
+        return batch_pow;
+
+#ifdef NET_ARCH_X86
+    __builtin_cpu_init( );
+
+    if ( __builtin_cpu_supports( "avx512f" ) )
+        batch_pow = net_crypto_batch_pow_avx512;
+    else if ( __builtin_cpu_supports( "avx2" ) )
+        batch_pow = net_crypto_batch_pow_avx2;
+    else
+#endif
+        batch_pow = net_crypto_batch_pow_scalar;
+
+    return batch_pow;
+}
+
+enet_booleans net_crypto_batch_init(
+    net_crypto_batch_t* batch,
+    const uint64_t modulus,
+    const uint64_t exponent
+) {
+    if ( ( modulus & 1 ) == 0 || modulus >= ( (uint64_t)1 << 31 ) || exponent == 0 )
+        return enet_false;
+
+    uint32_t inverse = (uint32_t)modulus;
+
+    for ( uint32_t i = 0; i < 4; i++ )
+        inverse *= 2 - (uint32_t)modulus * inverse;
+
+    batch->modulus  = modulus;
+    batch->inverse  = (uint32_t)-inverse;
+    batch->square   = (uint64_t)( ( (unsigned __int128)1 << 64 ) % modulus );
+    batch->exponent = exponent;
+
+    return enet_true;
+}
+
+/**
+ * Exponentiate count blocks with the same key. Moduli below 2^31, so every
+ * CRT half of a key up to 62 bits, go through the lockstep SIMD kernels.
+ **/
+void net_crypto_modular_pow_batch(
+    const net_crypto_key_t* key,
+    const uint64_t* in,
+    uint64_t* out,
+    const size_t count
+) {
+    const net_crypto_batch_pow_t batch_pow = net_crypto_get_batch_pow( );
+    net_crypto_batch_t batch_p;
+    net_crypto_batch_t batch_q;
+
+    if ( 
+        key->p != 0 &&
+        net_crypto_batch_init( &batch_p, key->p, key->dp ) == enet_true &&
+        net_crypto_batch_init( &batch_q, key->q, key->dq ) == enet_true
+    ) {
+        uint64_t m1[ NET_CRYPTO_BATCH_SIZE ];
+        uint64_t m2[ NET_CRYPTO_BATCH_SIZE ];
+
+        assert( count <= NET_CRYPTO_BATCH_SIZE );
+
+        batch_pow( &batch_p, in, m1, count );
+        batch_pow( &batch_q, in, m2, count );
+
+        for ( size_t i = 0; i < count; i++ ) {
+            const uint64_t m2_p = m2[ i ] % key->p;
+            const uint64_t delta = ( m1[ i ] >= m2_p ) ? m1[ i ] - m2_p : key->p - ( m2_p - m1[ i ] );
+
+            out[ i ] = m2[ i ] + net_crypto_mul_mod( key->qinv, delta, key->p ) * key->q;
+        }
+
+        return;
+    }
+
+    net_crypto_batch_t batch_n;
+
+    if ( net_crypto_batch_init( &batch_n, key->modulus, key->exponent ) == enet_true ) {
+        batch_pow( &batch_n, in, out, count );
+        return;
+    }
+
+    for ( size_t i = 0; i < count; i++ )
+        out[ i ] = net_crypto_modular_pow( in[ i ], key );
+}
+
+uint64_t net_crypto_rand( const uint64_t modulus, uint64_t offset ) {
+    const uint64_t value = ( (uint64_t)rand( ) << 31 ) ^ (uint64_t)rand( );
+
+    return ( value % modulus ) + offset;
+}
+
+#define NET_CRYPTO_SIEVE_LIMIT 2048
+
+uint32_t net_crypto_small_primes[ NET_CRYPTO_SIEVE_LIMIT / 2 ];
+uint32_t net_crypto_small_prime_count = 0;
+pthread_once_t net_crypto_sieve_once = PTHREAD_ONCE_INIT;
+
+void net_crypto_sieve_init( ) {
+    uint8_t composite[ NET_CRYPTO_SIEVE_LIMIT ];
+
+    memset( composite, 0x00, sizeof( composite ) );
+
+    for ( uint32_t i = 2; i < NET_CRYPTO_SIEVE_LIMIT; i++ ) {
+        if ( composite[ i ] )
+            continue;
+
+        net_crypto_small_primes[ net_crypto_small_prime_count++ ] = i;
+
+        for ( uint32_t j = i * i; j < NET_CRYPTO_SIEVE_LIMIT; j += i )
+            composite[ j ] = 1;
+    }
+}
+
+/**
+ * Deterministic Miller-Rabin for any 64 bits value, the first twelve primes
+ * as witnesses are enough below 3.3e24.
+ **/
+enet_booleans net_crypto_miller_rabin( const uint64_t num ) {
+    static const uint64_t witnesses[ ] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+
+    uint64_t d = num - 1;
+    uint32_t r = 0;
+
+    while ( ( d & 1 ) == 0 ) {
+        d >>= 1;
+        r += 1;
+    }
+
+    for ( size_t i = 0; i < sizeof( witnesses ) / sizeof( uint64_t ); i++ ) {
+        uint64_t x = net_crypto_pow_mod( witnesses[ i ], d, num );
+
+        if ( x == 1 || x == num - 1 )
+            continue;
+
+        uint32_t round = 1;
+
+        for ( ; round < r; round++ ) {
+            x = net_crypto_mul_mod( x, x, num );
+
+            if ( x == num - 1 )
+                break;
+        }
+
+        if ( round == r )
+            return enet_false;
+    }
+
+    return enet_true;
+}
+
+enet_booleans net_crypto_is_prime( uint64_t num ) {
+    pthread_once( &net_crypto_sieve_once, net_crypto_sieve_init );
+
+    if ( num < 2 )
+        return enet_false;
+
+    for ( uint32_t i = 0; i < net_crypto_small_prime_count; i++ ) {
+        const uint64_t prime = net_crypto_small_primes[ i ];
+
+        if ( num == prime )
+            return enet_true;
+
+        if ( num % prime == 0 )
+            return enet_false;
+    }
+
+    if ( num < (uint64_t)NET_CRYPTO_SIEVE_LIMIT * NET_CRYPTO_SIEVE_LIMIT )
+        return enet_true;
+
+    return net_crypto_miller_rabin( num );
+}
+
+uint64_t net_crypto_next_prime( const uint64_t base ) {
+    if ( base <= 2 )
+        return 2;
+
+    uint64_t num = base | 1;
+
+    while ( net_crypto_is_prime( num ) == enet_false )
+        num += 2;
+
+    return num;
+}
+
+uint64_t net_crypto_gcd( uint64_t a, uint64_t b ) {
+    while ( b ) {
+        a %= b;
+
+        uint64_t t = a;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+/**
+ * Extended Euclid, return 0 when value has no inverse modulo modulus.
+ **/
+uint64_t net_crypto_modular_inverse( const uint64_t value, const uint64_t modulus ) {
+    int64_t t = 0;
+    int64_t new_t = 1;
+    uint64_t r = modulus;
+    uint64_t new_r = value % modulus;
+
+    while ( new_r != 0 ) {
+        const uint64_t quotient = r / new_r;
+        const int64_t temp_t = t - (int64_t)quotient * new_t;
+        const uint64_t temp_r = r - quotient * new_r;
+
+        t = new_t;
+        new_t = temp_t;
+        r = new_r;
+        new_r = temp_r;
+    }
+
+    if ( r != 1 )
+        return 0;
+
+    if ( t < 0 )
+        return (uint64_t)( t + (int64_t)modulus );
+
+    return (uint64_t)t;
+}
+
+/**
+ * Draw a prime of exactly bit_count bits with its two top bits set, so the
+ * product of two such primes always use the full modulus width.
+ **/
+uint64_t net_crypto_rand_prime( const uint32_t bit_count ) {
+    const uint64_t low  = (uint64_t)3 << ( bit_count - 2 );
+    const uint64_t high = (uint64_t)1 << bit_count;
+    uint64_t prime = 0;
+
+    do
+        prime = net_crypto_next_prime( net_crypto_rand( high - low, low ) );
+    while ( prime >= high );
+
+    return prime;
+}
+
+enet_booleans net_crypto_generate_keys(
+    net_crypto_key_t* restrict public,
+    net_crypto_key_t* restrict private
+) {
+    uint64_t p = 0;
+    uint64_t q = 0;
+    uint64_t n = p * q;
+    uint64_t phi_n = ( p - 1 ) * ( q - 1 );
+    uint64_t e = 7;
+
+    do {
+        if ( net_crypto_modulus_bits == 0 ) {
+            p = net_crypto_next_prime( net_crypto_rand( 500, 1000 ) );
+            q = net_crypto_next_prime( net_crypto_rand( 500, 1500 ) );
+        } else {
+            p = net_crypto_rand_prime( net_crypto_modulus_bits / 2 );
+            q = net_crypto_rand_prime( net_crypto_modulus_bits - net_crypto_modulus_bits / 2 );
+        }
+
+        if ( p == q )
+            continue;
+
+        n = p * q;
+        phi_n = ( p - 1 ) * ( q - 1 );
+    } while( p == q || net_crypto_gcd( e, phi_n ) != 1 );
+
+    memset( public, 0x00, sizeof( net_crypto_key_t ) );
+    memset( private, 0x00, sizeof( net_crypto_key_t ) );
+
+    public->exponent = e;
+    public->modulus = n;
+    private->modulus = n;
+    private->exponent = net_crypto_modular_inverse( e, phi_n );
+
+    if ( private->exponent == 0 )
+        return enet_false;
+
+    if ( p < q ) {
+        const uint64_t t = p;
+        p = q;
+        q = t;
+    }
+
+    private->p = p;
+    private->q = q;
+    private->dp = private->exponent % ( p - 1 );
+    private->dq = private->exponent % ( q - 1 );
+    private->qinv = net_crypto_modular_inverse( q, p );
+
+    net_crypto_key_prepare( public );
+    net_crypto_key_prepare( private );
+
+    return enet_true;
+}
+
+size_t net_crypto_get_block_bytes( const uint64_t modulus ) {
+    assert( modulus != 0 );
+
+    size_t block_size = 0;
+    size_t temp_m = modulus;
+
+    while ( temp_m > 0 ) {
+        temp_m >>= 1;
+        block_size += 1;
+    }
+
+    const size_t byte_count = (block_size - 1) / 8;
+
+    if ( byte_count > 0 )
+        return byte_count;
+
+    return 1;
+}
+
+uint64_t net_crypto_pack_block( const uint8_t *data, const size_t length ) {
+    assert( data != NULL );
+
+    uint64_t packed = 0;
+
+    for ( size_t i = 0; i < length; i++ )
+        packed = (packed << 8) | data[i];
+
+    return packed;
+}
+
+void net_crypto_unpack_block(
+    const uint64_t packed,
+    uint8_t* data, 
+    const size_t length
+) {
+    assert( data != NULL );
+
+    uint64_t temp_p = packed;
+
+    for ( size_t i = 0; i < length; i++ ) {
+        data[length - i - 1] = temp_p & 0xFF;
+
+        temp_p >>= 8;
+    }
+}
+
+size_t net_crypto_get_block_bits( const uint64_t modulus ) {
+    assert( modulus > 1 );
+
+    size_t bit_count = 0;
+    uint64_t temp_m = modulus - 1;
+
+    while ( temp_m > 0 ) {
+        temp_m >>= 1;
+        bit_count += 1;
+    }
+
+    return bit_count;
+}
+
+/**
+ * net_crypto_bits_t struct
+ * @field data packed stream memory, written or read MSB first.
+ * @field offset next byte of data.
+ * @field accumulator pending bits not yet flushed or consumed.
+ * @field pending count of valid bits in accumulator, always below 8 between calls.
+ **/
+typedef struct net_crypto_bits_t {
+    uint8_t* data;
+    size_t offset;
+    uint64_t accumulator;
+    uint32_t pending;
+} net_crypto_bits_t;
+
+void net_crypto_bits_write( net_crypto_bits_t* bits, const uint64_t value, const uint32_t count ) {
+    if ( count > 32 ) {
+        net_crypto_bits_write( bits, value >> 32, count - 32 );
+        net_crypto_bits_write( bits, value & 0xFFFFFFFF, 32 );
+        return;
+    }
+
+    bits->accumulator = ( bits->accumulator << count ) | value;
+    bits->pending += count;
+
+    while ( bits->pending >= 8 ) {
+        bits->pending -= 8;
+        bits->data[ bits->offset++ ] = (uint8_t)( bits->accumulator >> bits->pending );
+    }
+
+    bits->accumulator &= ( 1u << bits->pending ) - 1;
+}
+
+void net_crypto_bits_flush( net_crypto_bits_t* bits ) {
+    if ( bits->pending == 0 )
+        return;
+
+    bits->data[ bits->offset++ ] = (uint8_t)( bits->accumulator << ( 8 - bits->pending ) );
+    bits->accumulator = 0;
+    bits->pending = 0;
+}
+
+uint64_t net_crypto_bits_read( net_crypto_bits_t* bits, const uint32_t count ) {
+    if ( count > 32 ) {
+        const uint64_t high = net_crypto_bits_read( bits, count - 32 );
+
+        return ( high << 32 ) | net_crypto_bits_read( bits, 32 );
+    }
+
+    while ( bits->pending < count ) {
+        bits->accumulator = ( bits->accumulator << 8 ) | bits->data[ bits->offset++ ];
+        bits->pending += 8;
+    }
+
+    bits->pending -= count;
+
+    const uint64_t value = ( bits->accumulator >> bits->pending ) & ( ( (uint64_t)1 << count ) - 1 );
+
+    bits->accumulator &= ( (uint64_t)1 << bits->pending ) - 1;
+
+    return value;
+}
+
+/**
+ * net_crypto_job_t struct
+ * @field key key used on every block.
+ * @field src source bytes, plaintext or ciphertext.
+ * @field src_size source size in bytes.
+ * @field dst destination bytes.
+ * @field block_bytes plaintext bytes per block.
+ * @field block_bits ciphertext bits per block in packed mode.
+ **/
+typedef struct net_crypto_job_t {
+    const net_crypto_key_t* key;
+    const uint8_t* src;
+    size_t src_size;
+    uint8_t* dst;
+    size_t block_bytes;
+    size_t block_bits;
+} net_crypto_job_t;
+
+uint64_t net_crypto_job_pack( const net_crypto_job_t* job, const size_t block ) {
+    const size_t offset = block * job->block_bytes;
+    size_t len = job->block_bytes;
+
+    if ( offset + len > job->src_size )
+        len = job->src_size - offset;
+
+    // A short tail is padded with zeros to a whole block, blocks keep the legacy
+    // layout and the decrypted tail keep its bytes in place.
+    uint8_t block_data[ sizeof(uint64_t) ] = { 0 };
+
+    memcpy( block_data, job->src + offset, len );
+
+    const uint64_t packed = net_crypto_pack_block( block_data, job->block_bytes );
+
+    assert( packed < job->key->modulus );
+
+    return packed;
+}
+
+void net_crypto_encrypt_range( void* user, const size_t begin, const size_t end ) {
+    const net_crypto_job_t* job = (const net_crypto_job_t*)user;
+    uint64_t* dst_buffer = (uint64_t*)job->dst;
+    uint64_t in[ NET_CRYPTO_BATCH_SIZE ];
+
+    for ( size_t i = begin; i < end; i += NET_CRYPTO_BATCH_SIZE ) {
+        const size_t count = ( end - i < NET_CRYPTO_BATCH_SIZE ) ? end - i : NET_CRYPTO_BATCH_SIZE;
+
+        for ( size_t j = 0; j < count; j++ )
+            in[ j ] = net_crypto_job_pack( job, i + j );
+
+        net_crypto_modular_pow_batch( job->key, in, dst_buffer + i, count );
+    }
+}
+
+void net_crypto_decrypt_range( void* user, const size_t begin, const size_t end ) {
+    const net_crypto_job_t* job = (const net_crypto_job_t*)user;
+    const uint64_t* src_buffer = (const uint64_t*)job->src;
+    uint64_t out[ NET_CRYPTO_BATCH_SIZE ];
+
+    for ( size_t i = begin; i < end; i += NET_CRYPTO_BATCH_SIZE ) {
+        const size_t count = ( end - i < NET_CRYPTO_BATCH_SIZE ) ? end - i : NET_CRYPTO_BATCH_SIZE;
+
+        net_crypto_modular_pow_batch( job->key, src_buffer + i, out, count );
+
+        for ( size_t j = 0; j < count; j++ )
+            net_crypto_unpack_block( out[ j ], job->dst + ( i + j ) * job->block_bytes, job->block_bytes );
+    }
+}
+
+/**
+ * Packed ranges start on a multiple of 8 blocks, so each range begin on a byte
+ * boundary and never share a byte with its neighbours.
+ **/
+void net_crypto_encrypt_packed_range( void* user, const size_t begin, const size_t end ) {
+    const net_crypto_job_t* job = (const net_crypto_job_t*)user;
+    net_crypto_bits_t bits = { job->dst + ( begin * job->block_bits ) / 8, 0, 0, 0 };
+    uint64_t in[ NET_CRYPTO_BATCH_SIZE ];
+    uint64_t out[ NET_CRYPTO_BATCH_SIZE ];
+
+    for ( size_t i = begin; i < end; i += NET_CRYPTO_BATCH_SIZE ) {
+        const size_t count = ( end - i < NET_CRYPTO_BATCH_SIZE ) ? end - i : NET_CRYPTO_BATCH_SIZE;
+
+        for ( size_t j = 0; j < count; j++ )
+            in[ j ] = net_crypto_job_pack( job, i + j );
+
+        net_crypto_modular_pow_batch( job->key, in, out, count );
+
+        for ( size_t j = 0; j < count; j++ )
+            net_crypto_bits_write( &bits, out[ j ], job->block_bits );
+    }
+
+    net_crypto_bits_flush( &bits );
+}
+
+void net_crypto_decrypt_packed_range( void* user, const size_t begin, const size_t end ) {
+    const net_crypto_job_t* job = (const net_crypto_job_t*)user;
+    net_crypto_bits_t bits = { (uint8_t*)job->src + ( begin * job->block_bits ) / 8, 0, 0, 0 };
+    uint64_t in[ NET_CRYPTO_BATCH_SIZE ];
+    uint64_t out[ NET_CRYPTO_BATCH_SIZE ];
+
+    for ( size_t i = begin; i < end; i += NET_CRYPTO_BATCH_SIZE ) {
+        const size_t count = ( end - i < NET_CRYPTO_BATCH_SIZE ) ? end - i : NET_CRYPTO_BATCH_SIZE;
+
+        for ( size_t j = 0; j < count; j++ )
+            in[ j ] = net_crypto_bits_read( &bits, job->block_bits );
+
+        net_crypto_modular_pow_batch( job->key, in, out, count );
+
+        for ( size_t j = 0; j < count; j++ )
+            net_crypto_unpack_block( out[ j ], job->dst + ( i + j ) * job->block_bytes, job->block_bytes );
+    }
+}
+
+size_t net_crypto_encrypt_raw(
+    const net_crypto_key_t* key,
+    const uint8_t* restrict src,
+    const size_t size,
+    uint8_t* restrict dst
+) {
+    const size_t block_bytes = net_crypto_get_block_bytes( key->modulus );
+    const size_t block_count = ( size + block_bytes - 1 ) / block_bytes;
+
+    net_crypto_job_t job = { key, src, size, dst, block_bytes, 0 };
+
+    net_crypto_parallel_for( net_crypto_encrypt_range, &job, block_count );
+
+    return block_count * sizeof(uint64_t);
+}
+
+size_t net_crypto_decrypt_raw(
+    const net_crypto_key_t* key,
+    const uint8_t* restrict src,
+    const size_t size,
+    uint8_t* restrict dst
+) {
+    const size_t block_bytes = net_crypto_get_block_bytes( key->modulus );
+    const size_t block_count = size / sizeof(uint64_t);
+
+    net_crypto_job_t job = { key, src, size, dst, block_bytes, 0 };
+
+    net_crypto_parallel_for( net_crypto_decrypt_range, &job, block_count );
+
+    return block_count * block_bytes;
+}
+
+size_t net_crypto_encrypt_packed_raw(
+    const net_crypto_key_t* key,
+    const uint8_t* restrict src,
+    const size_t size,
+    uint8_t* restrict dst
+) {
+    const size_t block_bytes = net_crypto_get_block_bytes( key->modulus );
+    const size_t block_bits  = net_crypto_get_block_bits( key->modulus );
+    const size_t block_count = ( size + block_bytes - 1 ) / block_bytes;
+
+    net_crypto_job_t job = { key, src, size, dst, block_bytes, block_bits };
+
+    net_crypto_parallel_for( net_crypto_encrypt_packed_range, &job, block_count );
+
+    return ( block_count * block_bits + 7 ) / 8;
+}
+
+size_t net_crypto_decrypt_packed_raw(
+    const net_crypto_key_t* key,
+    const uint8_t* restrict src,
+    const size_t size,
+    uint8_t* restrict dst
+) {
+    const size_t block_bytes = net_crypto_get_block_bytes( key->modulus );
+    const size_t block_bits  = net_crypto_get_block_bits( key->modulus );
+    const size_t block_count = ( size * 8 ) / block_bits;
+
+    net_crypto_job_t job = { key, src, size, dst, block_bytes, block_bits };
+
+    net_crypto_parallel_for( net_crypto_decrypt_packed_range, &job, block_count );
+
+    return block_count * block_bytes;
+}
+
+enet_booleans net_crypto_encrypt(
+    const net_crypto_key_t* key,
+    const net_buffer_t* restrict src,
+    net_buffer_t* restrict dst
+) {
+    assert( net_crypto_is_key_valid( key ) == enet_true );
+    assert( net_buffer_is_valid( src ) == enet_true );
+    assert( src->size > 0 );
+
+    const size_t block_bytes = net_crypto_get_block_bytes( key->modulus );
+    const size_t block_count = ( src->size + block_bytes - 1 ) / block_bytes;
+    const size_t out_size = block_count * sizeof(uint64_t);
+
+    if ( net_buffer_create( dst, out_size ) == enet_false )
+        return enet_false;
+
+    net_buffer_resize( dst, out_size );
+    net_crypto_encrypt_raw( key, net_buffer_get_raw( src ), src->size, net_buffer_get_raw( dst ) );
+
+    return enet_true;
+}
+
+enet_booleans net_crypto_decrypt(
+    const net_crypto_key_t* key,
+    const net_buffer_t* restrict src,
+    net_buffer_t* restrict dst
+) {
+    assert( net_crypto_is_key_valid( key ) == enet_true );
+    assert( net_buffer_is_valid( src ) == enet_true );
+    assert( src->size > 0 );
+
+    const size_t block_bytes = net_crypto_get_block_bytes( key->modulus );
+    const size_t out_size = block_bytes * ( src->size / sizeof(uint64_t) );
+
+    if ( net_buffer_create( dst, out_size ) == enet_false )
+        return enet_false;
+
+    net_buffer_resize( dst, out_size );
+    net_crypto_decrypt_raw( key, net_buffer_get_raw( src ), src->size, net_buffer_get_raw( dst ) );
+
+    return enet_true;
+}
+
+enet_booleans net_crypto_encrypt_packed(
+    const net_crypto_key_t* key,
+    const net_buffer_t* restrict src,
+    net_buffer_t* restrict dst
+) {
+    assert( net_crypto_is_key_valid( key ) == enet_true );
+    assert( net_buffer_is_valid( src ) == enet_true );
+    assert( src->size > 0 );
+
+    const size_t block_bytes = net_crypto_get_block_bytes( key->modulus );
+    const size_t block_bits  = net_crypto_get_block_bits( key->modulus );
+    const size_t block_count = ( src->size + block_bytes - 1 ) / block_bytes;
+    const size_t out_size = ( block_count * block_bits + 7 ) / 8;
+
+    if ( net_buffer_create( dst, out_size ) == enet_false )
+        return enet_false;
+
+    net_buffer_resize( dst, out_size );
+    net_crypto_encrypt_packed_raw( key, net_buffer_get_raw( src ), src->size, net_buffer_get_raw( dst ) );
+
+    return enet_true;
+}
+
+enet_booleans net_crypto_decrypt_packed(
+    const net_crypto_key_t* key,
+    const net_buffer_t* restrict src,
+    net_buffer_t* restrict dst
+) {
+    assert( net_crypto_is_key_valid( key ) == enet_true );
+    assert( net_buffer_is_valid( src ) == enet_true );
+    assert( src->size > 0 );
+
+    const size_t block_bytes = net_crypto_get_block_bytes( key->modulus );
+    const size_t block_bits  = net_crypto_get_block_bits( key->modulus );
+    const size_t block_count = ( (size_t)src->size * 8 ) / block_bits;
+    const size_t out_size = block_bytes * block_count;
+
+    if ( block_count == 0 || net_buffer_create( dst, out_size ) == enet_false )
+        return enet_false;
+
+    net_buffer_resize( dst, out_size );
+    net_crypto_decrypt_packed_raw( key, net_buffer_get_raw( src ), src->size, net_buffer_get_raw( dst ) );
+
+    return enet_true;
+}
+
+enet_booleans net_crypto_is_key_valid( const net_crypto_key_t* key ) {
+    assert( key != NULL );
+
+    if ( key->exponent == 0 || key->modulus == 0 )
+        return enet_false;
+
+    return enet_true;
+}
+
+void net_crypto_random_bytes( uint8_t* out, const size_t length ) {
+    assert( out != NULL );
+
+    size_t readed = 0;
+    const int descriptor = open( "/dev/urandom", O_RDONLY );
+
+    if ( descriptor >= 0 ) {
+        while ( readed < length ) {
+            const ssize_t state = read( descriptor, out + readed, length - readed );
+
+            if ( state > 0 )
+                readed += (size_t)state;
+            else if ( state < 0 && errno == EINTR )
+                continue;
+            else
+                break;
+        }
+
+        close( descriptor );
+    }
+
+    while ( readed < length )
+        out[ readed++ ] = (uint8_t)( rand( ) & 0xFF );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CRYPTO ( CHACHA20 )
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#define NET_CHACHA20_ROTL( value, count ) ( ( (value) << (count) ) | ( (value) >> ( 32 - (count) ) ) )
+
+#define NET_CHACHA20_QUARTER( a, b, c, d )\
+    a += b; d ^= a; d = NET_CHACHA20_ROTL( d, 16 );\
+    c += d; b ^= c; b = NET_CHACHA20_ROTL( b, 12 );\
+    a += b; d ^= a; d = NET_CHACHA20_ROTL( d, 8 );\
+    c += d; b ^= c; b = NET_CHACHA20_ROTL( b, 7 )
+
+typedef void (*net_chacha20_blocks_t)( uint32_t* state, uint8_t* out, const uint32_t count );
+
+uint32_t net_chacha20_load32( const uint8_t* data ) {
+    return (uint32_t)data[ 0 ]         | (uint32_t)data[ 1 ] << 8 |
+           (uint32_t)data[ 2 ] << 16   | (uint32_t)data[ 3 ] << 24;
+}
+
+void net_chacha20_store32( uint8_t* data, const uint32_t value ) {
+    data[ 0 ] = (uint8_t)( value );
+    data[ 1 ] = (uint8_t)( value >> 8 );
+    data[ 2 ] = (uint8_t)( value >> 16 );
+    data[ 3 ] = (uint8_t)( value >> 24 );
+}
+
+void net_chacha20_blocks_scalar( uint32_t* state, uint8_t* out, const uint32_t count ) {
+    for ( uint32_t block = 0; block < count; block++ ) {
+        uint32_t x[ 16 ];
+
+        memmove( x, state, sizeof( x ) );
+
+        for ( uint32_t round = 0; round < 10; round++ ) {
+            NET_CHACHA20_QUARTER( x[ 0 ], x[ 4 ], x[  8 ], x[ 12 ] );
+            NET_CHACHA20_QUARTER( x[ 1 ], x[ 5 ], x[  9 ], x[ 13 ] );
+            NET_CHACHA20_QUARTER( x[ 2 ], x[ 6 ], x[ 10 ], x[ 14 ] );
+            NET_CHACHA20_QUARTER( x[ 3 ], x[ 7 ], x[ 11 ], x[ 15 ] );
+            NET_CHACHA20_QUARTER( x[ 0 ], x[ 5 ], x[ 10 ], x[ 15 ] );
+            NET_CHACHA20_QUARTER( x[ 1 ], x[ 6 ], x[ 11 ], x[ 12 ] );
+            NET_CHACHA20_QUARTER( x[ 2 ], x[ 7 ], x[  8 ], x[ 13 ] );
+            NET_CHACHA20_QUARTER( x[ 3 ], x[ 4 ], x[  9 ], x[ 14 ] );
+        }
+
+        for ( uint32_t i = 0; i < 16; i++ )
+            net_chacha20_store32( out + 4 * i, x[ i ] + state[ i ] );
+
+        state[ 12 ] += 1;
+        out += NET_CHACHA20_BLOCK_SIZE;
+    }
+}
+
+#ifdef NET_ARCH_X86
+#define NET_CHACHA20_SSE_ROTL( value, count )\
+    _mm_or_si128( _mm_slli_epi32( value, count ), _mm_srli_epi32( value, 32 - (count) ) )
+
+#define NET_CHACHA20_SSE_QUARTER( a, b, c, d )\
+    a = _mm_add_epi32( a, b ); d = _mm_xor_si128( d, a ); d = NET_CHACHA20_SSE_ROTL( d, 16 );\
+    c = _mm_add_epi32( c, d ); b = _mm_xor_si128( b, c ); b = NET_CHACHA20_SSE_ROTL( b, 12 );\
+    a = _mm_add_epi32( a, b ); d = _mm_xor_si128( d, a ); d = NET_CHACHA20_SSE_ROTL( d, 8 );\
+    c = _mm_add_epi32( c, d ); b = _mm_xor_si128( b, c ); b = NET_CHACHA20_SSE_ROTL( b, 7 )
+
+/**
+ * Four blocks per pass, lane i of x[ w ] hold word w of block i. Rows are
+ * transposed back to block order before the store.
+ **/
+__attribute__(( target( "sse2" ) ))
+void net_chacha20_blocks_sse2( uint32_t* state, uint8_t* out, const uint32_t count ) {
+    uint32_t block = 0;
+
+    for ( ; block + 4 <= count; block += 4 ) {
+        __m128i origin[ 16 ];
+        __m128i x[ 16 ];
+
+        for ( uint32_t i = 0; i < 16; i++ )
+            origin[ i ] = _mm_set1_epi32( (int)state[ i ] );
+
+        origin[ 12 ] = _mm_add_epi32( origin[ 12 ], _mm_set_epi32( 3, 2, 1, 0 ) );
+
+        memmove( x, origin, sizeof( x ) );
+
+        for ( uint32_t round = 0; round < 10; round++ ) {
+            NET_CHACHA20_SSE_QUARTER( x[ 0 ], x[ 4 ], x[  8 ], x[ 12 ] );
+            NET_CHACHA20_SSE_QUARTER( x[ 1 ], x[ 5 ], x[  9 ], x[ 13 ] );
+            NET_CHACHA20_SSE_QUARTER( x[ 2 ], x[ 6 ], x[ 10 ], x[ 14 ] );
+            NET_CHACHA20_SSE_QUARTER( x[ 3 ], x[ 7 ], x[ 11 ], x[ 15 ] );
+            NET_CHACHA20_SSE_QUARTER( x[ 0 ], x[ 5 ], x[ 10 ], x[ 15 ] );
+            NET_CHACHA20_SSE_QUARTER( x[ 1 ], x[ 6 ], x[ 11 ], x[ 12 ] );
+            NET_CHACHA20_SSE_QUARTER( x[ 2 ], x[ 7 ], x[  8 ], x[ 13 ] );
+            NET_CHACHA20_SSE_QUARTER( x[ 3 ], x[ 4 ], x[  9 ], x[ 14 ] );
+        }
+
+        for ( uint32_t i = 0; i < 16; i++ )
+            x[ i ] = _mm_add_epi32( x[ i ], origin[ i ] );
+
+        for ( uint32_t row = 0; row < 16; row += 4 ) {
+            const __m128i t0 = _mm_unpacklo_epi32( x[ row + 0 ], x[ row + 1 ] );
+            const __m128i t1 = _mm_unpacklo_epi32( x[ row + 2 ], x[ row + 3 ] );
+            const __m128i t2 = _mm_unpackhi_epi32( x[ row + 0 ], x[ row + 1 ] );
+            const __m128i t3 = _mm_unpackhi_epi32( x[ row + 2 ], x[ row + 3 ] );
+
+            _mm_storeu_si128( (__m128i*)( out + 0 * NET_CHACHA20_BLOCK_SIZE + 4 * row ), _mm_unpacklo_epi64( t0, t1 ) );
+            _mm_storeu_si128( (__m128i*)( out + 1 * NET_CHACHA20_BLOCK_SIZE + 4 * row ), _mm_unpackhi_epi64( t0, t1 ) );
+            _mm_storeu_si128( (__m128i*)( out + 2 * NET_CHACHA20_BLOCK_SIZE + 4 * row ), _mm_unpacklo_epi64( t2, t3 ) );
+            _mm_storeu_si128( (__m128i*)( out + 3 * NET_CHACHA20_BLOCK_SIZE + 4 * row ), _mm_unpackhi_epi64( t2, t3 ) );
+        }
+
+        state[ 12 ] += 4;
+        out += 4 * NET_CHACHA20_BLOCK_SIZE;
+    }
+
+    net_chacha20_blocks_scalar( state, out, count - block );
+}
+
+#define NET_CHACHA20_AVX2_ROTL( value, count )\
+    _mm256_or_si256( _mm256_slli_epi32( value, count ), _mm256_srli_epi32( value, 32 - (count) ) )
+
+#define NET_CHACHA20_AVX2_QUARTER( a, b, c, d )\
+    a = _mm256_add_epi32( a, b ); d = _mm256_xor_si256( d, a ); d = NET_CHACHA20_AVX2_ROTL( d, 16 );\
+    c = _mm256_add_epi32( c, d ); b = _mm256_xor_si256( b, c ); b = NET_CHACHA20_AVX2_ROTL( b, 12 );\
+    a = _mm256_add_epi32( a, b ); d = _mm256_xor_si256( d, a ); d = NET_CHACHA20_AVX2_ROTL( d, 8 );\
+    c = _mm256_add_epi32( c, d ); b = _mm256_xor_si256( b, c ); b = NET_CHACHA20_AVX2_ROTL( b, 7 )
+
+/**
+ * Eight blocks per pass. The unpacks work inside each 128 bits lane, so the
+ * low half of a transposed row belong to block i and the high half to i + 4.
+ **/
+__attribute__(( target( "avx2" ) ))
+void net_chacha20_blocks_avx2( uint32_t* state, uint8_t* out, const uint32_t count ) {
+    uint32_t block = 0;
+
+    for ( ; block + 8 <= count; block += 8 ) {
+        __m256i origin[ 16 ];
+        __m256i x[ 16 ];
+
+        for ( uint32_t i = 0; i < 16; i++ )
+            origin[ i ] = _mm256_set1_epi32( (int)state[ i ] );
+
+        origin[ 12 ] = _mm256_add_epi32( origin[ 12 ], _mm256_set_epi32( 7, 6, 5, 4, 3, 2, 1, 0 ) );
+
+        memmove( x, origin, sizeof( x ) );
+
+        for ( uint32_t round = 0; round < 10; round++ ) {
+            NET_CHACHA20_AVX2_QUARTER( x[ 0 ], x[ 4 ], x[  8 ], x[ 12 ] );
+            NET_CHACHA20_AVX2_QUARTER( x[ 1 ], x[ 5 ], x[  9 ], x[ 13 ] );
+            NET_CHACHA20_AVX2_QUARTER( x[ 2 ], x[ 6 ], x[ 10 ], x[ 14 ] );
+            NET_CHACHA20_AVX2_QUARTER( x[ 3 ], x[ 7 ], x[ 11 ], x[ 15 ] );
+            NET_CHACHA20_AVX2_QUARTER( x[ 0 ], x[ 5 ], x[ 10 ], x[ 15 ] );
+            NET_CHACHA20_AVX2_QUARTER( x[ 1 ], x[ 6 ], x[ 11 ], x[ 12 ] );
+            NET_CHACHA20_AVX2_QUARTER( x[ 2 ], x[ 7 ], x[  8 ], x[ 13 ] );
+            NET_CHACHA20_AVX2_QUARTER( x[ 3 ], x[ 4 ], x[  9 ], x[ 14 ] );
+        }
+
+        for ( uint32_t i = 0; i < 16; i++ )
+            x[ i ] = _mm256_add_epi32( x[ i ], origin[ i ] );
+
+        for ( uint32_t row = 0; row < 16; row += 4 ) {
+            const __m256i t0 = _mm256_unpacklo_epi32( x[ row + 0 ], x[ row + 1 ] );
+            const __m256i t1 = _mm256_unpacklo_epi32( x[ row + 2 ], x[ row + 3 ] );
+            const __m256i t2 = _mm256_unpackhi_epi32( x[ row + 0 ], x[ row + 1 ] );
+            const __m256i t3 = _mm256_unpackhi_epi32( x[ row + 2 ], x[ row + 3 ] );
+            const __m256i rows[ 4 ] = {
+                _mm256_unpacklo_epi64( t0, t1 ), _mm256_unpackhi_epi64( t0, t1 ),
+                _mm256_unpacklo_epi64( t2, t3 ), _mm256_unpackhi_epi64( t2, t3 )
+            };
+
+            for ( uint32_t i = 0; i < 4; i++ ) {
+                uint8_t* low  = out + i * NET_CHACHA20_BLOCK_SIZE + 4 * row;
+                uint8_t* high = out + ( i + 4 ) * NET_CHACHA20_BLOCK_SIZE + 4 * row;
+
+                _mm_storeu_si128( (__m128i*)low, _mm256_castsi256_si128( rows[ i ] ) );
+                _mm_storeu_si128( (__m128i*)high, _mm256_extracti128_si256( rows[ i ], 1 ) );
+            }
+        }
+
+        state[ 12 ] += 8;
+        out += 8 * NET_CHACHA20_BLOCK_SIZE;
+    }
+
+    net_chacha20_blocks_sse2( state, out, count - block );
+}
+#endif
+
+net_chacha20_blocks_t net_chacha20_get_blocks( ) {
+    static net_chacha20_blocks_t blocks = NULL;
+
+    if ( blocks != NULL )
+        return blocks;
+
+#ifdef NET_ARCH_X86
+    __builtin_cpu_init( );
+
+    if ( __builtin_cpu_supports( "avx2" ) )
+        blocks = net_chacha20_blocks_avx2;
+    else if ( __builtin_cpu_supports( "sse2" ) )
+        blocks = net_chacha20_blocks_sse2;
+    else
+#endif
+        blocks = net_chacha20_blocks_scalar;
+
+    return blocks;
+}
+
+void net_chacha20_init(
+    net_chacha20_t* chacha,
+    const uint8_t key[ NET_CHACHA20_KEY_SIZE ],
+    const uint8_t nonce[ NET_CHACHA20_NONCE_SIZE ],
+    const uint32_t counter
+) {
+    assert( chacha != NULL );
+    assert( key != NULL );
+    assert( nonce != NULL );
+
+    chacha->state[ 0 ] = 0x61707865;
+    chacha->state[ 1 ] = 0x3320646e;
+    chacha->state[ 2 ] = 0x79622d32;
+    chacha->state[ 3 ] = 0x6b206574;
+
+    for ( uint32_t i = 0; i < 8; i++ )
+        chacha->state[ 4 + i ] = net_chacha20_load32( key + 4 * i );
+
+    chacha->state[ 12 ] = counter;
+
+    for ( uint32_t i = 0; i < 3; i++ )
+        chacha->state[ 13 + i ] = net_chacha20_load32( nonce + 4 * i );
+
+    chacha->keystream_offset = NET_CHACHA20_BLOCK_SIZE;
+}
+
+void net_chacha20_xor(
+    net_chacha20_t* chacha,
+    const uint8_t* src,
+    uint8_t* dst,
+    const size_t length
+) {
+    assert( chacha != NULL );
+    assert( length == 0 || ( src != NULL && dst != NULL ) );
+
+    const net_chacha20_blocks_t blocks = net_chacha20_get_blocks( );
+    uint8_t keystream[ 8 * NET_CHACHA20_BLOCK_SIZE ];
+    size_t offset = 0;
+
+    while ( offset < length && chacha->keystream_offset < NET_CHACHA20_BLOCK_SIZE ) {
+        dst[ offset ] = src[ offset ] ^ chacha->keystream[ chacha->keystream_offset++ ];
+        offset += 1;
+    }
+
+    while ( length - offset >= NET_CHACHA20_BLOCK_SIZE ) {
+        uint32_t count = (uint32_t)( ( length - offset ) / NET_CHACHA20_BLOCK_SIZE );
+
+        if ( count > 8 )
+            count = 8;
+
+        const size_t size = (size_t)count * NET_CHACHA20_BLOCK_SIZE;
+
+        blocks( chacha->state, keystream, count );
+
+        for ( size_t i = 0; i < size; i += sizeof( uint64_t ) ) {
+            uint64_t word;
+            uint64_t stream;
+
+            memmove( &word, src + offset + i, sizeof( uint64_t ) );
+            memmove( &stream, keystream + i, sizeof( uint64_t ) );
+
+            word ^= stream;
+
+            memmove( dst + offset + i, &word, sizeof( uint64_t ) );
+        }
+
+        offset += size;
+    }
+
+    if ( offset < length ) {
+        blocks( chacha->state, chacha->keystream, 1 );
+
+        chacha->keystream_offset = 0;
+
+        while ( offset < length ) {
+            dst[ offset ] = src[ offset ] ^ chacha->keystream[ chacha->keystream_offset++ ];
+            offset += 1;
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CRYPTO ( SESSION )
+/////////////////////////////////////////////////////////////////////////////////////////////////
+void net_crypto_session_init( net_crypto_session_t* session ) {
+    assert( session != NULL );
+
+    memset( session, 0x00, sizeof( net_crypto_session_t ) );
+
+    session->mode = enet_crypto_rsa;
+}
+
+enet_crypto_modes net_crypto_session_select( const uint32_t local_modes, const uint32_t remote_modes ) {
+    const uint32_t modes = local_modes & remote_modes;
+
+    if ( modes & enet_crypto_chacha20 )
+        return enet_crypto_chacha20;
+    else if ( modes & enet_crypto_rsa_packed )
+        return enet_crypto_rsa_packed;
+
+    return enet_crypto_rsa;
+}
+
+void net_crypto_session_start_stream(
+    net_crypto_session_t* session,
+    const uint8_t secret[ NET_CRYPTO_SECRET_SIZE ],
+    const enet_booleans is_server
+) {
+    assert( session != NULL );
+    assert( secret != NULL );
+
+    const uint8_t* key = secret;
+    const uint8_t* client_nonce = secret + NET_CHACHA20_KEY_SIZE;
+    const uint8_t* server_nonce = client_nonce + NET_CHACHA20_NONCE_SIZE;
+
+    session->mode = enet_crypto_chacha20;
+
+    if ( is_server == enet_true ) {
+        net_chacha20_init( &session->encrypt_stream, key, server_nonce, 0 );
+        net_chacha20_init( &session->decrypt_stream, key, client_nonce, 0 );
+    } else {
+        net_chacha20_init( &session->encrypt_stream, key, client_nonce, 0 );
+        net_chacha20_init( &session->decrypt_stream, key, server_nonce, 0 );
+    }
+}
+
+const char* net_crypto_session_get_name( const net_crypto_session_t* session ) {
+    assert( session != NULL );
+
+    switch ( session->mode ) {
+        case enet_crypto_chacha20   : return "ChaCha20";
+        case enet_crypto_rsa_packed : return "RSA-TOY ( packed )";
+
+        default : break;
+    }
+
+    return "RSA-TOY";
+}
+
+size_t net_crypto_session_get_cypher_size( const net_crypto_session_t* session, const size_t plain_size ) {
+    assert( session != NULL );
+
+    if ( session->mode == enet_crypto_chacha20 )
+        return plain_size;
+
+    const size_t block_bytes = net_crypto_get_block_bytes( session->encrypt_key.modulus );
+    const size_t block_count = ( plain_size + block_bytes - 1 ) / block_bytes;
+
+    if ( session->mode == enet_crypto_rsa_packed )
+        return ( block_count * net_crypto_get_block_bits( session->encrypt_key.modulus ) + 7 ) / 8;
+
+    return block_count * sizeof(uint64_t);
+}
+
+size_t net_crypto_session_get_plain_size( const net_crypto_session_t* session, const size_t cypher_size ) {
+    assert( session != NULL );
+
+    if ( session->mode == enet_crypto_chacha20 )
+        return cypher_size;
+
+    const size_t block_bytes = net_crypto_get_block_bytes( session->decrypt_key.modulus );
+
+    if ( session->mode == enet_crypto_rsa_packed )
+        return block_bytes * ( ( cypher_size * 8 ) / net_crypto_get_block_bits( session->decrypt_key.modulus ) );
+
+    return block_bytes * ( cypher_size / sizeof(uint64_t) );
+}
+
+void net_crypto_session_get_window(
+    const net_crypto_session_t* session,
+    const net_crypto_key_t* key,
+    const size_t window_size,
+    size_t* plain_window,
+    size_t* cypher_window
+) {
+    size_t plain_step  = 1;
+    size_t cypher_step = 1;
+
+    if ( session->mode == enet_crypto_rsa ) {
+        plain_step  = net_crypto_get_block_bytes( key->modulus );
+        cypher_step = sizeof(uint64_t);
+    } else if ( session->mode == enet_crypto_rsa_packed ) {
+        // 8 packed blocks always end on a byte boundary.
+        plain_step  = 8 * net_crypto_get_block_bytes( key->modulus );
+        cypher_step = net_crypto_get_block_bits( key->modulus );
+    }
+
+    const size_t step_count = window_size / cypher_step;
+
+    assert( step_count > 0 );
+
+    *plain_window  = step_count * plain_step;
+    *cypher_window = step_count * cypher_step;
+}
+
+void net_crypto_session_get_encrypt_window(
+    const net_crypto_session_t* session,
+    const size_t window_size,
+    size_t* plain_window,
+    size_t* cypher_window
+) {
+    assert( session != NULL );
+
+    net_crypto_session_get_window( session, &session->encrypt_key, window_size, plain_window, cypher_window );
+}
+
+void net_crypto_session_get_decrypt_window(
+    const net_crypto_session_t* session,
+    const size_t window_size,
+    size_t* plain_window,
+    size_t* cypher_window
+) {
+    assert( session != NULL );
+
+    net_crypto_session_get_window( session, &session->decrypt_key, window_size, plain_window, cypher_window );
+}
+
+size_t net_crypto_session_encrypt_raw(
+    net_crypto_session_t* session,
+    const uint8_t* restrict src,
+    const size_t size,
+    uint8_t* restrict dst
+) {
+    assert( session != NULL );
+
+    if ( session->mode == enet_crypto_chacha20 ) {
+        net_chacha20_xor( &session->encrypt_stream, src, dst, size );
+
+        return size;
+    } else if ( session->mode == enet_crypto_rsa_packed )
+        return net_crypto_encrypt_packed_raw( &session->encrypt_key, src, size, dst );
+
+    return net_crypto_encrypt_raw( &session->encrypt_key, src, size, dst );
+}
+
+size_t net_crypto_session_decrypt_raw(
+    net_crypto_session_t* session,
+    const uint8_t* restrict src,
+    const size_t size,
+    uint8_t* restrict dst
+) {
+    assert( session != NULL );
+
+    if ( session->mode == enet_crypto_chacha20 ) {
+        net_chacha20_xor( &session->decrypt_stream, src, dst, size );
+
+        return size;
+    } else if ( session->mode == enet_crypto_rsa_packed )
+        return net_crypto_decrypt_packed_raw( &session->decrypt_key, src, size, dst );
+
+    return net_crypto_decrypt_raw( &session->decrypt_key, src, size, dst );
+}
+
+enet_booleans net_crypto_session_encrypt(
+    net_crypto_session_t* session,
+    const net_buffer_t* restrict src,
+    net_buffer_t* restrict dst
+) {
+    assert( net_buffer_is_valid( src ) == enet_true );
+    assert( src->size > 0 );
+
+    const size_t out_size = net_crypto_session_get_cypher_size( session, src->size );
+
+    if ( net_buffer_create( dst, out_size ) == enet_false )
+        return enet_false;
+
+    net_buffer_resize( dst, out_size );
+    net_crypto_session_encrypt_raw( session, net_buffer_get_raw( src ), src->size, net_buffer_get_raw( dst ) );
+
+    return enet_true;
+}
+
+enet_booleans net_crypto_session_decrypt(
+    net_crypto_session_t* session,
+    const net_buffer_t* restrict src,
+    net_buffer_t* restrict dst
+) {
+    assert( net_buffer_is_valid( src ) == enet_true );
+    assert( src->size > 0 );
+
+    const size_t out_size = net_crypto_session_get_plain_size( session, src->size );
+
+    if ( out_size == 0 || net_buffer_create( dst, out_size ) == enet_false )
+        return enet_false;
+
+    net_buffer_resize( dst, out_size );
+    net_crypto_session_decrypt_raw( session, net_buffer_get_raw( src ), src->size, net_buffer_get_raw( dst ) );
+
+    return enet_true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CRYPTO ( KEY POOL )
+/////////////////////////////////////////////////////////////////////////////////////////////////
+void net_crypto_key_pool_push( net_crypto_key_pool_t* key_pool, const net_crypto_key_pair_t* pair ) {
+    if ( key_pool->count < key_pool->capacity )
+        key_pool->pair_list[ key_pool->count++ ] = *pair;
+}
+
+void* net_crypto_key_pool_loop( void* argument ) {
+    net_crypto_key_pool_t* key_pool = (net_crypto_key_pool_t*)argument;
+
+    while ( enet_true ) {
+        pthread_mutex_lock( &key_pool->mutex );
+
+        while ( 
+            key_pool->is_running == enet_true && 
+            key_pool->request_head == NULL && 
+            key_pool->count == key_pool->capacity 
+        )
+            pthread_cond_wait( &key_pool->condition, &key_pool->mutex );
+
+        if ( key_pool->is_running == enet_false ) {
+            pthread_mutex_unlock( &key_pool->mutex );
+            break;
+        }
+
+        // Waiting handshakes go first, the pool is refilled when none is queued.
+        net_crypto_key_request_t* request = key_pool->request_head;
+
+        if ( request != NULL ) {
+            key_pool->request_head = request->next;
+
+            if ( key_pool->request_head == NULL )
+                key_pool->request_tail = NULL;
+
+            request->next   = NULL;
+            request->status = enet_crypto_key_request_generating;
+        }
+
+        pthread_mutex_unlock( &key_pool->mutex );
+
+        net_crypto_key_pair_t pair;
+        const enet_booleans is_generated = net_crypto_generate_keys( &pair.public, &pair.private );
+
+        pthread_mutex_lock( &key_pool->mutex );
+
+        if ( request != NULL && request->status == enet_crypto_key_request_generating ) {
+            if ( is_generated == enet_true ) {
+                request->pair   = pair;
+                request->status = enet_crypto_key_request_ready;
+            } else 
+                request->status = enet_crypto_key_request_idle;
+
+            pthread_cond_broadcast( &key_pool->ready );
+        } else {
+            // A cancelled request is idle again even when its pair failed, or the
+            // next request on it would claim back a pair nobody generates.
+            if ( request != NULL )
+                request->status = enet_crypto_key_request_idle;
+
+            if ( is_generated == enet_true )
+                net_crypto_key_pool_push( key_pool, &pair );
+        }
+
+        pthread_mutex_unlock( &key_pool->mutex );
+    }
+
+    return NULL;
+}
+
+void net_crypto_key_pool_release( net_crypto_key_pool_t* key_pool ) {
+    pthread_cond_destroy( &key_pool->ready );
+    pthread_cond_destroy( &key_pool->condition );
+    pthread_mutex_destroy( &key_pool->mutex );
+    free( key_pool->thread_list );
+    free( key_pool->pair_list );
+
+    memset( key_pool, 0x00, sizeof( net_crypto_key_pool_t ) );
+}
+
+enet_booleans net_crypto_key_pool_create(
+    net_crypto_key_pool_t* key_pool,
+    const uint32_t capacity,
+    const uint32_t thread_count
+) {
+    assert( key_pool != NULL );
+    assert( capacity > 0 );
+    assert( thread_count > 0 );
+
+    memset( key_pool, 0x00, sizeof( net_crypto_key_pool_t ) );
+
+    key_pool->pair_list   = (net_crypto_key_pair_t*)malloc( capacity * sizeof( net_crypto_key_pair_t ) );
+    key_pool->thread_list = (pthread_t*)malloc( thread_count * sizeof( pthread_t ) );
+
+    if ( key_pool->pair_list == NULL || key_pool->thread_list == NULL ) {
+        net_print_error( "Can't allocate %u key pairs for key pool %p", capacity, key_pool );
+        free( key_pool->thread_list );
+        free( key_pool->pair_list );
+
+        return enet_false;
+    }
+
+    key_pool->capacity   = capacity;
+    key_pool->is_running = enet_true;
+
+    if ( pthread_mutex_init( &key_pool->mutex, NULL ) != 0 ) {
+        net_print_error( "Can't create mutex for key pool %p", key_pool );
+        free( key_pool->thread_list );
+        free( key_pool->pair_list );
+
+        return enet_false;
+    }
+
+    if ( pthread_cond_init( &key_pool->condition, NULL ) != 0 ) {
+        net_print_error( "Can't create condition for key pool %p", key_pool );
+        pthread_mutex_destroy( &key_pool->mutex );
+        free( key_pool->thread_list );
+        free( key_pool->pair_list );
+
+        return enet_false;
+    }
+
+    if ( pthread_cond_init( &key_pool->ready, NULL ) != 0 ) {
+        net_print_error( "Can't create condition for key pool %p", key_pool );
+        pthread_cond_destroy( &key_pool->condition );
+        pthread_mutex_destroy( &key_pool->mutex );
+        free( key_pool->thread_list );
+        free( key_pool->pair_list );
+
+        return enet_false;
+    }
+
+    while ( key_pool->thread_count < thread_count ) {
+        if ( pthread_create( key_pool->thread_list + key_pool->thread_count, NULL, net_crypto_key_pool_loop, key_pool ) != 0 ) {
+            net_print_error( "Can't create thread for key pool %p", key_pool );
+            net_crypto_key_pool_destroy( key_pool );
+
+            return enet_false;
+        }
+
+        key_pool->thread_count += 1;
+    }
+
+    return enet_true;
+}
+
+enet_booleans net_crypto_key_pool_pop(
+    net_crypto_key_pool_t* key_pool,
+    net_crypto_key_t* restrict public,
+    net_crypto_key_t* restrict private
+) {
+    assert( key_pool != NULL );
+
+    pthread_mutex_lock( &key_pool->mutex );
+
+    if ( key_pool->count > 0 ) {
+        const net_crypto_key_pair_t* pair = key_pool->pair_list + --key_pool->count;
+
+        (*public)  = pair->public;
+        (*private) = pair->private;
+
+        pthread_cond_signal( &key_pool->condition );
+        pthread_mutex_unlock( &key_pool->mutex );
+
+        return enet_true;
+    }
+
+    pthread_mutex_unlock( &key_pool->mutex );
+
+    return net_crypto_generate_keys( public, private );
+}
+
+void net_crypto_key_pool_request( net_crypto_key_pool_t* key_pool, net_crypto_key_request_t* request ) {
+    assert( key_pool != NULL );
+    assert( request != NULL );
+
+    pthread_mutex_lock( &key_pool->mutex );
+
+    // A cancelled pair still being generated is simply claimed back.
+    if ( request->status == enet_crypto_key_request_cancelled ) {
+        request->status = enet_crypto_key_request_generating;
+
+        pthread_mutex_unlock( &key_pool->mutex );
+        return;
+    }
+
+    assert( request->status == enet_crypto_key_request_idle );
+
+    request->next = NULL;
+
+    if ( key_pool->count > 0 ) {
+        request->pair   = key_pool->pair_list[ --key_pool->count ];
+        request->status = enet_crypto_key_request_ready;
+    } else {
+        if ( key_pool->request_tail != NULL )
+            key_pool->request_tail->next = request;
+        else
+            key_pool->request_head = request;
+
+        key_pool->request_tail = request;
+        request->status = enet_crypto_key_request_queued;
+    }
+
+    pthread_cond_signal( &key_pool->condition );
+    pthread_mutex_unlock( &key_pool->mutex );
+}
+
+enet_booleans net_crypto_key_pool_wait(
+    net_crypto_key_pool_t* key_pool,
+    net_crypto_key_request_t* request,
+    net_crypto_key_t* restrict public,
+    net_crypto_key_t* restrict private
+) {
+    assert( key_pool != NULL );
+    assert( request != NULL );
+
+    pthread_mutex_lock( &key_pool->mutex );
+
+    while ( 
+        key_pool->is_running == enet_true && (
+            request->status == enet_crypto_key_request_queued || 
+            request->status == enet_crypto_key_request_generating
+        )
+    )
+        pthread_cond_wait( &key_pool->ready, &key_pool->mutex );
+
+    if ( request->status == enet_crypto_key_request_ready ) {
+        (*public)  = request->pair.public;
+        (*private) = request->pair.private;
+
+        request->status = enet_crypto_key_request_idle;
+
+        pthread_mutex_unlock( &key_pool->mutex );
+
+        return enet_true;
+    }
+
+    pthread_mutex_unlock( &key_pool->mutex );
+
+    net_crypto_key_pool_cancel( key_pool, request );
+
+    return net_crypto_key_pool_pop( key_pool, public, private );
+}
+
+void net_crypto_key_pool_cancel( net_crypto_key_pool_t* key_pool, net_crypto_key_request_t* request ) {
+    assert( key_pool != NULL );
+    assert( request != NULL );
+
+    pthread_mutex_lock( &key_pool->mutex );
+
+    switch ( request->status ) {
+        case enet_crypto_key_request_queued : {
+            net_crypto_key_request_t** link = &key_pool->request_head;
+            net_crypto_key_request_t* previous = NULL;
+
+            while ( *link != request ) {
+                previous = *link;
+                link = &(*link)->next;
+            }
+
+            *link = request->next;
+
+            if ( key_pool->request_tail == request )
+                key_pool->request_tail = previous;
+
+            request->next   = NULL;
+            request->status = enet_crypto_key_request_idle;
+            break;
+        }
+
+        // The pool thread hands the pair back to the pool when it is done.
+        case enet_crypto_key_request_generating : request->status = enet_crypto_key_request_cancelled; break;
+
+        case enet_crypto_key_request_ready :
+            net_crypto_key_pool_push( key_pool, &request->pair );
+            request->status = enet_crypto_key_request_idle;
+            break;
+
+        default : break;
+    }
+
+    pthread_mutex_unlock( &key_pool->mutex );
+}
+
+void net_crypto_key_pool_destroy( net_crypto_key_pool_t* key_pool ) {
+    assert( key_pool != NULL );
+
+    if ( key_pool->pair_list == NULL )
+        return;
+
+    pthread_mutex_lock( &key_pool->mutex );
+    key_pool->is_running = enet_false;
+    pthread_cond_broadcast( &key_pool->condition );
+    pthread_cond_broadcast( &key_pool->ready );
+    pthread_mutex_unlock( &key_pool->mutex );
+
+    for ( uint32_t i = 0; i < key_pool->thread_count; i++ )
+        pthread_join( key_pool->thread_list[ i ], NULL );
+
+    net_crypto_key_pool_release( key_pool );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CRYPTO ( TICKETS )
+/////////////////////////////////////////////////////////////////////////////////////////////////
+enet_booleans net_crypto_ticket_cache_create(
+    net_crypto_ticket_cache_t* ticket_cache,
+    const uint32_t capacity,
+    const uint32_t lifetime
+) {
+    assert( ticket_cache != NULL );
+
+    memset( ticket_cache, 0x00, sizeof( net_crypto_ticket_cache_t ) );
+
+    if ( capacity == 0 || lifetime == 0 )
+        return enet_true;
+
+    ticket_cache->ticket_list = (net_crypto_ticket_t*)calloc( capacity, sizeof( net_crypto_ticket_t ) );
+
+    if ( ticket_cache->ticket_list == NULL ) {
+        net_print_error( "Can't allocate %u tickets for ticket cache %p", capacity, ticket_cache );
+
+        return enet_false;
+    }
+
+    if ( pthread_mutex_init( &ticket_cache->mutex, NULL ) != 0 ) {
+        net_print_error( "Can't create mutex for ticket cache %p", ticket_cache );
+        free( ticket_cache->ticket_list );
+        ticket_cache->ticket_list = NULL;
+
+        return enet_false;
+    }
+
+    ticket_cache->capacity = capacity;
+    ticket_cache->lifetime = lifetime;
+
+    return enet_true;
+}
+
+void net_crypto_ticket_cache_issue(
+    net_crypto_ticket_cache_t* ticket_cache,
+    const net_crypto_key_t* server_public,
+    const net_crypto_key_t* server_private,
+    const net_crypto_key_t* client_public,
+    uint8_t id[ NET_CRYPTO_TICKET_SIZE ]
+) {
+    assert( net_crypto_ticket_cache_is_enabled( ticket_cache ) == enet_true );
+
+    const time_t now = time( NULL );
+
+    net_crypto_random_bytes( id, NET_CRYPTO_TICKET_SIZE );
+
+    pthread_mutex_lock( &ticket_cache->mutex );
+
+    // Free or expired slots have the lowest expire, take the first of them.
+    net_crypto_ticket_t* ticket = ticket_cache->ticket_list;
+
+    for ( uint32_t i = 1; i < ticket_cache->capacity && ticket->expire > now; i++ ) {
+        if ( ticket_cache->ticket_list[ i ].expire < ticket->expire )
+            ticket = ticket_cache->ticket_list + i;
+    }
+
+    memcpy( ticket->id, id, NET_CRYPTO_TICKET_SIZE );
+
+    ticket->expire         = now + ticket_cache->lifetime;
+    ticket->server_public  = *server_public;
+    ticket->server_private = *server_private;
+    ticket->client_public  = *client_public;
+
+    pthread_mutex_unlock( &ticket_cache->mutex );
+}
+
+enet_booleans net_crypto_ticket_cache_resume(
+    net_crypto_ticket_cache_t* ticket_cache,
+    const uint8_t id[ NET_CRYPTO_TICKET_SIZE ],
+    const net_crypto_key_t* client_public,
+    net_crypto_key_t* restrict server_public,
+    net_crypto_key_t* restrict server_private
+) {
+    assert( ticket_cache != NULL );
+
+    if ( net_crypto_ticket_cache_is_enabled( ticket_cache ) == enet_false )
+        return enet_false;
+
+    const time_t now = time( NULL );
+    enet_booleans result = enet_false;
+
+    pthread_mutex_lock( &ticket_cache->mutex );
+
+    for ( uint32_t i = 0; i < ticket_cache->capacity; i++ ) {
+        net_crypto_ticket_t* ticket = ticket_cache->ticket_list + i;
+
+        if ( ticket->expire <= now || memcmp( ticket->id, id, NET_CRYPTO_TICKET_SIZE ) != 0 )
+            continue;
+
+        if ( 
+            ticket->client_public.exponent == client_public->exponent &&
+            ticket->client_public.modulus == client_public->modulus
+        ) {
+            (*server_public)  = ticket->server_public;
+            (*server_private) = ticket->server_private;
+
+            result = enet_true;
+        }
+
+        break;
+    }
+
+    pthread_mutex_unlock( &ticket_cache->mutex );
+
+    return result;
+}
+
+enet_booleans net_crypto_ticket_cache_is_enabled( const net_crypto_ticket_cache_t* ticket_cache ) {
+    assert( ticket_cache != NULL );
+
+    if ( ticket_cache->ticket_list != NULL )
+        return enet_true;
+
+    return enet_false;
+}
+
+void net_crypto_ticket_cache_destroy( net_crypto_ticket_cache_t* ticket_cache ) {
+    assert( ticket_cache != NULL );
+
+    if ( ticket_cache->ticket_list == NULL )
+        return;
+
+    pthread_mutex_destroy( &ticket_cache->mutex );
+    free( ticket_cache->ticket_list );
+
+    memset( ticket_cache, 0x00, sizeof( net_crypto_ticket_cache_t ) );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CRYPTO ( WORKERS )
+/////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * net_crypto_workers_t struct
+ * @field thread_list worker threads.
+ * @field thread_count thread_list length.
+ * @field submit taken by the thread owning the current job, other callers
+ *        run their blocks alone instead of waiting.
+ * @field mutex guard every field below.
+ * @field wake signaled when a job is published or the pool stop.
+ * @field done signaled when the last range of a job is completed.
+ * @field task current job range functor, NULL when idle.
+ * @field user current job argument.
+ * @field count current job block count.
+ * @field next first block not yet claimed.
+ * @field pending ranges claimed but not completed.
+ * @field is_running false once the pool is destroyed.
+ **/
+typedef struct net_crypto_workers_t {
+    pthread_t* thread_list;
+    uint32_t thread_count;
+    pthread_mutex_t submit;
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    net_crypto_task_t task;
+    void* user;
+    size_t count;
+    size_t next;
+    uint32_t pending;
+    enet_booleans is_running;
+} net_crypto_workers_t;
+
+net_crypto_workers_t* net_crypto_workers = NULL;
+
+/**
+ * Claim and run ranges of the current job until none is left, must be called
+ * with the mutex locked and return with it locked.
+ **/
+void net_crypto_workers_drain( net_crypto_workers_t* workers ) {
+    while ( workers->task != NULL && workers->next < workers->count ) {
+        const net_crypto_task_t task = workers->task;
+        void* user = workers->user;
+        const size_t begin = workers->next;
+        size_t end = begin + NET_CRYPTO_PARALLEL_CHUNK;
+
+        if ( end > workers->count )
+            end = workers->count;
+
+        workers->next = end;
+        workers->pending += 1;
+
+        pthread_mutex_unlock( &workers->mutex );
+        task( user, begin, end );
+        pthread_mutex_lock( &workers->mutex );
+
+        workers->pending -= 1;
+
+        if ( workers->pending == 0 && workers->next >= workers->count )
+            pthread_cond_broadcast( &workers->done );
+    }
+}
+
+void* net_crypto_workers_loop( void* argument ) {
+    net_crypto_workers_t* workers = (net_crypto_workers_t*)argument;
+
+    pthread_mutex_lock( &workers->mutex );
+
+    while ( workers->is_running == enet_true ) {
+        if ( workers->task != NULL && workers->next < workers->count )
+            net_crypto_workers_drain( workers );
+        else
+            pthread_cond_wait( &workers->wake, &workers->mutex );
+    }
+
+    pthread_mutex_unlock( &workers->mutex );
+
+    return NULL;
+}
+
+void net_crypto_parallel_for( net_crypto_task_t task, void* user, const size_t count ) {
+    assert( task != NULL );
+
+    net_crypto_workers_t* workers = net_crypto_workers;
+
+    if ( 
+        workers == NULL ||
+        count < NET_CRYPTO_PARALLEL_THRESHOLD ||
+        pthread_mutex_trylock( &workers->submit ) != 0
+    ) {
+        task( user, 0, count );
+        return;
+    }
+
+    pthread_mutex_lock( &workers->mutex );
+
+    workers->task    = task;
+    workers->user    = user;
+    workers->count   = count;
+    workers->next    = 0;
+    workers->pending = 0;
+
+    pthread_cond_broadcast( &workers->wake );
+
+    net_crypto_workers_drain( workers );
+
+    while ( workers->pending > 0 )
+        pthread_cond_wait( &workers->done, &workers->mutex );
+
+    workers->task = NULL;
+    workers->user = NULL;
+
+    pthread_mutex_unlock( &workers->mutex );
+    pthread_mutex_unlock( &workers->submit );
+}
+
+void net_crypto_destroy_workers( ) {
+    net_crypto_workers_t* workers = net_crypto_workers;
+
+    if ( workers == NULL )
+        return;
+
+    net_crypto_workers = NULL;
+
+    pthread_mutex_lock( &workers->mutex );
+    workers->is_running = enet_false;
+    pthread_cond_broadcast( &workers->wake );
+    pthread_mutex_unlock( &workers->mutex );
+
+    for ( uint32_t i = 0; i < workers->thread_count; i++ )
+        pthread_join( workers->thread_list[ i ], NULL );
+
+    pthread_cond_destroy( &workers->done );
+    pthread_cond_destroy( &workers->wake );
+    pthread_mutex_destroy( &workers->mutex );
+    pthread_mutex_destroy( &workers->submit );
+
+    free( workers->thread_list );
+    free( workers );
+}
+
+uint32_t net_crypto_get_default_workers( ) {
+    const long core_count = sysconf( _SC_NPROCESSORS_ONLN );
+
+    return ( core_count > 1 ) ? (uint32_t)( core_count - 1 ) : 1;
+}
+
+enet_booleans net_crypto_init_workers( const uint32_t thread_count ) {
+    net_crypto_destroy_workers( );
+
+    if ( thread_count == 0 )
+        return enet_true;
+
+    net_crypto_workers_t* workers = (net_crypto_workers_t*)malloc( sizeof( net_crypto_workers_t ) );
+
+    if ( workers == NULL ) {
+        net_print_error( "Can't allocate crypto workers" );
+
+        return enet_false;
+    }
+
+    memset( workers, 0x00, sizeof( net_crypto_workers_t ) );
+
+    workers->thread_list = (pthread_t*)malloc( thread_count * sizeof( pthread_t ) );
+    workers->is_running  = enet_true;
+
+    if ( workers->thread_list == NULL ) {
+        net_print_error( "Can't allocate %u crypto worker threads", thread_count );
+        free( workers );
+
+        return enet_false;
+    }
+
+    pthread_mutex_init( &workers->submit, NULL );
+    pthread_mutex_init( &workers->mutex, NULL );
+    pthread_cond_init( &workers->wake, NULL );
+    pthread_cond_init( &workers->done, NULL );
+
+    net_crypto_workers = workers;
+
+    while ( workers->thread_count < thread_count ) {
+        pthread_t* thread = workers->thread_list + workers->thread_count;
+
+        if ( pthread_create( thread, NULL, net_crypto_workers_loop, workers ) != 0 ) {
+            net_print_error( "Can't create crypto worker %u", workers->thread_count );
+            net_crypto_destroy_workers( );
+
+            return enet_false;
+        }
+
+        workers->thread_count += 1;
+    }
 
     return enet_true;
 }
@@ -823,8 +3625,7 @@ void net_thread_start( net_thread_t* thread, const net_socket_t* client_socket )
     thread->context.status = enet_thread_init;
 
     memmove( &thread->context.socket, client_socket, sizeof(net_socket_t) );
-    memset( &thread->context.crypto_client, 0x00, sizeof(net_crypto_key_t) );
-    memset( &thread->context.crypto_server, 0x00, sizeof(net_crypto_key_t) );
+    net_crypto_session_init( &thread->context.crypto );
 
     net_thread_mutex_unlock( thread );
 }
@@ -35,6 +35,12 @@
 #include <sys/stat.h>
 #include <netinet/in.h>
 #include <fcntl.h>
+#include <poll.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#   define NET_ARCH_X86
+#   include <immintrin.h>
+#endif
 
 #define net_unused(name) ((void)name)
 
@@ -73,6 +79,11 @@ enet_booleans net_buffer_create( net_buffer_t* buffer, const uint32_t length );
 
 enet_booleans net_buffer_resize( net_buffer_t* buffer, const uint32_t size );
 
+/**
+ * Grow buffer so extra more bytes fit after its current size, keeping content.
+ **/
+enet_booleans net_buffer_reserve( net_buffer_t* buffer, const uint32_t extra );
+
 void net_buffer_clear( net_buffer_t *buffer );
 
 enet_booleans net_buffer_is_valid( const net_buffer_t* buffer );
@@ -186,21 +197,265 @@ void net_file_close( net_file_t* file );
 /////////////////////////////////////////////////////////////////////////////////////////////////
 enet_booleans net_read_input( net_buffer_t *buffer, enet_booleans wait_for_inputs );
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CHECKSUM
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * CRC32C ( Castagnoli ), using SSE4.2 crc32 instructions when available and a
+ * slicing-by-8 table otherwise. Pass the previous result as crc to checksum a
+ * stream chunk by chunk, 0 to start a new one.
+ **/
+uint32_t net_crc32c_update( uint32_t crc, const void* data, const size_t size );
+
+uint32_t net_crc32c( const void* data, const size_t size );
+
+/**
+ * CRC32C of the concatenation of two blocks, from their own CRC32C and the size
+ * of the second one, without reading them again.
+ **/
+uint32_t net_crc32c_combine( const uint32_t crc, const uint32_t next_crc, size_t next_size );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// COMPRESSION
+/////////////////////////////////////////////////////////////////////////////////////////////////
+typedef enum enet_compression_modes {
+    enet_compression_lz = 0x01,
+    enet_compression_all = enet_compression_lz
+} enet_compression_modes;
+
+/**
+ * Worst case size of a block produced by net_lz_compress for size bytes.
+ **/
+uint32_t net_lz_bound( const uint32_t size );
+
+/**
+ * LZ77 block compression in the LZ4 block format : sequences of a token, literals,
+ * a 16 bits little endian offset and the match length extension, the last sequence
+ * is made of literals only. The LZ4 end of block rules hold : the last 5 bytes are
+ * literals and no match starts in the last 12 bytes, so inputs under 13 bytes are
+ * stored as literals. Greedy single probe hashing, built for speed.
+ * @return : Block size, 0 when it would not fit in capacity.
+ **/
+uint32_t net_lz_compress( const uint8_t* src, const uint32_t size, uint8_t* dst, const uint32_t capacity );
+
+/**
+ * Decompress a block of exactly raw_size bytes, every read and write is bound
+ * checked so blocks from the network are safe to decode.
+ **/
+enet_booleans net_lz_decompress( const uint8_t* src, const uint32_t size, uint8_t* dst, const uint32_t raw_size );
+
+/**
+ * Append the LZ encoding of src to out, laid out as [ raw_size ][ block ].
+ * @return : enet_false, out unchanged, when the encoding isn't smaller than src.
+ **/
+enet_booleans net_lz_encode( const uint8_t* src, const uint32_t size, net_buffer_t* out );
+
+/**
+ * Raw size of an LZ encoding, 0 when it is truncated.
+ **/
+uint32_t net_lz_get_raw_size( const uint8_t* src, const uint32_t size );
+
+/**
+ * Decode an LZ encoding into dst, sized with net_lz_get_raw_size.
+ **/
+enet_booleans net_lz_decode( const uint8_t* src, const uint32_t size, uint8_t* dst );
+
+/**
+ * net_lz_stream_t struct
+ * @note : Incremental decoder of an LZ encoding. The output comes a slice at a time,
+ * only the match history is kept instead of the whole decoded content.
+ * @field src : Next byte of the block.
+ * @field end : End of the block.
+ * @field window : Last decoded bytes, matches are copied from it. NULL once ended.
+ * @field window_size : Bytes held in window.
+ * @field raw_left : Decoded bytes left to produce.
+ * @field literal_left : Literals of the current sequence left to copy.
+ * @field match_left : Match bytes of the current sequence left to copy.
+ * @field offset : Match offset of the current sequence.
+ * @field token : Token of the current sequence.
+ * @field has_match : True while the match of the current sequence is still to read.
+ **/
+typedef struct net_lz_stream_t {
+    const uint8_t* src;
+    const uint8_t* end;
+    uint8_t* window;
+    uint32_t window_size;
+    uint32_t raw_left;
+    uint32_t literal_left;
+    uint32_t match_left;
+    uint32_t offset;
+    uint8_t token;
+    enet_booleans has_match;
+} net_lz_stream_t;
+
+/**
+ * Start decoding the LZ encoding src, it must stay valid until net_lz_stream_end.
+ **/
+enet_booleans net_lz_stream_begin( net_lz_stream_t* stream, const uint8_t* src, const uint32_t size );
+
+/**
+ * Decode the next length bytes of the stream into dst.
+ * @return : enet_false when the block is malformed or has less than length bytes left.
+ **/
+enet_booleans net_lz_stream_read( net_lz_stream_t* stream, uint8_t* dst, const uint32_t length );
+
+/**
+ * Decode and drop the next length bytes of the stream.
+ **/
+enet_booleans net_lz_stream_skip( net_lz_stream_t* stream, uint32_t length );
+
+void net_lz_stream_end( net_lz_stream_t* stream );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// HASH
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#define NET_SHA256_SIZE 32
+#define NET_CDC_MIN_SIZE ( 2 * 1024 )
+#define NET_CDC_AVERAGE_SIZE ( 8 * 1024 )
+#define NET_CDC_MAX_SIZE ( 32 * 1024 )
+
+/**
+ * SHA-256 ( FIPS 180-4 ) digest of size bytes.
+ **/
+void net_sha256( const void* data, const size_t size, uint8_t digest[ NET_SHA256_SIZE ] );
+
+/**
+ * Content defined chunking, gear rolling hash with normalized cut masks ( FastCDC ).
+ * Boundaries only depend on the bytes around them, so an insertion only changes
+ * the chunks it touches.
+ * @return : Size of the chunk starting at src, between NET_CDC_MIN_SIZE and
+ *           NET_CDC_MAX_SIZE unless size is smaller.
+ **/
+uint32_t net_cdc_cut( const uint8_t* src, const uint32_t size );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// BLOOM
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#define NET_BLOOM_HASH_COUNT 7
+#define NET_BLOOM_BITS_PER_ITEM 10
+#define NET_BLOOM_MIN_BITS ( 8 * 1024 )
+
+/**
+ * net_bloom_t struct
+ * @note : Bloom filter, a test may answer true for an item never added but never
+ * false for an added one. Sized for about 1% of false positives at capacity.
+ * @field bit_count size of bits in bits, a multiple of 8.
+ * @field item_count count of items added.
+ * @field capacity count of items the filter was sized for.
+ * @field bits filter bits.
+ **/
+typedef struct net_bloom_t {
+    uint32_t bit_count;
+    uint32_t item_count;
+    uint32_t capacity;
+    uint8_t* bits;
+} net_bloom_t;
+
+enet_booleans net_bloom_create( net_bloom_t* bloom, const uint32_t capacity );
+
+void net_bloom_destroy( net_bloom_t* bloom );
+
+void net_bloom_add( net_bloom_t* bloom, const void* data, const size_t size );
+
+enet_booleans net_bloom_test( const net_bloom_t* bloom, const void* data, const size_t size );
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // CRYPTO ( RSA-TOY )
 /////////////////////////////////////////////////////////////////////////////////////////////////
+#define NET_CRYPTO_MIN_MODULUS_BITS 16
+#define NET_CRYPTO_MAX_MODULUS_BITS 62
+
+#define NET_CRYPTO_MAX_WINDOW_COUNT 64
+#define NET_CRYPTO_BATCH_SIZE 64
+
+/**
+ * net_crypto_montgomery_t struct
+ * @field modulus odd modulus, 0 when the context is not prepared.
+ * @field inverse -modulus^-1 mod 2^64.
+ * @field square 2^128 mod modulus, used to enter Montgomery form.
+ * @field window_width bits per exponent window, from 1 to 4.
+ * @field window_count count of exponent windows.
+ * @field window_list exponent digits, most significant first.
+ **/
+typedef struct net_crypto_montgomery_t {
+    uint64_t modulus;
+    uint64_t inverse;
+    uint64_t square;
+    uint32_t window_width;
+    uint32_t window_count;
+    uint8_t window_list[ NET_CRYPTO_MAX_WINDOW_COUNT ];
+} net_crypto_montgomery_t;
+
+/**
+ * net_crypto_key_t struct
+ * @field exponent public or private exponent.
+ * @field modulus key modulus, exponent and modulus are the only fields sent.
+ * @field p, q modulus factors, 0 for public keys.
+ * @field dp, dq, qinv CRT exponents and coefficient of private keys.
+ * @field montgomery_n plan for exponent modulo modulus.
+ * @field montgomery_p plan for dp modulo p.
+ * @field montgomery_q plan for dq modulo q.
+ **/
 typedef struct net_crypto_key_t {
     uint64_t exponent;
     uint64_t modulus;
+    uint64_t p;
+    uint64_t q;
+    uint64_t dp;
+    uint64_t dq;
+    uint64_t qinv;
+    net_crypto_montgomery_t montgomery_n;
+    net_crypto_montgomery_t montgomery_p;
+    net_crypto_montgomery_t montgomery_q;
 } net_crypto_key_t;
 
 void net_crypto_init_seed( uint32_t seed );
 
+/**
+ * Set the modulus width of the generated keys, from 16 to 62 bits. 0 keep the
+ * historical ~22 bits range, blocks then carry 2 bytes instead of up to 7.
+ **/
+void net_crypto_init_key_size( uint32_t modulus_bits );
+
 enet_booleans net_crypto_generate_keys(
     net_crypto_key_t* restrict public,
     net_crypto_key_t* restrict private
 );
 
+/**
+ * Raw block transforms, dst must hold the whole output. Outputs of consecutive
+ * calls concatenate when every call but the last covers whole windows, see
+ * net_crypto_session_get_encrypt_window.
+ **/
+size_t net_crypto_encrypt_raw(
+    const net_crypto_key_t* key,
+    const uint8_t* restrict src,
+    const size_t size,
+    uint8_t* restrict dst
+);
+
+size_t net_crypto_decrypt_raw(
+    const net_crypto_key_t* key,
+    const uint8_t* restrict src,
+    const size_t size,
+    uint8_t* restrict dst
+);
+
+size_t net_crypto_encrypt_packed_raw(
+    const net_crypto_key_t* key,
+    const uint8_t* restrict src,
+    const size_t size,
+    uint8_t* restrict dst
+);
+
+size_t net_crypto_decrypt_packed_raw(
+    const net_crypto_key_t* key,
+    const uint8_t* restrict src,
+    const size_t size,
+    uint8_t* restrict dst
+);
+
 enet_booleans net_crypto_encrypt(
     const net_crypto_key_t* key,
     const struct net_buffer_t* restrict src,
@@ -213,11 +468,345 @@ enet_booleans net_crypto_decrypt(
     struct net_buffer_t* restrict dst
 );
 
+enet_booleans net_crypto_encrypt_packed(
+    const net_crypto_key_t* key,
+    const struct net_buffer_t* restrict src,
+    struct net_buffer_t* restrict dst
+);
+
+enet_booleans net_crypto_decrypt_packed(
+    const net_crypto_key_t* key,
+    const struct net_buffer_t* restrict src,
+    struct net_buffer_t* restrict dst
+);
+
+/**
+ * Precompute Montgomery constants and exponent windows, must be called again
+ * when exponent or modulus are set by hand, like keys read from the wire.
+ **/
+void net_crypto_key_prepare( net_crypto_key_t* key );
+
 enet_booleans net_crypto_is_key_valid( const net_crypto_key_t* key );
 
+void net_crypto_random_bytes( uint8_t* out, const size_t length );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CRYPTO ( CHACHA20 )
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#define NET_CHACHA20_KEY_SIZE 32
+#define NET_CHACHA20_NONCE_SIZE 12
+#define NET_CHACHA20_BLOCK_SIZE 64
+
+/**
+ * net_chacha20_t struct
+ * @field state current RFC 7539 state, state[ 12 ] is the next block counter.
+ * @field keystream last generated keystream block.
+ * @field keystream_offset bytes of keystream already consumed, 64 when empty.
+ **/
+typedef struct net_chacha20_t {
+    uint32_t state[ 16 ];
+    uint8_t keystream[ NET_CHACHA20_BLOCK_SIZE ];
+    uint32_t keystream_offset;
+} net_chacha20_t;
+
+void net_chacha20_init(
+    net_chacha20_t* chacha,
+    const uint8_t key[ NET_CHACHA20_KEY_SIZE ],
+    const uint8_t nonce[ NET_CHACHA20_NONCE_SIZE ],
+    const uint32_t counter
+);
+
+void net_chacha20_xor(
+    net_chacha20_t* chacha,
+    const uint8_t* src,
+    uint8_t* dst,
+    const size_t length
+);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CRYPTO ( SESSION )
+/////////////////////////////////////////////////////////////////////////////////////////////////
+typedef enum enet_crypto_modes {
+    enet_crypto_rsa        = 1 << 0,
+    enet_crypto_chacha20   = 1 << 1,
+    enet_crypto_rsa_packed = 1 << 2,
+    enet_crypto_all        = enet_crypto_rsa | enet_crypto_chacha20 | enet_crypto_rsa_packed
+} enet_crypto_modes;
+
+#define NET_CRYPTO_SECRET_SIZE ( NET_CHACHA20_KEY_SIZE + 2 * NET_CHACHA20_NONCE_SIZE )
+
+/**
+ * net_crypto_session_t struct
+ * @field mode negotiated bulk cipher, RSA-TOY blocks ( plain or bit-packed ) or ChaCha20 stream.
+ * @field encrypt_key local private key, used for outgoing RSA-TOY blocks.
+ * @field decrypt_key remote public key, used for incoming RSA-TOY blocks.
+ * @field encrypt_stream outgoing ChaCha20 stream.
+ * @field decrypt_stream incoming ChaCha20 stream.
+ **/
+typedef struct net_crypto_session_t {
+    enet_crypto_modes mode;
+    net_crypto_key_t encrypt_key;
+    net_crypto_key_t decrypt_key;
+    net_chacha20_t encrypt_stream;
+    net_chacha20_t decrypt_stream;
+} net_crypto_session_t;
+
+void net_crypto_session_init( net_crypto_session_t* session );
+
+enet_crypto_modes net_crypto_session_select( const uint32_t local_modes, const uint32_t remote_modes );
+
+void net_crypto_session_start_stream(
+    net_crypto_session_t* session,
+    const uint8_t secret[ NET_CRYPTO_SECRET_SIZE ],
+    const enet_booleans is_server
+);
+
+const char* net_crypto_session_get_name( const net_crypto_session_t* session );
+
+size_t net_crypto_session_get_cypher_size( const net_crypto_session_t* session, const size_t plain_size );
+
+size_t net_crypto_session_get_plain_size( const net_crypto_session_t* session, const size_t cypher_size );
+
+/**
+ * Largest plain and cypher window pair fitting in window_size cypher bytes
+ * that can be transformed on its own, used to stream messages in place.
+ **/
+void net_crypto_session_get_encrypt_window(
+    const net_crypto_session_t* session,
+    const size_t window_size,
+    size_t* plain_window,
+    size_t* cypher_window
+);
+
+void net_crypto_session_get_decrypt_window(
+    const net_crypto_session_t* session,
+    const size_t window_size,
+    size_t* plain_window,
+    size_t* cypher_window
+);
+
+size_t net_crypto_session_encrypt_raw(
+    net_crypto_session_t* session,
+    const uint8_t* restrict src,
+    const size_t size,
+    uint8_t* restrict dst
+);
+
+size_t net_crypto_session_decrypt_raw(
+    net_crypto_session_t* session,
+    const uint8_t* restrict src,
+    const size_t size,
+    uint8_t* restrict dst
+);
+
+enet_booleans net_crypto_session_encrypt(
+    net_crypto_session_t* session,
+    const struct net_buffer_t* restrict src,
+    struct net_buffer_t* restrict dst
+);
+
+enet_booleans net_crypto_session_decrypt(
+    net_crypto_session_t* session,
+    const struct net_buffer_t* restrict src,
+    struct net_buffer_t* restrict dst
+);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CRYPTO ( KEY POOL )
+/////////////////////////////////////////////////////////////////////////////////////////////////
+typedef struct net_crypto_key_pair_t {
+    net_crypto_key_t public;
+    net_crypto_key_t private;
+} net_crypto_key_pair_t;
+
+typedef enum enet_crypto_key_request_status {
+    enet_crypto_key_request_idle = 0,
+    enet_crypto_key_request_queued,
+    enet_crypto_key_request_generating,
+    enet_crypto_key_request_ready,
+    enet_crypto_key_request_cancelled
+} enet_crypto_key_request_status;
+
+/**
+ * net_crypto_key_request_t struct, key pair future filled by the key pool threads.
+ * @field next next queued request.
+ * @field status request progress, guarded by the key pool mutex.
+ * @field pair generated key pair once ready.
+ **/
+typedef struct net_crypto_key_request_t {
+    struct net_crypto_key_request_t* next;
+    enet_crypto_key_request_status status;
+    net_crypto_key_pair_t pair;
+} net_crypto_key_request_t;
+
+/**
+ * net_crypto_key_pool_t struct
+ * @field thread_list background threads serving requests and refilling the pool.
+ * @field thread_count thread_list length.
+ * @field mutex guard count, pair_list, the request queue and is_running.
+ * @field condition wake the pool threads when a pair is popped or a request queued.
+ * @field ready signaled when a request is completed.
+ * @field pair_list ready key pairs, used as a stack.
+ * @field capacity pair_list length.
+ * @field count ready key pairs in pair_list.
+ * @field request_head oldest queued request, served before refilling.
+ * @field request_tail newest queued request.
+ * @field is_running false once the pool is destroyed.
+ **/
+typedef struct net_crypto_key_pool_t {
+    pthread_t* thread_list;
+    uint32_t thread_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    pthread_cond_t ready;
+    net_crypto_key_pair_t* pair_list;
+    uint32_t capacity;
+    uint32_t count;
+    net_crypto_key_request_t* request_head;
+    net_crypto_key_request_t* request_tail;
+    enet_booleans is_running;
+} net_crypto_key_pool_t;
+
+enet_booleans net_crypto_key_pool_create(
+    net_crypto_key_pool_t* key_pool,
+    const uint32_t capacity,
+    const uint32_t thread_count
+);
+
+/**
+ * Pop a ready key pair, generate one inline when the pool is drained.
+ **/
+enet_booleans net_crypto_key_pool_pop(
+    net_crypto_key_pool_t* key_pool,
+    net_crypto_key_t* restrict public,
+    net_crypto_key_t* restrict private
+);
+
+/**
+ * Start fetching a key pair for request without blocking, a pooled pair is
+ * taken right away, otherwise the request is queued for the pool threads.
+ **/
+void net_crypto_key_pool_request( net_crypto_key_pool_t* key_pool, net_crypto_key_request_t* request );
+
+/**
+ * Wait for request to complete and take its key pair, a request never posted
+ * falls back to net_crypto_key_pool_pop.
+ **/
+enet_booleans net_crypto_key_pool_wait(
+    net_crypto_key_pool_t* key_pool,
+    net_crypto_key_request_t* request,
+    net_crypto_key_t* restrict public,
+    net_crypto_key_t* restrict private
+);
+
+/**
+ * Drop request, its key pair goes back to the pool once generated.
+ **/
+void net_crypto_key_pool_cancel( net_crypto_key_pool_t* key_pool, net_crypto_key_request_t* request );
+
+void net_crypto_key_pool_destroy( net_crypto_key_pool_t* key_pool );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CRYPTO ( TICKETS )
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#define NET_CRYPTO_TICKET_SIZE 16
+
+// Ticket size sent by clients that can't store tickets, so none is issued to them.
+#define NET_CRYPTO_TICKET_NONE 0xFFFFFFFFu
+
+/**
+ * net_crypto_ticket_t struct
+ * @field id random ticket identifier handed to the client.
+ * @field expire time after which the ticket is refused, 0 for a free slot.
+ * @field server_public server public key sent back on resumption.
+ * @field server_private server private key of the ticket session.
+ * @field client_public client public key the ticket was issued to.
+ **/
+typedef struct net_crypto_ticket_t {
+    uint8_t id[ NET_CRYPTO_TICKET_SIZE ];
+    time_t expire;
+    net_crypto_key_t server_public;
+    net_crypto_key_t server_private;
+    net_crypto_key_t client_public;
+} net_crypto_ticket_t;
+
+/**
+ * net_crypto_ticket_cache_t struct
+ * @field mutex guard ticket_list.
+ * @field ticket_list issued tickets, expired or oldest one is overwritten when full.
+ * @field capacity ticket_list length.
+ * @field lifetime ticket lifetime in seconds.
+ **/
+typedef struct net_crypto_ticket_cache_t {
+    pthread_mutex_t mutex;
+    net_crypto_ticket_t* ticket_list;
+    uint32_t capacity;
+    uint32_t lifetime;
+} net_crypto_ticket_cache_t;
+
+enet_booleans net_crypto_ticket_cache_create(
+    net_crypto_ticket_cache_t* ticket_cache,
+    const uint32_t capacity,
+    const uint32_t lifetime
+);
+
+void net_crypto_ticket_cache_issue(
+    net_crypto_ticket_cache_t* ticket_cache,
+    const net_crypto_key_t* server_public,
+    const net_crypto_key_t* server_private,
+    const net_crypto_key_t* client_public,
+    uint8_t id[ NET_CRYPTO_TICKET_SIZE ]
+);
+
+/**
+ * Fetch the server keys of a live ticket issued to client_public.
+ **/
+enet_booleans net_crypto_ticket_cache_resume(
+    net_crypto_ticket_cache_t* ticket_cache,
+    const uint8_t id[ NET_CRYPTO_TICKET_SIZE ],
+    const net_crypto_key_t* client_public,
+    net_crypto_key_t* restrict server_public,
+    net_crypto_key_t* restrict server_private
+);
+
+enet_booleans net_crypto_ticket_cache_is_enabled( const net_crypto_ticket_cache_t* ticket_cache );
+
+void net_crypto_ticket_cache_destroy( net_crypto_ticket_cache_t* ticket_cache );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CRYPTO ( WORKERS )
+/////////////////////////////////////////////////////////////////////////////////////////////////
+#define NET_CRYPTO_PARALLEL_THRESHOLD 4096
+#define NET_CRYPTO_PARALLEL_CHUNK 1024
+
+typedef void (*net_crypto_task_t)( void* user, const size_t begin, const size_t end );
+
+/**
+ * Start the shared crypto worker pool, 0 disable it. Jobs of at least
+ * NET_CRYPTO_PARALLEL_THRESHOLD blocks are split in chunks of
+ * NET_CRYPTO_PARALLEL_CHUNK blocks between the workers and the caller.
+ **/
+enet_booleans net_crypto_init_workers( const uint32_t thread_count );
+
+/**
+ * Default worker count, one per online core beside the caller one, at least one
+ * when the core count is unknown or there is a single core.
+ **/
+uint32_t net_crypto_get_default_workers( );
+
+/**
+ * Run task over [ 0, count ), inline when the pool is missing, busy with
+ * another job or count is below the threshold.
+ **/
+void net_crypto_parallel_for( net_crypto_task_t task, void* user, const size_t count );
+
+void net_crypto_destroy_workers( );
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // SOCKET
 /////////////////////////////////////////////////////////////////////////////////////////////////
+#define NET_SOCKET_CRYPTO_WINDOW ( 64 * 1024 )
+
 typedef enum enet_socket_types {
     enet_socket_server = 0,
     enet_socket_client
@@ -257,6 +846,46 @@ enet_booleans net_socket_send( net_socket_t* socket, net_buffer_t* buffer );
 
 enet_booleans net_socket_recv( net_socket_t* socket, net_buffer_t* buffer );
 
+/**
+ * Encrypt and send buffer through a NET_SOCKET_CRYPTO_WINDOW bytes window,
+ * the whole cypher text never exists in memory. Empty buffers are refused, the
+ * receiver can't tell them from a broken message. TCP only.
+ **/
+enet_booleans net_socket_send_encrypted(
+    net_socket_t* socket,
+    net_crypto_session_t* session,
+    const net_buffer_t* buffer
+);
+
+/**
+ * Encrypt buffer as net_socket_send_encrypted would, appending the message to
+ * output instead of sending it, so several messages leave in one send. Empty
+ * buffers are refused the same way.
+ **/
+enet_booleans net_socket_queue_encrypted(
+    net_crypto_session_t* session,
+    const net_buffer_t* buffer,
+    net_buffer_t* output
+);
+
+/**
+ * Send the messages queued in output and empty it. TCP only.
+ **/
+enet_booleans net_socket_flush( net_socket_t* socket, net_buffer_t* output );
+
+/**
+ * Receive a message sent by net_socket_send_encrypted, decrypting each window
+ * straight into buffer. A message announced over max_size plain bytes is refused
+ * from its length prefix, before anything is allocated or read for it, 0 for no
+ * limit. TCP only.
+ **/
+enet_booleans net_socket_recv_decrypted(
+    net_socket_t* socket,
+    net_crypto_session_t* session,
+    net_buffer_t* buffer,
+    const uint32_t max_size
+);
+
 enet_booleans net_socket_is_valid( const net_socket_t* socket );
 
 enet_booleans net_socket_is_type( const net_socket_t* socket, const enet_socket_types type );
@@ -283,8 +912,13 @@ typedef enum enet_thread_status {
 typedef struct net_thread_context_t {
     enet_thread_status status;
     net_socket_t socket;
-    net_crypto_key_t crypto_server;
-    net_crypto_key_t crypto_client;
+    net_crypto_session_t crypto;
+    net_crypto_key_request_t key_request;
+    uint32_t request_id;
+    net_buffer_t output_buffer;
+    uint64_t output_time;
+    uint32_t compression;
+    net_buffer_t compress_buffer;
 } net_thread_context_t;
 
 typedef struct net_thread_t {
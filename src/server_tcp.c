@@ -13,18 +13,158 @@
 
 #include "net_utils.h"
 #include "net_global.h"
+#include "net_protocol.h"
 
 #define DB_FILE "db.bin"
+#define STORE_FILE "chunks.bin"
+#define KEY_POOL_THREAD_COUNT 2
+#define TICKET_CAPACITY 256
+#define TICKET_LIFETIME 300
+#define STREAM_CAPACITY 64
+#define STREAM_ACTIVE_COUNT 4
+#define STREAM_CHUNK_SIZE ( 16 * 1024 )
+#define STREAM_NAME_LENGTH 256
+#define OUTPUT_SIZE NET_SOCKET_CRYPTO_WINDOW
+#define OUTPUT_DEADLINE_US 200
+#define STORE_IDLE_LIFETIME ( 24 * 60 * 60 )
+#define STORE_SWEEP_INTERVAL ( 10 * 60 )
+#define BLOOM_SUFFIX ".bloom"
+#define BLOOM_MAGIC 0x4D4F4C42
+#define BLOOM_GRAM_SIZE 3
+#define BLOOM_MIN_CAPACITY 1024
+#define BLOOM_SAVE_INTERVAL 30
+
+/**
+ * chunk_set_t struct
+ * @note : Set of chunk hashes, open addressing on the hash bytes.
+ * @field slot_list : slot_count hashes, all zero for empty slots.
+ * @field count : Count of hashes in the set.
+ * @field slot_count : Power of two size of slot_list.
+ **/
+typedef struct chunk_set_t {
+    uint8_t* slot_list;
+    uint32_t count;
+    uint32_t slot_count;
+} chunk_set_t;
+
+/**
+ * server_user_t struct
+ * @note : State of a user kept while the server runs, allocated once and never
+ * moved so handlers keep it from the user file path, see user_find.
+ * @field mutex : Guards the fields below.
+ * @field owned : Chunks the user uploaded or has entries on, the only ones a
+ * send_hash may link without their content.
+ * @field scanned : Size of the user file whose chunk lists are in owned.
+ * @field bloom : Filter of the entry names, no bits until loaded or built.
+ * @field bloom_covered : Size of the user file the filter describes.
+ * @field bloom_end : Size of the user file as last known, the filter is only used
+ * when it covers it.
+ * @field is_bloom_loaded : The filter file was looked at, bloom_end is known.
+ * @field is_bloom_building : A lookup is loading or rebuilding the filter.
+ * @field is_bloom_dirty : The filter changed since its file was last saved.
+ * @field bloom_dirty_time : When the filter became dirty.
+ **/
+typedef struct server_user_t {
+    pthread_mutex_t mutex;
+    chunk_set_t owned;
+    uint32_t scanned;
+    net_bloom_t bloom;
+    uint32_t bloom_covered;
+    uint32_t bloom_end;
+    enet_booleans is_bloom_loaded;
+    enet_booleans is_bloom_building;
+    enet_booleans is_bloom_dirty;
+    uint32_t bloom_dirty_time;
+} server_user_t;
 
 typedef struct server_db_entry_t {
     char* name;
     char* path;
+    server_user_t* user;
 } server_db_entry_t;
 
+/**
+ * store_chunk_t struct
+ * @note : Header of a pack record, followed by the stored bytes of the chunk.
+ * @field hash : SHA-256 of the chunk content.
+ * @field raw_size : Size of the chunk content.
+ * @field stored_size : Size of the stored bytes.
+ * @field flags : STORE_FLAG_* bits.
+ * @field refcount : Count of references from entry records, the chunk is reclaimed
+ * when the last one is released.
+ * @field crc : CRC32C of the chunk content, entry checksums are combined from it.
+ **/
+typedef struct store_chunk_t {
+    uint8_t hash[ NET_SHA256_SIZE ];
+    uint32_t raw_size;
+    uint32_t stored_size;
+    uint32_t flags;
+    uint32_t refcount;
+    uint32_t crc;
+} store_chunk_t;
+
+/**
+ * store_item_t struct, index item of a stored chunk.
+ * @field chunk : Header of the chunk record.
+ * @field offset : Offset of the record in the pack.
+ * @field idle_time : When the chunk was last stored, an unreferenced chunk is
+ * reclaimed STORE_IDLE_LIFETIME seconds after it.
+ **/
+typedef struct store_item_t {
+    store_chunk_t chunk;
+    uint64_t offset;
+    uint32_t idle_time;
+} store_item_t;
+
+/**
+ * store_hole_t struct, space of reclaimed records reused by the next chunks.
+ * Neighbouring holes are merged, a hole never touches another one.
+ * @field offset : Offset of the hole in the pack.
+ * @field size : Size of the hole, record header included.
+ **/
+typedef struct store_hole_t {
+    uint64_t offset;
+    uint32_t size;
+} store_hole_t;
+
+/**
+ * server_store_t struct
+ * @note : Content addressed chunk store shared by every user, an append only pack
+ * file indexed in memory by hash. The index is rebuilt from the pack on start.
+ * @field mutex : Guards the pack file and the index.
+ * @field pack : Pack file, records laid out as [ store_chunk_t ][ stored bytes ].
+ * @field end : End of the last complete record, where the next one is appended.
+ * @field item_list : Index items, one per chunk.
+ * @field slot_list : Open addressing table of item index + 1, 0 for empty slots.
+ * @field slot_count : Power of two size of slot_list.
+ * @field hole_list : Space of reclaimed records, filled before the pack grows.
+ * @field sweep_time : Last look for unreferenced chunks past their lifetime.
+ **/
+typedef struct server_store_t {
+    pthread_mutex_t mutex;
+    FILE* pack;
+    uint64_t end;
+    store_item_t* item_list;
+    uint32_t item_count;
+    uint32_t item_capacity;
+    uint32_t* slot_list;
+    uint32_t slot_count;
+    store_hole_t* hole_list;
+    uint32_t hole_count;
+    uint32_t hole_capacity;
+    uint32_t sweep_time;
+} server_store_t;
+
 typedef struct server_context_t { 
     pthread_mutex_t mutex;
     server_db_entry_t* db;
     uint32_t count;
+    uint32_t crypto_modes;
+    uint32_t caps_flags;
+    uint32_t compression_modes;
+    net_crypto_key_pool_t key_pool;
+    net_crypto_ticket_cache_t ticket_cache;
+    server_store_t store;
 } server_context_t;
 
 server_context_t* context = NULL;
@@ -65,6 +205,7 @@ enet_booleans load_db( ) {
         entry->path = (char*)malloc( sizeof( char ) * length + 1 );
         fread( entry->path, sizeof( char ), length, file );
         entry->path[ length ] = '\0';
+        entry->user = NULL;
 
         id += 1;
     }
@@ -126,11 +267,47 @@ char* emplace_user( const char* user ) {
     memmove( entry->name, user, length );
     snprintf( entry->path, 33, "%" PRIu64, uuid );
 
+    entry->user = NULL;
+
     pthread_mutex_unlock( &context->mutex );
 
     return entry->path;
 }
 
+/**
+ * user_find function
+ * @note : State of the user owning the given file, created on first use.
+ * @return : NULL for an unknown path or when it can't be created.
+ **/
+server_user_t* user_find( const char* path ) {
+    server_user_t* user = NULL;
+
+    pthread_mutex_lock( &context->mutex );
+
+    for ( uint32_t id = 0; id < context->count; id++ ) {
+        server_db_entry_t* entry = &context->db[ id ];
+
+        if ( strcmp( entry->path, path ) != 0 )
+            continue;
+
+        if ( entry->user == NULL ) {
+            entry->user = (server_user_t*)calloc( 1, sizeof( server_user_t ) );
+
+            if ( entry->user != NULL && pthread_mutex_init( &entry->user->mutex, NULL ) != 0 ) {
+                free( entry->user );
+                entry->user = NULL;
+            }
+        }
+
+        user = entry->user;
+        break;
+    }
+
+    pthread_mutex_unlock( &context->mutex );
+
+    return user;
+}
+
 void save_db( ) {
     FILE* file = fopen( DB_FILE, "wb" );
 
@@ -171,230 +348,2998 @@ void destroy_context( ) {
         free( entry->name );
         free( entry->path );
 
+        if ( entry->user != NULL ) {
+            pthread_mutex_destroy( &entry->user->mutex );
+            free( entry->user->owned.slot_list );
+            net_bloom_destroy( &entry->user->bloom );
+            free( entry->user );
+        }
+
         id += 1;
     }
 
     free( context );
 }
 
-void parse_arguments(
-    int argc,
-    char** argv,
-    uint32_t* port,
-    uint32_t* thread_count,
-    uint32_t* crypto_seed
-) {
-    for ( int i = 0; i < argc; i++ ) {
-        if ( argv[ i ][ 0 ] != '-' )
-            continue;
+/**
+ * entry_chunk_t struct, item of the chunk list of an ENTRY_FLAG_CHUNKS record.
+ * @field hash SHA-256 of the chunk, its key in the chunk store.
+ * @field size size of the chunk content.
+ **/
+typedef struct entry_chunk_t {
+    uint8_t hash[ NET_SHA256_SIZE ];
+    uint32_t size;
+} entry_chunk_t;
 
-        switch ( tolower( argv[ i ][ 1 ] ) ) {
-            case 'p' : (*port) = parse_uint32( argv[ i ] + 2 ); break;
-            case 'c' : (*thread_count) = parse_uint32( argv[ i ] + 2 ); break;
-            case 's' : (*crypto_seed) = parse_uint32( argv[ i ] + 2 ); break;
+#define STORE_SLOT_COUNT 1024
+#define STORE_NONE UINT32_MAX
 
-            default : break;
-        }
+// The stored bytes are the LZ encoding of the chunk, see net_lz_encode.
+#define STORE_FLAG_LZ 0x01
+
+// The record is a hole of stored_size bytes left by a reclaimed chunk.
+#define STORE_FLAG_FREE 0x02
+
+uint32_t store_get_home( const uint8_t* hash ) {
+    uint32_t slot = 0;
+
+    memcpy( &slot, hash, sizeof( uint32_t ) );
+
+    return slot & ( context->store.slot_count - 1 );
+}
+
+uint32_t store_find_slot( const uint8_t* hash ) {
+    server_store_t* store = &context->store;
+
+    if ( store->slot_count == 0 )
+        return STORE_NONE;
+
+    for ( uint32_t slot = store_get_home( hash ); store->slot_list[ slot ] != 0; slot = ( slot + 1 ) & ( store->slot_count - 1 ) ) {
+        const uint32_t index = store->slot_list[ slot ] - 1;
+
+        if ( memcmp( store->item_list[ index ].chunk.hash, hash, NET_SHA256_SIZE ) == 0 )
+            return slot;
     }
+
+    return STORE_NONE;
 }
 
-void thread_init_client_exit(
-    net_buffer_t* buffer,
-    net_thread_context_t* thread_context,
-    net_thread_t* thread
-) {
-    net_buffer_destroy( buffer );
-    net_socket_destroy( &thread_context->socket );
-    net_thread_set_status( thread, enet_thread_pending );
+uint32_t store_find( const uint8_t* hash ) {
+    const uint32_t slot = store_find_slot( hash );
+
+    return ( slot != STORE_NONE ) ? context->store.slot_list[ slot ] - 1 : STORE_NONE;
 }
 
-void thread_init_client(
-    net_thread_t* thread,
-    net_thread_context_t* thread_context
-) {
-    assert( thread != NULL );
-    assert( thread_context != NULL );
+void store_link( const uint32_t index ) {
+    server_store_t* store = &context->store;
+    uint32_t slot = store_get_home( store->item_list[ index ].chunk.hash );
 
-    net_buffer_t buffer;
-    memset( &buffer, 0x00, sizeof( net_buffer_t ) );
-    
-    if ( net_buffer_create( &buffer, 2 * sizeof( uint64_t ) ) == enet_false ) {
-        net_socket_destroy( &thread_context->socket );
-        net_thread_set_status( thread, enet_thread_pending );
-        return;
-    }
+    for ( ; store->slot_list[ slot ] != 0; slot = ( slot + 1 ) & ( store->slot_count - 1 ) );
 
-    if ( net_socket_recv( &thread_context->socket, &buffer ) == enet_false ) {
-        thread_init_client_exit( &buffer, thread_context, thread );
-        return;
+    store->slot_list[ slot ] = index + 1;
+}
+
+/**
+ * Empty a slot, the items probed past it are shifted back so no lookup stops early.
+ **/
+void store_unlink( uint32_t slot ) {
+    server_store_t* store = &context->store;
+    const uint32_t mask = store->slot_count - 1;
+
+    store->slot_list[ slot ] = 0;
+
+    for ( uint32_t next = ( slot + 1 ) & mask; store->slot_list[ next ] != 0; next = ( next + 1 ) & mask ) {
+        const uint32_t home = store_get_home( store->item_list[ store->slot_list[ next ] - 1 ].chunk.hash );
+
+        // An item stays when its home lies cyclically in ( slot, next ].
+        if ( ( ( next - home ) & mask ) < ( ( next - slot ) & mask ) )
+            continue;
+
+        store->slot_list[ slot ] = store->slot_list[ next ];
+        store->slot_list[ next ] = 0;
+        slot = next;
     }
+}
 
-    net_buffer_io_t buffer_io = net_buffer_io_acquire( &buffer, enet_buffer_io_read_write );
+/**
+ * Track the hole of size bytes at offset, merged with the holes right before and
+ * after it so reclaimed neighbours make room for bigger records.
+ * @return : Index of the hole holding it, STORE_NONE without room to track it.
+ **/
+uint32_t store_add_hole( uint64_t offset, uint32_t size ) {
+    server_store_t* store = &context->store;
+    uint32_t i = 0;
+
+    while ( i < store->hole_count ) {
+        const store_hole_t* hole = store->hole_list + i;
+        const enet_booleans is_before = ( hole->offset + hole->size == offset ) ? enet_true : enet_false;
+        const enet_booleans is_after = ( offset + size == hole->offset ) ? enet_true : enet_false;
+
+        if ( ( is_before == enet_false && is_after == enet_false ) || hole->size > UINT32_MAX - size ) {
+            i += 1;
+            continue;
+        }
 
-    net_thread_mutex_lock( thread );
-    if ( 
-        net_buffer_io_read_uint64( &buffer_io, &thread_context->crypto_client.exponent ) == enet_false ||
-        net_buffer_io_read_uint64( &buffer_io, &thread_context->crypto_client.modulus ) == enet_false
-    ) {
-        net_thread_mutex_unlock( thread );
-        thread_init_client_exit( &buffer, thread_context, thread );
-        return;
+        if ( is_before == enet_true )
+            offset = hole->offset;
+
+        size += hole->size;
+
+        store->hole_list[ i ] = store->hole_list[ --store->hole_count ];
     }
-    net_thread_mutex_unlock( thread );
 
-    net_buffer_io_reset( &buffer_io );
+    if ( store->hole_count == store->hole_capacity ) {
+        const uint32_t capacity = ( store->hole_capacity > 0 ) ? store->hole_capacity * 2 : 64;
+        store_hole_t* hole_list = realloc( store->hole_list, capacity * sizeof( store_hole_t ) );
 
-    net_crypto_key_t server_public;
+        if ( hole_list == NULL )
+            return STORE_NONE;
 
-    net_thread_mutex_lock( thread );
-    if ( net_crypto_generate_keys( &server_public, &thread_context->crypto_server ) == enet_false ) {
-        net_thread_mutex_unlock( thread );
-        thread_init_client_exit( &buffer, thread_context, thread );
-        return;
+        store->hole_list = hole_list;
+        store->hole_capacity = capacity;
     }
-    net_thread_mutex_unlock( thread );
 
-    if ( 
-        net_buffer_io_write_uint64( &buffer_io, server_public.exponent ) == enet_false ||
-        net_buffer_io_write_uint64( &buffer_io, server_public.modulus ) == enet_false
-    ) {
-        thread_init_client_exit( &buffer, thread_context, thread );
-        return;
+    store->hole_list[ store->hole_count ].offset = offset;
+    store->hole_list[ store->hole_count ].size = size;
+
+    return store->hole_count++;
+}
+
+/**
+ * Turn the record of size bytes at offset into a hole, merged with its neighbours on
+ * disk then in the list. A hole closing the pack gives its space back to the end.
+ * Without room to track it the hole is only found again on the next start.
+ **/
+void store_free_record( const uint64_t offset, const uint32_t size ) {
+    server_store_t* store = &context->store;
+    const uint32_t index = store_add_hole( offset, size );
+    uint64_t hole_offset = offset;
+    uint32_t hole_size = size;
+
+    if ( index != STORE_NONE ) {
+        hole_offset = store->hole_list[ index ].offset;
+        hole_size = store->hole_list[ index ].size;
+
+        if ( hole_offset + hole_size == store->end ) {
+            store->hole_list[ index ] = store->hole_list[ --store->hole_count ];
+            store->end = hole_offset;
+
+            fflush( store->pack );
+
+            // Left in place when the pack can't shrink, its header keeps scans past it.
+            if ( ftruncate( fileno( store->pack ), (off_t)store->end ) == 0 )
+                return;
+        }
     }
-    
-    if ( net_socket_send( &thread_context->socket, &buffer ) == enet_false ) {
-        thread_init_client_exit( &buffer, thread_context, thread );
-        return;
+
+    // The merged header covers the records it swallowed, a scan never reads them.
+    store_chunk_t hole;
+
+    memset( &hole, 0x00, sizeof( store_chunk_t ) );
+
+    hole.stored_size = hole_size - (uint32_t)sizeof( store_chunk_t );
+    hole.flags = STORE_FLAG_FREE;
+
+    fseeko( store->pack, (off_t)hole_offset, SEEK_SET );
+    fwrite( &hole, sizeof( store_chunk_t ), 1, store->pack );
+    fflush( store->pack );
+}
+
+/**
+ * store_allocate function
+ * @note : Place a record of size bytes, in the first hole it fills or leaves room
+ * for a free record header in, otherwise at the end of the pack. The caller holds
+ * the lock.
+ * @return : Offset of the record.
+ **/
+uint64_t store_allocate( const uint32_t size ) {
+    server_store_t* store = &context->store;
+
+    for ( uint32_t i = 0; i < store->hole_count; i++ ) {
+        store_hole_t* hole = store->hole_list + i;
+
+        if ( hole->size != size && hole->size < size + sizeof( store_chunk_t ) )
+            continue;
+
+        const uint64_t offset = hole->offset;
+
+        // The rest stays a hole, its header written first so a scan never reads past it.
+        if ( hole->size > size ) {
+            store_chunk_t rest;
+            memset( &rest, 0x00, sizeof( store_chunk_t ) );
+
+            rest.stored_size = hole->size - size - (uint32_t)sizeof( store_chunk_t );
+            rest.flags = STORE_FLAG_FREE;
+
+            fseeko( store->pack, (off_t)( offset + size ), SEEK_SET );
+            fwrite( &rest, sizeof( store_chunk_t ), 1, store->pack );
+            fflush( store->pack );
+
+            hole->offset += size;
+            hole->size   -= size;
+        } else
+            (*hole) = store->hole_list[ --store->hole_count ];
+
+        return offset;
     }
-    
-    printf( 
-        "New Client [\n\tServer Private : { %lu - %lu }\n\tClient Public : { %lu - %lu }\n]\n", 
-        thread_context->crypto_server.exponent, thread_context->crypto_server.modulus, 
-        thread_context->crypto_client.exponent, thread_context->crypto_client.modulus
-    );
 
-    net_buffer_destroy( &buffer );
-    net_thread_set_status( thread, enet_thread_running );
+    const uint64_t offset = store->end;
+
+    store->end += size;
+
+    return offset;
 }
 
-enet_booleans net_send( 
-    net_thread_context_t* thread_context,
-    const net_buffer_t* buffer
-) {
-    net_buffer_t cypher_buffer;
-    memset( &cypher_buffer, 0x00, sizeof( cypher_buffer ) );
+enet_booleans store_insert( const store_chunk_t* chunk, const uint64_t offset ) {
+    server_store_t* store = &context->store;
 
-    net_crypto_encrypt( &thread_context->crypto_server, buffer, &cypher_buffer );
+    if ( store->item_count == store->item_capacity ) {
+        const uint32_t capacity = ( store->item_capacity > 0 ) ? store->item_capacity * 2 : STORE_SLOT_COUNT / 2;
+        store_item_t* item_list = realloc( store->item_list, capacity * sizeof( store_item_t ) );
 
-    enet_booleans result = net_socket_send( &thread_context->socket, &cypher_buffer );
+        if ( item_list == NULL )
+            return enet_false;
 
-    net_buffer_destroy( &cypher_buffer );
+        store->item_list = item_list;
+        store->item_capacity = capacity;
+    }
 
-    return result;
+    // Kept under three quarters full, the table doubles and every item is linked again.
+    if ( ( store->item_count + 1 ) * 4 > store->slot_count * 3 ) {
+        const uint32_t slot_count = ( store->slot_count > 0 ) ? store->slot_count * 2 : STORE_SLOT_COUNT;
+        uint32_t* slot_list = calloc( slot_count, sizeof( uint32_t ) );
+
+        if ( slot_list == NULL )
+            return enet_false;
+
+        free( store->slot_list );
+
+        store->slot_list = slot_list;
+        store->slot_count = slot_count;
+
+        for ( uint32_t i = 0; i < store->item_count; i++ )
+            store_link( i );
+    }
+
+    // Unreferenced chunks found on start get a whole lifetime, their upload may resume.
+    store->item_list[ store->item_count ].chunk = (*chunk);
+    store->item_list[ store->item_count ].offset = offset;
+    store->item_list[ store->item_count ].idle_time = (uint32_t)time( NULL );
+
+    store_link( store->item_count++ );
+
+    return enet_true;
 }
 
-enet_booleans net_send_status(
-    net_thread_context_t* thread_context,
-    const enet_command_t command
-) {
-    net_buffer_t buffer;
-    memset( &buffer, 0x00, sizeof( net_buffer_t ) );
+enet_booleans store_open( ) {
+    server_store_t* store = &context->store;
 
-    if ( net_buffer_create( &buffer, sizeof( uint32_t ) ) == enet_false )
+    if ( pthread_mutex_init( &store->mutex, NULL ) != 0 )
         return enet_false;
 
-    net_buffer_io_t buffer_io = net_buffer_io_acquire( &buffer, enet_buffer_io_write );
+    store->pack = fopen( STORE_FILE, "r+b" );
 
-    net_buffer_io_write_uint32( &buffer_io, command );
+    if ( store->pack == NULL )
+        store->pack = fopen( STORE_FILE, "w+b" );
 
-    enet_booleans result = net_send( thread_context, &buffer );
+    if ( store->pack == NULL )
+        return enet_false;
 
-    net_buffer_destroy( &buffer );
+    fseeko( store->pack, 0, SEEK_END );
 
-    return result;
+    const uint64_t pack_size = (uint64_t)ftello( store->pack );
+    store_chunk_t chunk;
+
+    rewind( store->pack );
+
+    // A record torn by a crash ends the scan, the next chunk is written over it.
+    while ( fread( &chunk, sizeof( store_chunk_t ), 1, store->pack ) == 1 ) {
+        const uint64_t next = store->end + sizeof( store_chunk_t ) + chunk.stored_size;
+
+        if ( next > pack_size )
+            break;
+
+        const enet_booleans is_loaded = ( chunk.flags & STORE_FLAG_FREE ) ?
+            ( store_add_hole( store->end, (uint32_t)( next - store->end ) ) != STORE_NONE ) :
+            store_insert( &chunk, store->end );
+
+        if ( is_loaded == enet_false )
+            break;
+
+        store->end = next;
+        fseeko( store->pack, (off_t)next, SEEK_SET );
+    }
+
+    store->sweep_time = (uint32_t)time( NULL );
+
+    printf( "> Chunk store ready with %u chunks and %u holes.\n", store->item_count, store->hole_count );
+
+    return enet_true;
 }
 
-void server_quit( net_thread_t* thread, net_thread_context_t* thread_context ) {
-    printf( "> Client %p : quit\n", &thread_context->socket );
-    
-    net_thread_mutex_lock( thread );
-    net_socket_destroy( &thread_context->socket );
-    net_thread_mutex_unlock( thread );
-    net_thread_set_status( thread, enet_thread_pending );
+void store_close( ) {
+    server_store_t* store = &context->store;
+
+    if ( store->pack != NULL )
+        fclose( store->pack );
+
+    pthread_mutex_destroy( &store->mutex );
+    free( store->item_list );
+    free( store->slot_list );
+    free( store->hole_list );
+    memset( store, 0x00, sizeof( server_store_t ) );
 }
 
-void server_lost_client( net_thread_t* thread, net_thread_context_t* thread_context ) {
-    printf( "> Client %p lost.\n", &thread_context->socket );
-    net_thread_set_status( thread, enet_thread_pending );
+/**
+ * Write the reference count of an item in place, the only field of a record that
+ * changes. The caller holds the lock.
+ **/
+void store_write_count( const store_item_t* item ) {
+    server_store_t* store = &context->store;
+
+    fseeko( store->pack, (off_t)( item->offset + offsetof( store_chunk_t, refcount ) ), SEEK_SET );
+    fwrite( &item->chunk.refcount, sizeof( uint32_t ), 1, store->pack );
+    fflush( store->pack );
 }
 
-void server_send(
-    net_thread_t* thread,
-    net_thread_context_t* thread_context,
-    net_buffer_io_t* client_input,
-    char* path
-) {
-    printf( "> Client %p : send\n", &thread_context->socket );
+/**
+ * store_acquire function
+ * @note : Take a reference on the chunk of the given hash, the caller holds the lock.
+ * @return : enet_false when the chunk isn't in the store.
+ **/
+enet_booleans store_acquire( const uint8_t* hash ) {
+    server_store_t* store = &context->store;
+    const uint32_t index = store_find( hash );
 
-    if ( path == NULL ) {
-        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false ) {
-            server_lost_client( thread, thread_context );
-            return;
-        }
+    if ( index == STORE_NONE )
+        return enet_false;
+
+    store_item_t* item = store->item_list + index;
+
+    item->chunk.refcount += 1;
+
+    store_write_count( item );
+
+    return enet_true;
+}
+
+/**
+ * store_reclaim function
+ * @note : Drop the chunk of the given index, its record becomes a hole. The last
+ * item takes its place in the index. The caller holds the lock.
+ **/
+void store_reclaim( const uint32_t index ) {
+    server_store_t* store = &context->store;
+    store_item_t* item = store->item_list + index;
+
+    store_free_record( item->offset, (uint32_t)sizeof( store_chunk_t ) + item->chunk.stored_size );
+    store_unlink( store_find_slot( item->chunk.hash ) );
+
+    const uint32_t last = --store->item_count;
+
+    if ( index != last ) {
+        store->slot_list[ store_find_slot( store->item_list[ last ].chunk.hash ) ] = index + 1;
+        (*item) = store->item_list[ last ];
     }
+}
 
-    net_file_t file;
-    memset( &file, 0x00, sizeof( net_file_t ) );
+/**
+ * store_release function
+ * @note : Drop a reference taken on the chunk of the given hash, the chunk is
+ * reclaimed with its last one. The caller holds the lock.
+ **/
+void store_release( const uint8_t* hash ) {
+    server_store_t* store = &context->store;
+    const uint32_t index = store_find( hash );
 
-    if ( net_file_open( &file, enet_buffer_io_read_write, (const char*)path ) == enet_false ) {
-        printf( "> Can't store local copy of receive file.\n" );
-        
-        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
-            printf( "> Client %p lost.\n", &thread_context->socket );
+    if ( index == STORE_NONE || store->item_list[ index ].chunk.refcount == 0 )
+        return;
+
+    store_item_t* item = store->item_list + index;
+
+    item->chunk.refcount -= 1;
+
+    if ( item->chunk.refcount > 0 )
+        store_write_count( item );
+    else
+        store_reclaim( index );
+}
+
+/**
+ * Release the chunks of a list flagged in held_map, every one when it is NULL. For
+ * the references of an entry that won't be written.
+ **/
+void store_release_list( const entry_chunk_t* chunk_list, const uint32_t count, const uint8_t* held_map ) {
+    server_store_t* store = &context->store;
 
+    pthread_mutex_lock( &store->mutex );
+
+    for ( uint32_t i = 0; i < count; i++ ) {
+        if ( held_map == NULL || ( held_map[ i / 8 ] & ( 1 << ( i % 8 ) ) ) )
+            store_release( chunk_list[ i ].hash );
+    }
+
+    pthread_mutex_unlock( &store->mutex );
+}
+
+/**
+ * Whether the chunk is stored, taking a reference on it when asked. Storing it again
+ * without reference restarts its lifetime, an upload sent anew keeps its parts. The
+ * caller holds the lock.
+ **/
+enet_booleans store_hold( const uint8_t* hash, const enet_booleans is_referenced ) {
+    if ( is_referenced == enet_true )
+        return store_acquire( hash );
+
+    const uint32_t index = store_find( hash );
+
+    if ( index == STORE_NONE )
+        return enet_false;
+
+    context->store.item_list[ index ].idle_time = (uint32_t)time( NULL );
+
+    return enet_true;
+}
+
+/**
+ * store_expire function
+ * @note : Reclaim the chunks stored ahead of an entry that never came, unreferenced
+ * for STORE_IDLE_LIFETIME seconds. Runs once per STORE_SWEEP_INTERVAL at most, the
+ * caller holds the lock.
+ **/
+void store_expire( ) {
+    server_store_t* store = &context->store;
+    const uint32_t now = (uint32_t)time( NULL );
+
+    if ( now - store->sweep_time < STORE_SWEEP_INTERVAL )
         return;
+
+    store->sweep_time = now;
+
+    // A reclaimed item is replaced by the last one, the same index is checked again.
+    for ( uint32_t i = 0; i < store->item_count; ) {
+        const store_item_t* item = store->item_list + i;
+
+        if ( item->chunk.refcount == 0 && now - item->idle_time >= STORE_IDLE_LIFETIME )
+            store_reclaim( i );
+        else
+            i += 1;
     }
+}
 
-    if ( file.size > 0 )
-        net_file_jump( &file, file.size );
+/**
+ * store_put function
+ * @note : Store a chunk of the given SHA-256, only a reference is taken when its
+ * content is already there. New chunks are LZ encoded when the server compresses
+ * and it pays off.
+ * @param is_referenced : False to store the chunk without taking a reference, for
+ * chunks uploaded ahead of the entry naming them.
+ **/
+enet_booleans store_put(
+    const uint8_t* data,
+    const uint32_t size,
+    const uint8_t* hash,
+    const enet_booleans is_referenced,
+    net_buffer_t* scratch
+) {
+    server_store_t* store = &context->store;
 
-    uint32_t name_length = 0;
-    net_buffer_io_read_uint32( client_input, &name_length );
+    pthread_mutex_lock( &store->mutex );
+    enet_booleans is_stored = store_hold( hash, is_referenced );
+    pthread_mutex_unlock( &store->mutex );
 
-    uint32_t content_length = 0;
-    net_buffer_io_read_uint32( client_input, &content_length );
+    if ( is_stored == enet_true )
+        return enet_true;
 
-    net_buffer_t name = net_buffer_reference( client_input->buffer, 3 * sizeof( uint32_t ) );
-    net_buffer_t content = net_buffer_reference( client_input->buffer, 3 * sizeof( uint32_t ) + name_length );
+    // Encoded outside the lock, another thread may store the same chunk meanwhile.
+    store_chunk_t chunk;
+    memset( &chunk, 0x00, sizeof( store_chunk_t ) );
+    memcpy( chunk.hash, hash, NET_SHA256_SIZE );
 
-    net_buffer_resize( &name, name_length );
-    net_buffer_resize( &content, content_length );
-    
-    fwrite( &name_length, sizeof( uint32_t ), 1, file.file );
-    net_file_write( &file, &name );
+    chunk.raw_size = size;
+    chunk.stored_size = size;
+    chunk.refcount = ( is_referenced == enet_true ) ? 1 : 0;
+    chunk.crc = net_crc32c( data, size );
+    scratch->size = 0;
 
-    fwrite( &content_length, sizeof( uint32_t ), 1, file.file );
-    net_file_write( &file, &content );
-    net_file_close( &file );
+    const uint8_t* stored = data;
+
+    if ( 
+        ( context->compression_modes & enet_compression_lz ) &&
+        net_lz_encode( data, size, scratch ) == enet_true 
+    ) {
+        chunk.flags |= STORE_FLAG_LZ;
+        chunk.stored_size = scratch->size;
+        stored = net_buffer_get_raw( scratch );
+    }
+
+    pthread_mutex_lock( &store->mutex );
+
+    is_stored = store_hold( hash, is_referenced );
+
+    if ( is_stored == enet_false ) {
+        store_expire( );
+
+        const uint32_t record_size = (uint32_t)sizeof( store_chunk_t ) + chunk.stored_size;
+        const uint64_t offset = store_allocate( record_size );
+
+        fseeko( store->pack, (off_t)offset, SEEK_SET );
+
+        is_stored = (
+            fwrite( &chunk, sizeof( store_chunk_t ), 1, store->pack ) == 1 &&
+            fwrite( stored, sizeof( uint8_t ), chunk.stored_size, store->pack ) == chunk.stored_size &&
+            fflush( store->pack ) == 0 &&
+            store_insert( &chunk, offset ) == enet_true
+        ) ? enet_true : enet_false;
+
+        // A partly written record must not be taken for a chunk on the next start.
+        if ( is_stored == enet_false )
+            store_free_record( offset, record_size );
+    }
+
+    pthread_mutex_unlock( &store->mutex );
+
+    return is_stored;
+}
+
+/**
+ * store_acquire_list function
+ * @note : Take a reference on every chunk of a list, only when all of them are
+ * stored with the expected size. Chunks flagged in held_map are already held.
+ * @param missing_map : Receive a bit per chunk of the list set when it is missing,
+ * may be NULL. Bits already set count as missing.
+ * @return : Count of missing chunks.
+ **/
+uint32_t store_acquire_list( 
+    const entry_chunk_t* chunk_list, 
+    const uint32_t count, 
+    const uint8_t* held_map, 
+    uint8_t* missing_map 
+) {
+    server_store_t* store = &context->store;
+    uint32_t missing_count = 0;
+
+    pthread_mutex_lock( &store->mutex );
+
+    for ( uint32_t i = 0; i < count; i++ ) {
+        if ( held_map != NULL && ( held_map[ i / 8 ] & ( 1 << ( i % 8 ) ) ) )
+            continue;
+
+        const uint32_t index = store_find( chunk_list[ i ].hash );
+
+        if ( 
+            ( missing_map == NULL || ( missing_map[ i / 8 ] & ( 1 << ( i % 8 ) ) ) == 0 ) &&
+            index != STORE_NONE && store->item_list[ index ].chunk.raw_size == chunk_list[ i ].size 
+        )
+            continue;
+
+        if ( missing_map != NULL )
+            missing_map[ i / 8 ] |= (uint8_t)( 1 << ( i % 8 ) );
+
+        missing_count += 1;
+    }
+
+    for ( uint32_t i = 0; missing_count == 0 && i < count; i++ ) {
+        if ( held_map == NULL || ( held_map[ i / 8 ] & ( 1 << ( i % 8 ) ) ) == 0 )
+            store_acquire( chunk_list[ i ].hash );
+    }
+
+    pthread_mutex_unlock( &store->mutex );
+
+    return missing_count;
+}
+
+/**
+ * store_read function
+ * @note : Read the stored bytes of a chunk into out, its header into chunk.
+ **/
+enet_booleans store_read( const uint8_t* hash, store_chunk_t* chunk, net_buffer_t* out ) {
+    server_store_t* store = &context->store;
+    enet_booleans result = enet_false;
+
+    pthread_mutex_lock( &store->mutex );
+
+    const uint32_t index = store_find( hash );
+
+    if ( index != STORE_NONE ) {
+        const store_item_t* item = store->item_list + index;
+
+        (*chunk) = item->chunk;
+        out->size = 0;
+
+        result = (
+            net_buffer_reserve( out, chunk->stored_size + 1 ) == enet_true &&
+            fseeko( store->pack, (off_t)( item->offset + sizeof( store_chunk_t ) ), SEEK_SET ) == 0 &&
+            fread( net_buffer_get_raw( out ), sizeof( uint8_t ), chunk->stored_size, store->pack ) == chunk->stored_size
+        ) ? enet_true : enet_false;
+
+        if ( result == enet_true )
+            out->size = chunk->stored_size;
+    }
+
+    pthread_mutex_unlock( &store->mutex );
+
+    return result;
+}
+
+/**
+ * store_load function
+ * @note : Read the content of a chunk into dst, raw_size bytes decoded.
+ **/
+enet_booleans store_load(
+    const uint8_t* hash,
+    const uint32_t raw_size,
+    uint8_t* dst,
+    net_buffer_t* scratch
+) {
+    store_chunk_t chunk;
+
+    if ( store_read( hash, &chunk, scratch ) == enet_false || chunk.raw_size != raw_size )
+        return enet_false;
+
+    if ( ( chunk.flags & STORE_FLAG_LZ ) == 0 ) {
+        memcpy( dst, net_buffer_get_raw( scratch ), raw_size );
+
+        return enet_true;
+    }
+
+    if ( net_lz_get_raw_size( net_buffer_get_raw( scratch ), scratch->size ) != raw_size )
+        return enet_false;
+
+    return net_lz_decode( net_buffer_get_raw( scratch ), scratch->size, dst );
+}
+
+/**
+ * store_checksum_list function
+ * @note : CRC32C of the content made of the chunks of a list, combined from the
+ * checksums in the index without reading the chunks.
+ * @return : enet_false when a chunk isn't stored with its listed size.
+ **/
+enet_booleans store_checksum_list( const entry_chunk_t* chunk_list, const uint32_t count, uint32_t* crc ) {
+    server_store_t* store = &context->store;
+    uint32_t i = 0;
+
+    (*crc) = 0;
+
+    pthread_mutex_lock( &store->mutex );
+
+    for ( ; i < count; i++ ) {
+        const uint32_t index = store_find( chunk_list[ i ].hash );
+
+        if ( index == STORE_NONE || store->item_list[ index ].chunk.raw_size != chunk_list[ i ].size )
+            break;
+
+        (*crc) = net_crc32c_combine( (*crc), store->item_list[ index ].chunk.crc, chunk_list[ i ].size );
+    }
+
+    pthread_mutex_unlock( &store->mutex );
+
+    return ( i == count ) ? enet_true : enet_false;
+}
+
+/**
+ * entry_meta_t struct
+ * @field crc CRC32C of the entry content.
+ * @field flags ENTRY_FLAG_* bits.
+ * @field size entry content size once decoded, set with ENTRY_FLAG_LZ or ENTRY_FLAG_CHUNKS.
+ * @field time write time in seconds since the epoch, 0 for records written before it.
+ **/
+typedef struct entry_meta_t {
+    uint32_t crc;
+    uint32_t flags;
+    uint32_t size;
+    uint32_t time;
+} entry_meta_t;
+
+/**
+ * entry_t struct, header of a user file record laid out as [ name_length ][ name ]
+ * [ meta_size ][ meta ][ content_length ][ content ]. ENTRY_META_FLAG is set in
+ * name_length when the meta block is present, records written before it existed
+ * go straight from name to content.
+ * @field name_length length of the entry name, terminal '\0' included.
+ * @field content_length length of the entry content.
+ * @field meta entry metadata.
+ * @field has_crc false until the checksum of a record without meta block is read
+ * from its content by entry_load_crc, meta.crc is 0 meanwhile.
+ **/
+typedef struct entry_t {
+    uint32_t name_length;
+    uint32_t content_length;
+    entry_meta_t meta;
+    enet_booleans has_crc;
+} entry_t;
+
+#define ENTRY_META_FLAG 0x80000000u
+#define ENTRY_CHUNK_SIZE 4096
+
+// The content is stored as its LZ encoding, see net_lz_encode.
+#define ENTRY_FLAG_LZ 0x01
+
+// The content is an entry_chunk_t list, the chunks are in the chunk store.
+#define ENTRY_FLAG_CHUNKS 0x02
+
+uint32_t entry_checksum( net_file_t* file, const uint32_t length ) {
+    uint8_t chunk[ ENTRY_CHUNK_SIZE ];
+    uint32_t crc = 0;
+    uint32_t offset = 0;
+
+    while ( offset < length ) {
+        uint32_t size = length - offset;
+
+        if ( size > ENTRY_CHUNK_SIZE )
+            size = ENTRY_CHUNK_SIZE;
+
+        if ( fread( chunk, sizeof( uint8_t ), size, file->file ) != size )
+            break;
+
+        crc = net_crc32c_update( crc, chunk, size );
+        offset += size;
+    }
+
+    fseek( file->file, -(long)offset, SEEK_CUR );
+
+    return crc;
+}
+
+/**
+ * Read the next record header and its name, leave file on the entry content.
+ **/
+enet_booleans entry_read( net_file_t* file, entry_t* entry, net_buffer_t* name ) {
+    uint32_t name_length = 0;
+
+    if ( fread( &name_length, sizeof( uint32_t ), 1, file->file ) == 0 )
+        return enet_false;
+
+    memset( entry, 0x00, sizeof( entry_t ) );
+    entry->name_length = name_length & ~ENTRY_META_FLAG;
+
+    if ( net_buffer_create( name, entry->name_length + 1 ) == enet_false )
+        return enet_false;
+
+    net_buffer_resize( name, entry->name_length );
+
+    if ( entry->name_length > 0 && net_file_read( file, name ) == enet_false )
+        return enet_false;
+
+    ((char*)name->data)[ entry->name_length ] = '\0';
+
+    if ( name_length & ENTRY_META_FLAG ) {
+        uint32_t meta_size = 0;
+
+        if ( fread( &meta_size, sizeof( uint32_t ), 1, file->file ) == 0 )
+            return enet_false;
+
+        const uint32_t size = meta_size < sizeof( entry_meta_t ) ? meta_size : (uint32_t)sizeof( entry_meta_t );
+
+        if ( fread( &entry->meta, size, 1, file->file ) == 0 && size > 0 )
+            return enet_false;
+
+        net_file_jump( file, meta_size - size );
+    }
+
+    if ( fread( &entry->content_length, sizeof( uint32_t ), 1, file->file ) == 0 )
+        return enet_false;
+
+    entry->has_crc = ( name_length & ENTRY_META_FLAG ) ? enet_true : enet_false;
+
+    return enet_true;
+}
+
+/**
+ * Read the checksum of a record without meta block from its content, the file stays
+ * on the content. Only done for the entries a request matches, scans skip them.
+ **/
+void entry_load_crc( net_file_t* file, entry_t* entry ) {
+    if ( entry->has_crc == enet_true )
+        return;
+
+    entry->meta.crc = entry_checksum( file, entry->content_length );
+    entry->has_crc  = enet_true;
+}
+
+void entry_skip( net_file_t* file, const entry_t* entry ) {
+    net_file_jump( file, entry->content_length );
+}
+
+/**
+ * Size of the entry content once decoded.
+ **/
+uint32_t entry_get_size( const entry_t* entry ) {
+    if ( entry->meta.flags & ( ENTRY_FLAG_LZ | ENTRY_FLAG_CHUNKS ) )
+        return entry->meta.size;
+
+    return entry->content_length;
+}
+
+/**
+ * Whether the entry is still the copy a validator describes, its decoded size and
+ * checksum are the entry version.
+ **/
+enet_booleans entry_is_unchanged( const entry_t* entry, const net_message_validator_t* validator ) {
+    return ( entry_get_size( entry ) == validator->size && entry->meta.crc == validator->crc ) ? enet_true : enet_false;
+}
+
+/**
+ * Metadata of the entry whose record starts at offset in the user file.
+ **/
+net_message_stat_t entry_stat( const entry_t* entry, const uint32_t offset ) {
+    const net_message_stat_t info = { entry_get_size( entry ), entry->meta.crc, entry->meta.time, offset };
+
+    return info;
+}
+
+/**
+ * Read the chunk list of an ENTRY_FLAG_CHUNKS record the file is positioned on.
+ * @return : Allocated list of count items, NULL on failure.
+ **/
+entry_chunk_t* entry_read_chunks( net_file_t* file, const entry_t* entry, uint32_t* count ) {
+    (*count) = entry->content_length / sizeof( entry_chunk_t );
+
+    entry_chunk_t* chunk_list = malloc( ( (*count) > 0 ) ? entry->content_length : 1 );
+
+    if ( chunk_list == NULL )
+        return NULL;
+
+    if ( 
+        entry->content_length % sizeof( entry_chunk_t ) != 0 ||
+        fread( chunk_list, sizeof( entry_chunk_t ), (*count), file->file ) != (*count)
+    ) {
+        free( chunk_list );
+        return NULL;
+    }
+
+    return chunk_list;
+}
+
+/**
+ * entry_read_content function
+ * @note : Read length bytes from offset of the content the file is positioned on into
+ * dst, decoded. Chunked entries only load the chunks the range overlaps, the caller
+ * checks the range against entry_get_size.
+ **/
+enet_booleans entry_read_content( 
+    net_file_t* file, 
+    const entry_t* entry, 
+    const uint32_t offset,
+    const uint32_t length,
+    uint8_t* dst,
+    net_buffer_t* scratch
+) {
+    if ( entry->meta.flags & ENTRY_FLAG_CHUNKS ) {
+        uint32_t count = 0;
+        uint32_t position = 0;
+        uint32_t copied = 0;
+        uint8_t* partial = NULL;
+        entry_chunk_t* chunk_list = entry_read_chunks( file, entry, &count );
+
+        if ( chunk_list == NULL )
+            return enet_false;
+
+        for ( uint32_t i = 0; i < count && copied < length; i++ ) {
+            const uint32_t size = chunk_list[ i ].size;
+
+            if ( size > entry->meta.size - position )
+                break;
+
+            // Chunks fully in the range are decoded in place, the edges through partial.
+            if ( position + size > offset ) {
+                const uint32_t skip = ( offset > position ) ? offset - position : 0;
+                const uint32_t left = length - copied;
+                const uint32_t take = ( size - skip < left ) ? size - skip : left;
+
+                if ( skip == 0 && take == size ) {
+                    if ( store_load( chunk_list[ i ].hash, size, dst + copied, scratch ) == enet_false )
+                        break;
+                } else {
+                    if ( partial == NULL )
+                        partial = malloc( NET_CDC_MAX_SIZE );
+
+                    if ( 
+                        partial == NULL || size > NET_CDC_MAX_SIZE || 
+                        store_load( chunk_list[ i ].hash, size, partial, scratch ) == enet_false 
+                    )
+                        break;
+
+                    memcpy( dst + copied, partial + skip, take );
+                }
+
+                copied += take;
+            }
+
+            position += size;
+        }
+
+        free( partial );
+        free( chunk_list );
+
+        return ( copied == length ) ? enet_true : enet_false;
+    }
+
+    if ( ( entry->meta.flags & ENTRY_FLAG_LZ ) == 0 ) {
+        net_file_jump( file, offset );
+
+        return ( fread( dst, sizeof( uint8_t ), length, file->file ) == length ) ? enet_true : enet_false;
+    }
+
+    // Inline LZ is a single encoding, a partial range is decoded up to its end.
+    const enet_booleans is_whole = ( offset == 0 && length == entry->meta.size ) ? enet_true : enet_false;
+    uint8_t* encoded = malloc( entry->content_length );
+    net_lz_stream_t lz;
+
+    memset( &lz, 0x00, sizeof( net_lz_stream_t ) );
+
+    enet_booleans result = enet_false;
+
+    if ( 
+        encoded != NULL &&
+        fread( encoded, sizeof( uint8_t ), entry->content_length, file->file ) == entry->content_length &&
+        net_lz_get_raw_size( encoded, entry->content_length ) == entry->meta.size
+    ) {
+        if ( is_whole == enet_true )
+            result = net_lz_decode( encoded, entry->content_length, dst );
+        else if ( 
+            net_lz_stream_begin( &lz, encoded, entry->content_length ) == enet_true &&
+            net_lz_stream_skip( &lz, offset ) == enet_true
+        )
+            result = net_lz_stream_read( &lz, dst, length );
+    }
+
+    net_lz_stream_end( &lz );
+    free( encoded );
+
+    return result;
+}
+
+enet_booleans entry_write(
+    net_file_t* file,
+    const net_frame_str_t* name,
+    const entry_meta_t* meta,
+    const net_frame_blob_t* content
+) {
+    const uint32_t name_length = name->length | ENTRY_META_FLAG;
+    const uint32_t meta_size = (uint32_t)sizeof( entry_meta_t );
+
+    // Records are stamped as they are written, the time is part of the entry stat.
+    entry_meta_t stamped = *meta;
+    stamped.time = (uint32_t)time( NULL );
+
+    fwrite( &name_length, sizeof( uint32_t ), 1, file->file );
+    fwrite( name->data, sizeof( char ), name->length, file->file );
+    fwrite( &meta_size, sizeof( uint32_t ), 1, file->file );
+    fwrite( &stamped, sizeof( entry_meta_t ), 1, file->file );
+    fwrite( &content->size, sizeof( uint32_t ), 1, file->file );
+
+    return ( fwrite( content->data, sizeof( uint8_t ), content->size, file->file ) == content->size ) ? enet_true : enet_false;
+}
+
+enet_booleans entry_write_chunks(
+    net_file_t* file,
+    const net_frame_str_t* name,
+    const entry_meta_t* meta,
+    const entry_chunk_t* chunk_list,
+    const uint32_t count
+) {
+    const net_frame_blob_t list = { (const uint8_t*)chunk_list, count * (uint32_t)sizeof( entry_chunk_t ) };
+
+    return entry_write( file, name, meta, &list );
+}
+
+/**
+ * entry_store function
+ * @note : Split the content in content defined chunks kept in the chunk store, the
+ * record only holds the chunk list. Content already stored, under any name and for
+ * any user, is not written again.
+ * @param crc : Receive the CRC32C of the content.
+ **/
+enet_booleans entry_store(
+    net_file_t* file,
+    const net_frame_str_t* name,
+    const net_frame_blob_t* content,
+    net_buffer_t* scratch,
+    uint32_t* crc
+) {
+    entry_meta_t meta;
+    memset( &meta, 0x00, sizeof( entry_meta_t ) );
+
+    meta.crc   = net_crc32c( content->data, content->size );
+    meta.flags = ENTRY_FLAG_CHUNKS;
+    meta.size  = content->size;
+    (*crc)     = meta.crc;
+
+    const uint32_t max_count = content->size / NET_CDC_MIN_SIZE + 1;
+    entry_chunk_t* chunk_list = malloc( max_count * sizeof( entry_chunk_t ) );
+
+    if ( chunk_list == NULL )
+        return enet_false;
+
+    const uint8_t* data = (const uint8_t*)content->data;
+    uint32_t count = 0;
+    uint32_t offset = 0;
+
+    while ( offset < content->size ) {
+        entry_chunk_t* chunk = chunk_list + count;
+
+        chunk->size = net_cdc_cut( data + offset, content->size - offset );
+
+        net_sha256( data + offset, chunk->size, chunk->hash );
+
+        if ( store_put( data + offset, chunk->size, chunk->hash, enet_true, scratch ) == enet_false ) {
+            store_release_list( chunk_list, count, NULL );
+            free( chunk_list );
+            return enet_false;
+        }
+
+        offset += chunk->size;
+        count += 1;
+    }
+
+    const enet_booleans result = entry_write_chunks( file, name, &meta, chunk_list, count );
+
+    if ( result == enet_false )
+        store_release_list( chunk_list, count, NULL );
+
+    free( chunk_list );
+
+    return result;
+}
+
+enet_booleans chunk_set_has( const chunk_set_t* set, const uint8_t* hash ) {
+    static const uint8_t empty[ NET_SHA256_SIZE ] = { 0 };
+    uint32_t slot = 0;
+
+    if ( set->slot_count == 0 )
+        return enet_false;
+
+    memcpy( &slot, hash, sizeof( uint32_t ) );
+
+    for ( slot &= set->slot_count - 1; ; slot = ( slot + 1 ) & ( set->slot_count - 1 ) ) {
+        const uint8_t* item = set->slot_list + (size_t)slot * NET_SHA256_SIZE;
+
+        if ( memcmp( item, hash, NET_SHA256_SIZE ) == 0 )
+            return enet_true;
+
+        if ( memcmp( item, empty, NET_SHA256_SIZE ) == 0 )
+            return enet_false;
+    }
+}
+
+void chunk_set_link( chunk_set_t* set, const uint8_t* hash ) {
+    static const uint8_t empty[ NET_SHA256_SIZE ] = { 0 };
+    uint32_t slot = 0;
+
+    memcpy( &slot, hash, sizeof( uint32_t ) );
+
+    for ( slot &= set->slot_count - 1; ; slot = ( slot + 1 ) & ( set->slot_count - 1 ) ) {
+        uint8_t* item = set->slot_list + (size_t)slot * NET_SHA256_SIZE;
+
+        if ( memcmp( item, hash, NET_SHA256_SIZE ) == 0 )
+            return;
+
+        if ( memcmp( item, empty, NET_SHA256_SIZE ) == 0 ) {
+            memcpy( item, hash, NET_SHA256_SIZE );
+            set->count += 1;
+            return;
+        }
+    }
+}
+
+/**
+ * Add a hash to the set, kept under three quarters full like the store index.
+ **/
+enet_booleans chunk_set_add( chunk_set_t* set, const uint8_t* hash ) {
+    if ( ( set->count + 1 ) * 4 > set->slot_count * 3 ) {
+        const chunk_set_t previous = (*set);
+        const uint32_t slot_count = ( set->slot_count > 0 ) ? set->slot_count * 2 : STORE_SLOT_COUNT;
+        uint8_t* slot_list = calloc( slot_count, NET_SHA256_SIZE );
+
+        if ( slot_list == NULL )
+            return enet_false;
+
+        set->slot_list  = slot_list;
+        set->slot_count = slot_count;
+        set->count      = 0;
+
+        for ( uint32_t i = 0; i < previous.slot_count; i++ ) {
+            const uint8_t* item = previous.slot_list + (size_t)i * NET_SHA256_SIZE;
+
+            if ( chunk_set_has( &previous, item ) == enet_true )
+                chunk_set_link( set, item );
+        }
+
+        free( previous.slot_list );
+    }
+
+    chunk_set_link( set, hash );
+
+    return enet_true;
+}
+
+void user_own( server_user_t* user, const uint8_t* hash ) {
+    pthread_mutex_lock( &user->mutex );
+    chunk_set_add( &user->owned, hash );
+    pthread_mutex_unlock( &user->mutex );
+}
+
+/**
+ * Mark the chunks of a list flagged in held_map as owned by the user, every one
+ * when it is NULL. For chunks whose content the user uploaded.
+ **/
+void user_own_list( server_user_t* user, const entry_chunk_t* chunk_list, const uint32_t count, const uint8_t* held_map ) {
+    pthread_mutex_lock( &user->mutex );
+
+    for ( uint32_t i = 0; i < count; i++ ) {
+        if ( held_map == NULL || ( held_map[ i / 8 ] & ( 1 << ( i % 8 ) ) ) )
+            chunk_set_add( &user->owned, chunk_list[ i ].hash );
+    }
+
+    pthread_mutex_unlock( &user->mutex );
+}
+
+/**
+ * user_scan function
+ * @note : Add the chunks of the records appended to the user file since the last
+ * scan to the chunks the user owns. The file is read outside the lock, a scan
+ * running meanwhile only adds the same chunks.
+ **/
+void user_scan( server_user_t* user, const char* path ) {
+    net_file_t file;
+    memset( &file, 0x00, sizeof( net_file_t ) );
+
+    net_buffer_t name;
+    memset( &name, 0x00, sizeof( net_buffer_t ) );
+
+    pthread_mutex_lock( &user->mutex );
+    uint32_t offset = user->scanned;
+    pthread_mutex_unlock( &user->mutex );
+
+    if ( net_file_open( &file, enet_buffer_io_read, path ) == enet_false || file.size <= offset ) {
+        net_file_close( &file );
+        return;
+    }
+
+    net_file_jump( &file, offset );
+
+    entry_t entry;
+    entry_chunk_t* chunk_list = NULL;
+    uint32_t count = 0;
+
+    while ( entry_read( &file, &entry, &name ) == enet_true ) {
+        if ( entry.meta.flags & ENTRY_FLAG_CHUNKS ) {
+            // A record still being written ends the scan, the next one reads it again.
+            if ( ( chunk_list = entry_read_chunks( &file, &entry, &count ) ) == NULL )
+                break;
+
+            user_own_list( user, chunk_list, count, NULL );
+            free( chunk_list );
+        } else
+            entry_skip( &file, &entry );
+
+        offset = (uint32_t)ftell( file.file );
+    }
+
+    pthread_mutex_lock( &user->mutex );
+
+    if ( offset > user->scanned )
+        user->scanned = offset;
+
+    pthread_mutex_unlock( &user->mutex );
+
+    if ( net_buffer_is_valid( &name ) == enet_true )
+        net_buffer_destroy( &name );
+
+    net_file_close( &file );
+}
+
+/**
+ * user_mark_foreign function
+ * @note : Flag in missing_map the chunks of a list the user doesn't own, chunks in
+ * held_map were just uploaded. A chunk stored for another user is only linked once
+ * its content was sent, its hash alone would give its content away.
+ * @return : Count of chunks flagged.
+ **/
+uint32_t user_mark_foreign(
+    server_user_t* user,
+    const entry_chunk_t* chunk_list,
+    const uint32_t count,
+    const uint8_t* held_map,
+    uint8_t* missing_map
+) {
+    uint32_t foreign_count = 0;
+
+    pthread_mutex_lock( &user->mutex );
+
+    for ( uint32_t i = 0; i < count; i++ ) {
+        if ( 
+            ( held_map[ i / 8 ] & ( 1 << ( i % 8 ) ) ) == 0 && 
+            chunk_set_has( &user->owned, chunk_list[ i ].hash ) == enet_false 
+        ) {
+            missing_map[ i / 8 ] |= (uint8_t)( 1 << ( i % 8 ) );
+            foreign_count += 1;
+        }
+    }
+
+    pthread_mutex_unlock( &user->mutex );
+
+    return foreign_count;
+}
+
+/**
+ * bloom_header_t struct
+ * @note : Header of a user filter file, next to the user file with BLOOM_SUFFIX and
+ * followed by the filter bits. The filter holds every BLOOM_GRAM_SIZE bytes of the
+ * entry names, pulls match names by substring so a name is only absent when one of
+ * its grams is.
+ * @field magic : BLOOM_MAGIC.
+ * @field bit_count : Size of the filter in bits.
+ * @field item_count : Count of grams added.
+ * @field capacity : Count of grams the filter was sized for.
+ * @field covered : Size of the user file the filter describes, it is rebuilt when the
+ * user file doesn't have this size anymore, after a crash between the two writes.
+ **/
+typedef struct bloom_header_t {
+    uint32_t magic;
+    uint32_t bit_count;
+    uint32_t item_count;
+    uint32_t capacity;
+    uint32_t covered;
+} bloom_header_t;
+
+void bloom_get_path( const char* path, char* bloom_path, const size_t length ) {
+    snprintf( bloom_path, length, "%s%s", path, BLOOM_SUFFIX );
+}
+
+enet_booleans bloom_load( const char* path, net_bloom_t* bloom, uint32_t* covered ) {
+    char bloom_path[ 64 ];
+    bloom_get_path( path, bloom_path, sizeof( bloom_path ) );
+
+    FILE* file = fopen( bloom_path, "rb" );
+
+    if ( file == NULL )
+        return enet_false;
+
+    bloom_header_t header;
+    enet_booleans result = enet_false;
+
+    if ( 
+        fread( &header, sizeof( bloom_header_t ), 1, file ) == 1 &&
+        header.magic == BLOOM_MAGIC && header.bit_count > 0 && header.bit_count % 8 == 0
+    ) {
+        bloom->bit_count  = header.bit_count;
+        bloom->item_count = header.item_count;
+        bloom->capacity   = header.capacity;
+        bloom->bits       = malloc( header.bit_count / 8 );
+        (*covered)        = header.covered;
+
+        result = ( 
+            bloom->bits != NULL && 
+            fread( bloom->bits, sizeof( uint8_t ), header.bit_count / 8, file ) == header.bit_count / 8 
+        ) ? enet_true : enet_false;
+
+        if ( result == enet_false )
+            net_bloom_destroy( bloom );
+    }
+
+    fclose( file );
+
+    return result;
+}
+
+/**
+ * Write the filter aside then rename it over the previous one, a torn write would
+ * leave a filter missing names.
+ **/
+void bloom_save( const char* path, const net_bloom_t* bloom, const uint32_t covered ) {
+    char bloom_path[ 64 ];
+    char temp_path[ 72 ];
+
+    bloom_get_path( path, bloom_path, sizeof( bloom_path ) );
+    snprintf( temp_path, sizeof( temp_path ), "%s.tmp", bloom_path );
+
+    FILE* file = fopen( temp_path, "wb" );
+
+    if ( file == NULL )
+        return;
+
+    const bloom_header_t header = { BLOOM_MAGIC, bloom->bit_count, bloom->item_count, bloom->capacity, covered };
+
+    const enet_booleans is_written = (
+        fwrite( &header, sizeof( bloom_header_t ), 1, file ) == 1 &&
+        fwrite( bloom->bits, sizeof( uint8_t ), bloom->bit_count / 8, file ) == bloom->bit_count / 8
+    ) ? enet_true : enet_false;
+
+    if ( fclose( file ) != 0 || is_written == enet_false || rename( temp_path, bloom_path ) != 0 )
+        remove( temp_path );
+}
+
+uint32_t bloom_get_gram_count( const char* name ) {
+    const uint32_t length = (uint32_t)strlen( name );
+
+    return ( length >= BLOOM_GRAM_SIZE ) ? length - BLOOM_GRAM_SIZE + 1 : 0;
+}
+
+void bloom_add_name( net_bloom_t* bloom, const char* name ) {
+    const uint32_t count = bloom_get_gram_count( name );
+
+    for ( uint32_t i = 0; i < count; i++ )
+        net_bloom_add( bloom, name + i, BLOOM_GRAM_SIZE );
+}
+
+/**
+ * Whether an entry name may contain name, names shorter than a gram can't be told.
+ **/
+enet_booleans bloom_may_contain( const net_bloom_t* bloom, const char* name ) {
+    const uint32_t count = bloom_get_gram_count( name );
+
+    if ( count == 0 )
+        return enet_true;
+
+    for ( uint32_t i = 0; i < count; i++ ) {
+        if ( net_bloom_test( bloom, name + i, BLOOM_GRAM_SIZE ) == enet_false )
+            return enet_false;
+    }
+
+    return enet_true;
+}
+
+/**
+ * bloom_rebuild function
+ * @note : Build the filter of a user file from its entry names, sized for twice
+ * their grams so it takes as many new ones before the next rebuild.
+ * @param covered : Receive the size of the user file read.
+ **/
+enet_booleans bloom_rebuild( const char* path, net_bloom_t* bloom, uint32_t* covered ) {
+    net_file_t file;
+    memset( &file, 0x00, sizeof( net_file_t ) );
+
+    net_buffer_t name;
+    memset( &name, 0x00, sizeof( net_buffer_t ) );
+
+    (*covered) = 0;
+
+    if ( net_file_open( &file, enet_buffer_io_read, path ) == enet_false )
+        return net_bloom_create( bloom, BLOOM_MIN_CAPACITY );
+
+    entry_t entry;
+    uint32_t gram_count = 0;
+
+    while ( entry_read( &file, &entry, &name ) == enet_true ) {
+        gram_count += bloom_get_gram_count( (const char*)name.data );
+        entry_skip( &file, &entry );
+    }
+
+    const uint32_t capacity = ( 2 * gram_count > BLOOM_MIN_CAPACITY ) ? 2 * gram_count : BLOOM_MIN_CAPACITY;
+    enet_booleans result = net_bloom_create( bloom, capacity );
+
+    rewind( file.file );
+
+    while ( result == enet_true && entry_read( &file, &entry, &name ) == enet_true ) {
+        bloom_add_name( bloom, (const char*)name.data );
+        entry_skip( &file, &entry );
+    }
+
+    // Only the records read are covered, a torn tail makes the next check rebuild.
+    (*covered) = (uint32_t)ftell( file.file );
+
+    if ( net_buffer_is_valid( &name ) == enet_true )
+        net_buffer_destroy( &name );
+
+    net_file_close( &file );
+
+    return result;
+}
+
+/**
+ * bloom_is_ready function
+ * @note : Whether the filter of a user describes its whole file, under its lock.
+ **/
+enet_booleans bloom_is_ready( const server_user_t* user ) {
+    return ( 
+        user->is_bloom_loaded == enet_true && user->bloom.bits != NULL && user->bloom_covered >= user->bloom_end 
+    ) ? enet_true : enet_false;
+}
+
+/**
+ * Save the filter of a user when it changed, a stale one is left to the next rebuild.
+ * The caller holds the user lock.
+ **/
+void bloom_persist( const char* path, server_user_t* user ) {
+    if ( user->is_bloom_dirty == enet_false )
+        return;
+
+    user->is_bloom_dirty = enet_false;
+
+    if ( bloom_is_ready( user ) == enet_true )
+        bloom_save( path, &user->bloom, user->bloom_covered );
+}
+
+/**
+ * Mark the filter of a user changed. It is saved once dirty for BLOOM_SAVE_INTERVAL
+ * seconds or when the client leaves, a crash meanwhile only costs a rebuild since the
+ * saved filter doesn't cover the user file anymore. The caller holds the user lock.
+ **/
+void bloom_mark_dirty( const char* path, server_user_t* user ) {
+    const uint32_t now = (uint32_t)time( NULL );
+
+    if ( user->is_bloom_dirty == enet_false ) {
+        user->is_bloom_dirty = enet_true;
+        user->bloom_dirty_time = now;
+    } else if ( now - user->bloom_dirty_time >= BLOOM_SAVE_INTERVAL )
+        bloom_persist( path, user );
+}
+
+/**
+ * Save the filter of a user file if it changed, once its client is gone.
+ **/
+void bloom_flush( const char* path ) {
+    server_user_t* user = user_find( path );
+
+    if ( user == NULL )
+        return;
+
+    pthread_mutex_lock( &user->mutex );
+    bloom_persist( path, user );
+    pthread_mutex_unlock( &user->mutex );
+}
+
+/**
+ * bloom_is_absent function
+ * @note : Whether no entry of the user file can match name, without reading it. The
+ * filter is kept in memory, its file is read on first use and it is rebuilt when it
+ * doesn't describe the user file. Loads and rebuilds run outside the user lock, a
+ * lookup meanwhile can't tell and reads the file.
+ **/
+enet_booleans bloom_is_absent( const char* path, const char* name ) {
+    server_user_t* user = user_find( path );
+
+    if ( user == NULL )
+        return enet_false;
+
+    enet_booleans is_absent = enet_false;
+
+    pthread_mutex_lock( &user->mutex );
+
+    if ( bloom_is_ready( user ) == enet_true || user->is_bloom_building == enet_true ) {
+        if ( bloom_is_ready( user ) == enet_true )
+            is_absent = ( bloom_may_contain( &user->bloom, name ) == enet_true ) ? enet_false : enet_true;
+
+        pthread_mutex_unlock( &user->mutex );
+
+        return is_absent;
+    }
+
+    const enet_booleans is_first = ( user->is_bloom_loaded == enet_true ) ? enet_false : enet_true;
+
+    user->is_bloom_building = enet_true;
+
+    pthread_mutex_unlock( &user->mutex );
+
+    net_bloom_t bloom;
+    uint32_t covered = 0;
+    uint32_t end = 0;
+    enet_booleans is_built = enet_false;
+
+    memset( &bloom, 0x00, sizeof( net_bloom_t ) );
+
+    // Past the first lookup the size of the user file comes from bloom_update.
+    if ( is_first == enet_true ) {
+        struct stat st;
+
+        if ( stat( path, &st ) == 0 )
+            end = (uint32_t)st.st_size;
+
+        if ( bloom_load( path, &bloom, &covered ) == enet_true && covered != end )
+            net_bloom_destroy( &bloom );
+    }
+
+    if ( bloom.bits == NULL )
+        is_built = bloom_rebuild( path, &bloom, &covered );
+
+    pthread_mutex_lock( &user->mutex );
+
+    user->is_bloom_building = enet_false;
+    user->is_bloom_loaded   = enet_true;
+
+    if ( end > user->bloom_end )
+        user->bloom_end = end;
+
+    // Records appended during the rebuild make it stale, the next lookup starts over.
+    if ( bloom.bits != NULL && covered >= user->bloom_end ) {
+        net_bloom_destroy( &user->bloom );
+
+        user->bloom         = bloom;
+        user->bloom_covered = covered;
+
+        memset( &bloom, 0x00, sizeof( net_bloom_t ) );
+
+        if ( is_built == enet_true )
+            bloom_mark_dirty( path, user );
+
+        is_absent = ( bloom_may_contain( &user->bloom, name ) == enet_true ) ? enet_false : enet_true;
+    }
+
+    pthread_mutex_unlock( &user->mutex );
+
+    net_bloom_destroy( &bloom );
+
+    return is_absent;
+}
+
+/**
+ * bloom_update function
+ * @note : Add the names of records just appended to a user file. The filter must
+ * describe the file up to them, else it is left stale, as when it is full, and the
+ * next lookup rebuilds it. Only the bits in memory are set, the filter file is saved
+ * lazily, see bloom_mark_dirty.
+ * @param previous_size : Size of the user file before the records.
+ * @param size : Size of the user file after the records.
+ **/
+void bloom_update( 
+    const char* path, 
+    const uint32_t previous_size, 
+    const uint32_t size, 
+    const char** name_list, 
+    const uint32_t name_count 
+) {
+    server_user_t* user = user_find( path );
+    uint32_t gram_count = 0;
+
+    if ( user == NULL )
+        return;
+
+    for ( uint32_t i = 0; i < name_count; i++ )
+        gram_count += bloom_get_gram_count( name_list[ i ] );
+
+    pthread_mutex_lock( &user->mutex );
+
+    if ( size > user->bloom_end )
+        user->bloom_end = size;
+
+    if ( user->bloom.bits != NULL && user->bloom_covered >= previous_size ) {
+        if ( user->bloom.item_count + gram_count <= user->bloom.capacity ) {
+            for ( uint32_t i = 0; i < name_count; i++ )
+                bloom_add_name( &user->bloom, name_list[ i ] );
+
+            if ( size > user->bloom_covered )
+                user->bloom_covered = size;
+
+            bloom_mark_dirty( path, user );
+        } else
+            net_bloom_destroy( &user->bloom );
+    }
+
+    pthread_mutex_unlock( &user->mutex );
+}
+
+void parse_arguments(
+    int argc,
+    char** argv,
+    uint32_t* port,
+    uint32_t* thread_count,
+    uint32_t* crypto_seed,
+    uint32_t* crypto_modes,
+    uint32_t* crypto_bits,
+    uint32_t* crypto_workers,
+    uint32_t* ticket_lifetime,
+    uint32_t* caps_flags,
+    uint32_t* compression_modes
+) {
+    for ( int i = 0; i < argc; i++ ) {
+        if ( argv[ i ][ 0 ] != '-' )
+            continue;
+
+        switch ( tolower( argv[ i ][ 1 ] ) ) {
+            case 'p' : (*port) = parse_uint32( argv[ i ] + 2 ); break;
+            case 'c' : (*thread_count) = parse_uint32( argv[ i ] + 2 ); break;
+            case 's' : (*crypto_seed) = parse_uint32( argv[ i ] + 2 ); break;
+            case 'm' : (*crypto_modes) = parse_uint32( argv[ i ] + 2 ); break;
+            case 'k' : (*crypto_bits) = parse_uint32( argv[ i ] + 2 ); break;
+            case 'w' : (*crypto_workers) = parse_uint32( argv[ i ] + 2 ); break;
+            case 't' : (*ticket_lifetime) = parse_uint32( argv[ i ] + 2 ); break;
+            case 'f' : (*caps_flags) = parse_uint32( argv[ i ] + 2 ); break;
+            case 'z' : (*compression_modes) = parse_uint32( argv[ i ] + 2 ); break;
+
+            default : break;
+        }
+    }
+}
+
+void thread_init_client_exit(
+    net_buffer_t* buffer,
+    net_thread_context_t* thread_context,
+    net_thread_t* thread
+) {
+    net_crypto_key_pool_cancel( &context->key_pool, &thread_context->key_request );
+    net_buffer_destroy( buffer );
+    net_socket_destroy( &thread_context->socket );
+    net_thread_set_status( thread, enet_thread_pending );
+}
+
+enet_booleans thread_seal_secret(
+    net_thread_context_t* thread_context,
+    net_buffer_io_t* buffer_io
+) {
+    uint8_t secret[ NET_CRYPTO_SECRET_SIZE ];
+
+    net_crypto_random_bytes( secret, NET_CRYPTO_SECRET_SIZE );
+
+    net_buffer_t plain;
+    plain.length = NET_CRYPTO_SECRET_SIZE;
+    plain.size   = NET_CRYPTO_SECRET_SIZE;
+    plain.data   = secret;
+
+    net_buffer_t sealed;
+    memset( &sealed, 0x00, sizeof( net_buffer_t ) );
+
+    if ( net_crypto_encrypt( &thread_context->crypto.decrypt_key, &plain, &sealed ) == enet_false )
+        return enet_false;
+
+    const uint32_t size = buffer_io->buffer->size;
+
+    if ( net_buffer_create( buffer_io->buffer, size + sizeof( uint32_t ) + sealed.size ) == enet_false ) {
+        net_buffer_destroy( &sealed );
+        return enet_false;
+    }
+
+    net_buffer_resize( buffer_io->buffer, size );
+
+    if (
+        net_buffer_io_write_uint32( buffer_io, sealed.size ) == enet_false ||
+        net_buffer_io_write_raw( buffer_io, (const char*)sealed.data, sealed.size, NULL ) == enet_false
+    ) {
+        net_buffer_destroy( &sealed );
+        return enet_false;
+    }
+
+    net_buffer_destroy( &sealed );
+    net_crypto_session_start_stream( &thread_context->crypto, secret, enet_true );
+
+    return enet_true;
+}
+
+/**
+ * Append [ ticket_size ][ ticket ] to the handshake answer, a resumed session keeps
+ * its ticket, a new one is issued otherwise. Size is 0 when tickets are disabled or
+ * when the client can't store them.
+ **/
+enet_booleans thread_write_ticket(
+    net_thread_context_t* thread_context,
+    const net_crypto_key_t* server_public,
+    net_buffer_io_t* buffer_io,
+    const uint8_t* resumed_ticket,
+    const enet_booleans can_store
+) {
+    uint8_t ticket[ NET_CRYPTO_TICKET_SIZE ];
+    uint32_t ticket_size = 0;
+
+    if ( resumed_ticket != NULL ) {
+        memcpy( ticket, resumed_ticket, NET_CRYPTO_TICKET_SIZE );
+        ticket_size = NET_CRYPTO_TICKET_SIZE;
+    } else if ( can_store == enet_true && net_crypto_ticket_cache_is_enabled( &context->ticket_cache ) == enet_true ) {
+        net_crypto_ticket_cache_issue( 
+            &context->ticket_cache, server_public, &thread_context->crypto.encrypt_key, 
+            &thread_context->crypto.decrypt_key, ticket 
+        );
+        ticket_size = NET_CRYPTO_TICKET_SIZE;
+    }
+
+    if ( net_buffer_reserve( buffer_io->buffer, sizeof( uint32_t ) + ticket_size ) == enet_false )
+        return enet_false;
+
+    if ( net_buffer_io_write_uint32( buffer_io, ticket_size ) == enet_false )
+        return enet_false;
+
+    if ( ticket_size > 0 )
+        return net_buffer_io_write_raw( buffer_io, (const char*)ticket, ticket_size, NULL );
+
+    return enet_true;
+}
+
+/**
+ * Append the server caps block to the handshake answer and keep the common set.
+ **/
+enet_booleans thread_write_caps(
+    net_buffer_io_t* buffer_io,
+    const net_message_caps_t* client_caps,
+    net_message_caps_t* caps
+) {
+    const net_message_caps_t server_caps = { 
+        NET_FRAME_VERSION, context->caps_flags, NET_CAPS_MAX_FRAME, 
+        STREAM_CHUNK_SIZE, context->compression_modes, STREAM_CAPACITY 
+    };
+
+    (*caps) = net_caps_select( &server_caps, client_caps );
+
+    if ( net_message_caps_write( buffer_io->buffer, &server_caps ) == enet_false )
+        return enet_false;
+
+    buffer_io->head = buffer_io->buffer->size;
+
+    return enet_true;
+}
+
+void thread_init_client(
+    net_thread_t* thread,
+    net_thread_context_t* thread_context,
+    net_message_caps_t* caps
+) {
+    assert( thread != NULL );
+    assert( thread_context != NULL );
+
+    net_buffer_t buffer;
+    memset( &buffer, 0x00, sizeof( net_buffer_t ) );
+    
+    if ( net_buffer_create( &buffer, 2 * sizeof( uint64_t ) + sizeof( uint32_t ) ) == enet_false ) {
+        net_crypto_key_pool_cancel( &context->key_pool, &thread_context->key_request );
+        net_socket_destroy( &thread_context->socket );
+        net_thread_set_status( thread, enet_thread_pending );
+        return;
+    }
+
+    if ( net_socket_recv( &thread_context->socket, &buffer ) == enet_false ) {
+        thread_init_client_exit( &buffer, thread_context, thread );
+        return;
+    }
+
+    net_buffer_io_t buffer_io = net_buffer_io_acquire( &buffer, enet_buffer_io_read_write );
+    net_crypto_key_t* client_public = &thread_context->crypto.decrypt_key;
+    uint32_t client_modes = 0;
+    uint32_t ticket_size = 0;
+    uint8_t ticket[ NET_CRYPTO_TICKET_SIZE ];
+    enet_booleans has_ticket = enet_false;
+    enet_booleans can_store = enet_false;
+    net_message_caps_t client_caps;
+    enet_booleans has_caps = enet_false;
+
+    net_thread_mutex_lock( thread );
+    if ( 
+        net_buffer_io_read_uint64( &buffer_io, &client_public->exponent ) == enet_false ||
+        net_buffer_io_read_uint64( &buffer_io, &client_public->modulus ) == enet_false
+    ) {
+        net_thread_mutex_unlock( thread );
+        thread_init_client_exit( &buffer, thread_context, thread );
+        return;
+    }
+    net_thread_mutex_unlock( thread );
+
+    net_crypto_key_prepare( client_public );
+
+    // Legacy clients only send their public key, they stay on RSA-TOY blocks.
+    if ( net_buffer_io_is_eof( &buffer_io ) == enet_false )
+        net_buffer_io_read_uint32( &buffer_io, &client_modes );
+
+    // Clients able to store a ticket send its size, 0 when they have none yet.
+    if ( net_buffer_io_is_eof( &buffer_io ) == enet_false ) {
+        has_ticket = net_buffer_io_read_uint32( &buffer_io, &ticket_size );
+        can_store  = ( ticket_size != NET_CRYPTO_TICKET_NONE ) ? enet_true : enet_false;
+
+        if ( 
+            ticket_size != NET_CRYPTO_TICKET_SIZE ||
+            buffer_io.head + ticket_size > buffer.size ||
+            net_buffer_io_read_raw( &buffer_io, (char*)ticket, ticket_size, NULL ) == enet_false
+        )
+            ticket_size = 0;
+    }
+
+    // Clients knowing capabilities close the hello with their caps block.
+    has_caps = net_caps_read( &buffer_io, &client_caps );
+
+    net_buffer_io_reset( &buffer_io );
+
+    net_crypto_key_t server_public;
+    enet_booleans is_resumed = enet_false;
+
+    if ( ticket_size > 0 )
+        is_resumed = net_crypto_ticket_cache_resume( &context->ticket_cache, ticket, client_public, &server_public, &thread_context->crypto.encrypt_key );
+
+    // Key pair requested on accept, generated while the hello was in flight.
+    if ( is_resumed == enet_true )
+        net_crypto_key_pool_cancel( &context->key_pool, &thread_context->key_request );
+    else if ( 
+        net_crypto_key_pool_wait( 
+            &context->key_pool, &thread_context->key_request, 
+            &server_public, &thread_context->crypto.encrypt_key 
+        ) == enet_false
+    ) {
+        thread_init_client_exit( &buffer, thread_context, thread );
+        return;
+    }
+
+    if ( 
+        net_buffer_io_write_uint64( &buffer_io, server_public.exponent ) == enet_false ||
+        net_buffer_io_write_uint64( &buffer_io, server_public.modulus ) == enet_false
+    ) {
+        thread_init_client_exit( &buffer, thread_context, thread );
+        return;
+    }
+
+    if ( client_modes != 0 ) {
+        const enet_crypto_modes mode = net_crypto_session_select( context->crypto_modes, client_modes );
+
+        if ( net_buffer_io_write_uint32( &buffer_io, mode ) == enet_false ) {
+            thread_init_client_exit( &buffer, thread_context, thread );
+            return;
+        }
+
+        thread_context->crypto.mode = mode;
+
+        if ( mode == enet_crypto_chacha20 && thread_seal_secret( thread_context, &buffer_io ) == enet_false ) {
+            thread_init_client_exit( &buffer, thread_context, thread );
+            return;
+        }
+    }
+
+    if ( has_ticket == enet_true && thread_write_ticket( thread_context, &server_public, &buffer_io, is_resumed ? ticket : NULL, can_store ) == enet_false ) {
+        thread_init_client_exit( &buffer, thread_context, thread );
+        return;
+    }
+
+    (*caps) = net_caps_legacy( );
+
+    if ( has_caps == enet_true && thread_write_caps( &buffer_io, &client_caps, caps ) == enet_false ) {
+        thread_init_client_exit( &buffer, thread_context, thread );
+        return;
+    }
+
+    thread_context->compression = caps->compression;
+    
+    if ( net_socket_send( &thread_context->socket, &buffer ) == enet_false ) {
+        thread_init_client_exit( &buffer, thread_context, thread );
+        return;
+    }
+    
+    printf( 
+        "New Client [\n\tServer Private : { %lu - %lu }\n\tClient Public : { %lu - %lu }\n\tCipher : %s\n\tResumed : %s\n\tCaps : v%u flags %02x frame %u chunk %u compression %02x depth %u\n]\n", 
+        thread_context->crypto.encrypt_key.exponent, thread_context->crypto.encrypt_key.modulus, 
+        client_public->exponent, client_public->modulus,
+        net_crypto_session_get_name( &thread_context->crypto ),
+        is_resumed ? "yes" : "no",
+        caps->version, caps->flags, caps->max_frame, caps->chunk_size, caps->compression, caps->pipeline_depth
+    );
+
+    net_buffer_destroy( &buffer );
+    net_thread_set_status( thread, enet_thread_running );
+}
+
+uint64_t output_clock( ) {
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+}
+
+enet_booleans output_is_late( const net_thread_context_t* thread_context ) {
+    if ( thread_context->output_buffer.size == 0 )
+        return enet_false;
+
+    return ( output_clock( ) - thread_context->output_time >= OUTPUT_DEADLINE_US ) ? enet_true : enet_false;
+}
+
+enet_booleans output_flush( net_thread_context_t* thread_context ) {
+    return net_socket_flush( &thread_context->socket, &thread_context->output_buffer );
+}
+
+/**
+ * Replies are queued and leave together once the pass is over, OUTPUT_SIZE bytes are
+ * pending or the oldest one waited OUTPUT_DEADLINE_US. Bigger replies aren't worth
+ * the copy, they are sent right after the queued ones.
+ **/
+enet_booleans net_send( 
+    net_thread_context_t* thread_context,
+    const net_buffer_t* buffer
+) {
+    net_buffer_t* output = &thread_context->output_buffer;
+
+    // Compressed before encryption, the cipher then has less to go through.
+    if ( 
+        ( thread_context->compression & enet_compression_lz ) && 
+        net_frame_compress( buffer, &thread_context->compress_buffer ) == enet_true 
+    )
+        buffer = &thread_context->compress_buffer;
+
+    if ( buffer->size >= OUTPUT_SIZE ) {
+        if ( output_flush( thread_context ) == enet_false )
+            return enet_false;
+
+        return net_socket_send_encrypted( &thread_context->socket, &thread_context->crypto, buffer );
+    }
+
+    if ( output->size == 0 )
+        thread_context->output_time = output_clock( );
+
+    if ( net_socket_queue_encrypted( &thread_context->crypto, buffer, output ) == enet_false )
+        return enet_false;
+
+    if ( output->size >= OUTPUT_SIZE || output_is_late( thread_context ) == enet_true )
+        return output_flush( thread_context );
+
+    return enet_true;
+}
+
+enet_booleans net_send_status(
+    net_thread_context_t* thread_context,
+    const enet_command_t command
+) {
+    net_buffer_t buffer;
+    memset( &buffer, 0x00, sizeof( net_buffer_t ) );
+
+    if ( net_buffer_create( &buffer, NET_FRAME_HEADER_SIZE ) == enet_false )
+        return enet_false;
+
+    net_frame_encode( &buffer, net_frame_header( command, 0, thread_context->request_id ) );
+
+    enet_booleans result = net_send( thread_context, &buffer );
+
+    net_buffer_destroy( &buffer );
+
+    return result;
+}
+
+enet_booleans net_send_checksum(
+    net_thread_context_t* thread_context,
+    const uint32_t crc
+) {
+    net_buffer_t buffer;
+    memset( &buffer, 0x00, sizeof( net_buffer_t ) );
+
+    if ( net_buffer_create( &buffer, NET_FRAME_HEADER_SIZE + sizeof( uint32_t ) ) == enet_false )
+        return enet_false;
+
+    const net_message_checksum_t message = { crc };
+
+    enet_booleans result = (
+        net_message_checksum_encode( &buffer, net_frame_header( enet_command_ok, 0, thread_context->request_id ), &message ) == enet_true &&
+        net_send( thread_context, &buffer ) == enet_true
+    ) ? enet_true : enet_false;
+
+    net_buffer_destroy( &buffer );
+
+    return result;
+}
+
+/**
+ * stream_t struct
+ * @note : A streamed pull, sent as chunk frames interleaved with the other replies.
+ * @field id : Request id of the pull, echoed on every frame.
+ * @field path : User file the entry is read from.
+ * @field name : Requested entry name.
+ * @field file : User file positioned on the entry content once opened.
+ * @field is_open : True once the reply header has been sent.
+ * @field is_done : True once the last frame has been sent.
+ * @field remaining : Content bytes left to send.
+ * @field window : Bytes the client is still ready to receive.
+ * @field name_list : Sorted names of a pull_many, NULL for a single pull.
+ * @field found_list : Per name of name_list, set once its entry has been sent.
+ * @field name_count : Count of name_list.
+ * @field content : Decoded current chunk of a chunked entry.
+ * @field content_size : Size of content.
+ * @field content_offset : Bytes of content already sent.
+ * @field chunk_list : Chunk list of a chunked entry, NULL otherwise.
+ * @field chunk_count : Count of chunk_list.
+ * @field chunk_index : Next chunk of chunk_list to load.
+ * @field offset : First byte of the entry requested, 0 without a range.
+ * @field length : Bytes requested from offset, 0 up to the end.
+ * @field skip : Bytes to skip at the head of the next chunk loaded, where the range
+ * starts in it.
+ * @field has_validator : True when the pull carries a validator.
+ * @field validator : Copy the client has, not sent again while the entry matches it.
+ * @field encoded : LZ encoding of an inline LZ entry, NULL otherwise.
+ * @field lz : Decoder of encoded, its output goes straight in the chunk frames.
+ **/
+typedef struct stream_t {
+    uint32_t id;
+    const char* path;
+    char name[ STREAM_NAME_LENGTH ];
+    net_file_t file;
+    enet_booleans is_open;
+    enet_booleans is_done;
+    uint32_t remaining;
+    uint32_t window;
+    const char** name_list;
+    uint8_t* found_list;
+    uint32_t name_count;
+    uint8_t* content;
+    uint32_t content_size;
+    uint32_t content_offset;
+    entry_chunk_t* chunk_list;
+    uint32_t chunk_count;
+    uint32_t chunk_index;
+    uint32_t offset;
+    uint32_t length;
+    uint32_t skip;
+    enet_booleans has_validator;
+    net_message_validator_t validator;
+    uint8_t* encoded;
+    net_lz_stream_t lz;
+} stream_t;
+
+/**
+ * server_connection_t struct
+ * @note : Per client state owned by the worker thread.
+ * @field decypher_buffer : Buffer for incoming commands.
+ * @field chunk_buffer : Buffer for outgoing stream frames.
+ * @field path : Current user file, NULL until the client names itself.
+ * @field stream_list : Pending streams, only the first STREAM_ACTIVE_COUNT are served.
+ * @field stream_count : Count of pending streams.
+ * @field stream_next : Round robin cursor over the active streams.
+ * @field caps : Capabilities agreed with the client during the handshake.
+ * @field inflate_buffer : Buffer for the payload of compressed commands.
+ **/
+typedef struct server_connection_t {
+    net_buffer_t decypher_buffer;
+    net_buffer_t chunk_buffer;
+    char* path;
+    stream_t stream_list[ STREAM_CAPACITY ];
+    uint32_t stream_count;
+    uint32_t stream_next;
+    net_message_caps_t caps;
+    net_buffer_t inflate_buffer;
+} server_connection_t;
+
+void stream_remove( server_connection_t* connection, const uint32_t index ) {
+    stream_t* stream = connection->stream_list + index;
+
+    net_file_close( &stream->file );
+    free( stream->name_list );
+    free( stream->content );
+    free( stream->chunk_list );
+    free( stream->encoded );
+    net_lz_stream_end( &stream->lz );
+
+    connection->stream_count -= 1;
+
+    memmove( stream, stream + 1, ( connection->stream_count - index ) * sizeof( stream_t ) );
+}
+
+void stream_reset( server_connection_t* connection ) {
+    while ( connection->stream_count > 0 )
+        stream_remove( connection, connection->stream_count - 1 );
+
+    connection->stream_next = 0;
+}
+
+enet_booleans stream_is_ready( const stream_t* stream ) {
+    // Opening, or looking for the next entry of a pull_many, needs no window.
+    if ( stream->is_open == enet_false || stream->remaining == 0 )
+        return enet_true;
+
+    return ( stream->window > 0 ) ? enet_true : enet_false;
+}
+
+uint32_t stream_get_active_count( const server_connection_t* connection ) {
+    return ( connection->stream_count < STREAM_ACTIVE_COUNT ) ? connection->stream_count : STREAM_ACTIVE_COUNT;
+}
+
+enet_booleans stream_has_ready( const server_connection_t* connection ) {
+    const uint32_t active_count = stream_get_active_count( connection );
+
+    for ( uint32_t i = 0; i < active_count; i++ ) {
+        if ( stream_is_ready( connection->stream_list + i ) == enet_true )
+            return enet_true;
+    }
+
+    return enet_false;
+}
+
+enet_booleans stream_send_status(
+    net_thread_context_t* thread_context,
+    server_connection_t* connection,
+    stream_t* stream,
+    const enet_command_t command
+) {
+    // A failed stream is done, the client drops the request on this frame.
+    stream->is_open = enet_true;
+    stream->is_done = enet_true;
+    stream->remaining = 0;
+
+    if ( net_frame_encode( &connection->chunk_buffer, net_frame_header( command, 0, stream->id ) ) == enet_false )
+        return enet_false;
+
+    return net_send( thread_context, &connection->chunk_buffer );
+}
+
+/**
+ * stream_begin_entry function
+ * @note : Set the stream up for the requested range of the entry content the file is
+ * positioned on. Plain entries are read from the file as they go, chunked ones a
+ * chunk at a time starting with the one holding the range start, and LZ entries are
+ * decoded a frame at a time as the window allows.
+ **/
+enet_booleans stream_begin_entry(
+    stream_t* stream,
+    const entry_t* entry
+) {
+    const uint32_t size = entry_get_size( entry );
+
+    free( stream->chunk_list );
+    free( stream->encoded );
+    net_lz_stream_end( &stream->lz );
+
+    stream->chunk_list     = NULL;
+    stream->encoded        = NULL;
+    stream->chunk_count    = 0;
+    stream->chunk_index    = 0;
+    stream->content_size   = 0;
+    stream->content_offset = 0;
+    stream->skip           = 0;
+
+    if ( stream->offset > size ) {
+        printf( "> Range of stream %u starts past the entry end.\n", stream->id );
+        return enet_false;
+    }
+
+    stream->remaining = size - stream->offset;
+
+    if ( stream->length > 0 && stream->length < stream->remaining )
+        stream->remaining = stream->length;
+
+    if ( entry->meta.flags & ENTRY_FLAG_CHUNKS ) {
+        stream->chunk_list = entry_read_chunks( &stream->file, entry, &stream->chunk_count );
+
+        if ( stream->content == NULL )
+            stream->content = malloc( NET_CDC_MAX_SIZE );
+
+        if ( stream->chunk_list == NULL || stream->content == NULL ) {
+            printf( "> Can't read chunk list of stream %u.\n", stream->id );
+            return enet_false;
+        }
+
+        uint32_t position = 0;
+
+        while ( 
+            stream->chunk_index < stream->chunk_count && 
+            position + stream->chunk_list[ stream->chunk_index ].size <= stream->offset 
+        )
+            position += stream->chunk_list[ stream->chunk_index++ ].size;
+
+        stream->skip = stream->offset - position;
+
+        return enet_true;
+    }
+
+    free( stream->content );
+    stream->content = NULL;
+
+    if ( ( entry->meta.flags & ENTRY_FLAG_LZ ) == 0 ) {
+        net_file_jump( &stream->file, stream->offset );
+        return enet_true;
+    }
+
+    // Only the encoding stays in memory, the content is decoded as frames go out.
+    stream->encoded = malloc( entry->content_length );
+
+    if ( 
+        stream->encoded == NULL ||
+        fread( stream->encoded, sizeof( uint8_t ), entry->content_length, stream->file.file ) != entry->content_length ||
+        net_lz_get_raw_size( stream->encoded, entry->content_length ) != size ||
+        net_lz_stream_begin( &stream->lz, stream->encoded, entry->content_length ) == enet_false ||
+        net_lz_stream_skip( &stream->lz, stream->offset ) == enet_false
+    ) {
+        printf( "> Can't decode entry of stream %u.\n", stream->id );
+        return enet_false;
+    }
+
+    return enet_true;
+}
+
+enet_booleans stream_open(
+    net_thread_context_t* thread_context,
+    server_connection_t* connection,
+    stream_t* stream
+) {
+    memset( &stream->file, 0x00, sizeof( net_file_t ) );
+
+    if ( bloom_is_absent( stream->path, stream->name ) == enet_true ) {
+        printf( "> No file %s for client.\n", stream->name );
+
+        return stream_send_status( thread_context, connection, stream, enet_command_bad );
+    }
+
+    if ( net_file_open( &stream->file, enet_buffer_io_read, stream->path ) == enet_false ) {
+        printf( "> Can't open client file.\n" );
+
+        return stream_send_status( thread_context, connection, stream, enet_command_bad );
+    }
+
+    entry_t entry;
+    while ( entry_read( &stream->file, &entry, &connection->chunk_buffer ) == enet_true ) {
+        if ( net_buffer_contain( &connection->chunk_buffer, stream->name ) == enet_true ) {
+            stream->is_open = enet_true;
+
+            entry_load_crc( &stream->file, &entry );
+
+            if ( stream->has_validator == enet_true && entry_is_unchanged( &entry, &stream->validator ) == enet_true ) {
+                net_file_close( &stream->file );
+
+                return stream_send_status( thread_context, connection, stream, enet_command_not_modified );
+            }
+
+            if ( stream_begin_entry( stream, &entry ) == enet_false )
+                return stream_send_status( thread_context, connection, stream, enet_command_bad );
+
+            const net_message_stream_t message = { stream->remaining, entry.meta.crc };
+
+            if ( net_message_stream_encode( &connection->chunk_buffer, net_frame_header( enet_command_ok, 0, stream->id ), &message ) == enet_false )
+                return enet_false;
+
+            return net_send( thread_context, &connection->chunk_buffer );
+        }
+
+        entry_skip( &stream->file, &entry );
+    }
+
+    net_file_close( &stream->file );
+
+    return stream_send_status( thread_context, connection, stream, enet_command_bad );
+}
+
+/**
+ * stream_load_chunk function
+ * @note : Load the next chunk of a chunked entry. Chunks stored LZ encoded that fit
+ * a frame and the range go out as stored to clients speaking LZ, the rest is decoded
+ * in content.
+ * @return : enet_true with the stored encoding in scratch, or an empty scratch and
+ * the chunk in content.
+ **/
+enet_booleans stream_load_chunk(
+    net_thread_context_t* thread_context,
+    server_connection_t* connection,
+    stream_t* stream,
+    net_buffer_t* scratch
+) {
+    if ( stream->chunk_index == stream->chunk_count )
+        return enet_false;
+
+    const entry_chunk_t* item = stream->chunk_list + stream->chunk_index++;
+    store_chunk_t chunk;
+
+    if ( 
+        item->size > NET_CDC_MAX_SIZE || item->size <= stream->skip ||
+        store_read( item->hash, &chunk, scratch ) == enet_false || 
+        chunk.raw_size != item->size 
+    )
+        return enet_false;
+
+    stream->content_size = item->size;
+    stream->content_offset = stream->skip;
+
+    if ( ( chunk.flags & STORE_FLAG_LZ ) == 0 ) {
+        memcpy( stream->content, net_buffer_get_raw( scratch ), item->size );
+        stream->skip = 0;
+        scratch->size = 0;
+
+        return enet_true;
+    }
+
+    if ( net_lz_get_raw_size( net_buffer_get_raw( scratch ), scratch->size ) != item->size )
+        return enet_false;
+
+    // The client decodes a stored chunk whole, it must lie entirely in the range.
+    if ( 
+        ( thread_context->compression & enet_compression_lz ) && 
+        chunk.stored_size <= connection->caps.chunk_size &&
+        stream->skip == 0 && item->size <= stream->remaining
+    ) {
+        stream->content_size = 0;
+        stream->content_offset = 0;
+
+        return enet_true;
+    }
+
+    if ( net_lz_decode( net_buffer_get_raw( scratch ), scratch->size, stream->content ) == enet_false )
+        return enet_false;
+
+    stream->skip = 0;
+    scratch->size = 0;
+
+    return enet_true;
+}
+
+enet_booleans stream_send_chunk(
+    net_thread_context_t* thread_context,
+    server_connection_t* connection,
+    stream_t* stream
+) {
+    net_buffer_t* scratch = &thread_context->compress_buffer;
+
+    scratch->size = 0;
+
+    if ( 
+        stream->chunk_list != NULL && 
+        stream->content_offset == stream->content_size &&
+        stream_load_chunk( thread_context, connection, stream, scratch ) == enet_false 
+    ) {
+        printf( "> Can't load chunk of stream %u.\n", stream->id );
+        return stream_send_status( thread_context, connection, stream, enet_command_bad );
+    }
+
+    // A stored encoding is sent whole, it may overrun the window by up to a chunk.
+    if ( scratch->size > 0 ) {
+        const net_message_chunk_t message = { { net_buffer_get_raw( scratch ), scratch->size } };
+        const uint32_t raw_size = net_lz_get_raw_size( message.content.data, message.content.size );
+
+        if ( net_message_chunk_encode( &connection->chunk_buffer, net_frame_header( enet_command_chunk, NET_FRAME_FLAG_ENCODED, stream->id ), &message ) == enet_false )
+            return stream_send_status( thread_context, connection, stream, enet_command_bad );
+
+        stream->remaining -= raw_size;
+        stream->window -= ( message.content.size < stream->window ) ? message.content.size : stream->window;
+
+        return net_send( thread_context, &connection->chunk_buffer );
+    }
+
+    const uint32_t chunk_size = connection->caps.chunk_size;
+    uint32_t length = ( stream->remaining < chunk_size ) ? stream->remaining : chunk_size;
+
+    if ( length > stream->window )
+        length = stream->window;
+
+    if ( stream->content != NULL && length > stream->content_size - stream->content_offset )
+        length = stream->content_size - stream->content_offset;
+
+    // The chunk is read from the user file straight into the frame.
+    const net_message_chunk_t message = { { NULL, length } };
+
+    if ( net_message_chunk_encode( &connection->chunk_buffer, net_frame_header( enet_command_chunk, 0, stream->id ), &message ) == enet_false )
+        return stream_send_status( thread_context, connection, stream, enet_command_bad );
+
+    uint8_t* out = net_buffer_get_raw( &connection->chunk_buffer ) + connection->chunk_buffer.size - length;
+
+    if ( stream->encoded != NULL ) {
+        if ( net_lz_stream_read( &stream->lz, out, length ) == enet_false )
+            return stream_send_status( thread_context, connection, stream, enet_command_bad );
+    } else if ( stream->content != NULL ) {
+        memcpy( out, stream->content + stream->content_offset, length );
+        stream->content_offset += length;
+    } else if ( fread( out, sizeof( uint8_t ), length, stream->file.file ) != length )
+        return stream_send_status( thread_context, connection, stream, enet_command_bad );
+
+    stream->remaining -= length;
+    stream->window -= length;
+
+    return net_send( thread_context, &connection->chunk_buffer );
+}
+
+int stream_compare_name( const void* left, const void* right ) {
+    return strcmp( *(const char* const*)left, *(const char* const*)right );
+}
+
+/**
+ * stream_create_many function
+ * @note : Copy the names of a pull_many payload, sorted without duplicates.
+ **/
+enet_booleans stream_create_many( stream_t* stream, net_frame_t* frame ) {
+    const uint32_t payload_size = (uint32_t)( frame->end - frame->head );
+    const uint32_t max_count = payload_size / ( sizeof( uint32_t ) + 1 );
+
+    // One block : name pointers, found flags then the payload copy they point in.
+    const size_t list_size = max_count * ( sizeof( const char* ) + sizeof( uint8_t ) );
+    uint8_t* block = malloc( list_size + payload_size + 1 );
+
+    if ( block == NULL )
+        return enet_false;
+
+    stream->name_list  = (const char**)block;
+    stream->found_list = block + max_count * sizeof( const char* );
+    stream->name_count = 0;
+
+    memcpy( block + list_size, frame->head, payload_size );
+
+    net_frame_t names = { frame->header, block + list_size, block + list_size + payload_size };
+
+    while ( names.head < names.end ) {
+        net_message_name_t message;
+
+        if ( net_message_name_decode( &names, &message ) == enet_false )
+            return enet_false;
+
+        stream->name_list[ stream->name_count++ ] = message.name.data;
+    }
+
+    qsort( stream->name_list, stream->name_count, sizeof( const char* ), stream_compare_name );
+
+    uint32_t count = 0;
+
+    for ( uint32_t i = 0; i < stream->name_count; i++ ) {
+        if ( count == 0 || strcmp( stream->name_list[ count - 1 ], stream->name_list[ i ] ) != 0 )
+            stream->name_list[ count++ ] = stream->name_list[ i ];
+    }
+
+    stream->name_count = count;
+    memset( stream->found_list, 0x00, count );
+
+    return enet_true;
+}
+
+/**
+ * stream_next_item function
+ * @note : Continue the single pass of a pull_many over the user file, sending the
+ * header of the next requested entry, or the missing names once the file is done.
+ **/
+enet_booleans stream_next_item(
+    net_thread_context_t* thread_context,
+    server_connection_t* connection,
+    stream_t* stream
+) {
+    if ( stream->is_open == enet_false ) {
+        memset( &stream->file, 0x00, sizeof( net_file_t ) );
+
+        stream->is_open = enet_true;
+
+        if ( net_file_open( &stream->file, enet_buffer_io_read, stream->path ) == enet_false )
+            printf( "> Can't open client file.\n" );
+    }
+
+    entry_t entry;
+    while ( net_file_is_valid( &stream->file ) == enet_true && entry_read( &stream->file, &entry, &connection->chunk_buffer ) == enet_true ) {
+        const char* name = (const char*)connection->chunk_buffer.data;
+        const char** match = bsearch( &name, stream->name_list, stream->name_count, sizeof( const char* ), stream_compare_name );
+
+        if ( match == NULL || stream->found_list[ match - stream->name_list ] ) {
+            entry_skip( &stream->file, &entry );
+            continue;
+        }
+
+        stream->found_list[ match - stream->name_list ] = 1;
+
+        entry_load_crc( &stream->file, &entry );
+
+        if ( stream_begin_entry( stream, &entry ) == enet_false )
+            return stream_send_status( thread_context, connection, stream, enet_command_bad );
+
+        const net_message_pull_item_t message = { net_frame_str( *match ), stream->remaining, entry.meta.crc };
+
+        if ( net_message_pull_item_encode( &connection->chunk_buffer, net_frame_header( enet_command_ok, 0, stream->id ), &message ) == enet_false )
+            return enet_false;
+
+        return net_send( thread_context, &connection->chunk_buffer );
+    }
+
+    stream->is_done = enet_true;
+
+    net_frame_encode( &connection->chunk_buffer, net_frame_header( enet_command_ok, NET_FRAME_FLAG_LAST, stream->id ) );
+
+    for ( uint32_t i = 0; i < stream->name_count; i++ ) {
+        const net_message_name_t message = { net_frame_str( stream->name_list[ i ] ) };
+
+        if ( stream->found_list[ i ] == 0 && net_message_name_write( &connection->chunk_buffer, &message ) == enet_false )
+            return enet_false;
+    }
+
+    net_frame_seal( &connection->chunk_buffer );
+
+    return net_send( thread_context, &connection->chunk_buffer );
+}
+
+/**
+ * stream_pump function
+ * @note : Advance the next ready active stream by one frame, round robin.
+ * @return : enet_false when the client is lost.
+ **/
+enet_booleans stream_pump(
+    net_thread_context_t* thread_context,
+    server_connection_t* connection
+) {
+    const uint32_t active_count = stream_get_active_count( connection );
+
+    for ( uint32_t i = 0; i < active_count; i++ ) {
+        const uint32_t index = ( connection->stream_next + i ) % active_count;
+        stream_t* stream = connection->stream_list + index;
+
+        if ( stream_is_ready( stream ) == enet_false )
+            continue;
+
+        enet_booleans result = enet_true;
+
+        if ( stream->name_list != NULL ) {
+            if ( stream->remaining == 0 )
+                result = stream_next_item( thread_context, connection, stream );
+            else
+                result = stream_send_chunk( thread_context, connection, stream );
+        } else if ( stream->is_open == enet_false )
+            result = stream_open( thread_context, connection, stream );
+        else
+            result = stream_send_chunk( thread_context, connection, stream );
+
+        connection->stream_next = index + 1;
+
+        if ( stream->is_done == enet_true || ( stream->name_list == NULL && stream->remaining == 0 ) ) {
+            stream_remove( connection, index );
+            connection->stream_next = index;
+        }
+
+        return result;
+    }
+
+    return enet_true;
+}
+
+void server_quit( net_thread_t* thread, net_thread_context_t* thread_context ) {
+    printf( "> Client %p : quit\n", &thread_context->socket );
+
+    output_flush( thread_context );
+    
+    net_thread_mutex_lock( thread );
+    net_socket_destroy( &thread_context->socket );
+    net_thread_mutex_unlock( thread );
+    net_thread_set_status( thread, enet_thread_pending );
+}
+
+void server_lost_client( net_thread_t* thread, net_thread_context_t* thread_context ) {
+    printf( "> Client %p lost.\n", &thread_context->socket );
+    net_thread_set_status( thread, enet_thread_pending );
+}
+
+void server_send(
+    net_thread_t* thread,
+    net_thread_context_t* thread_context,
+    net_frame_t* frame,
+    char* path
+) {
+    printf( "> Client %p : send\n", &thread_context->socket );
+
+    if ( path == NULL ) {
+        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    net_message_send_t message;
+
+    if ( net_message_send_decode( frame, &message ) == enet_false ) {
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    net_file_t file;
+    memset( &file, 0x00, sizeof( net_file_t ) );
+
+    if ( net_file_open( &file, enet_buffer_io_read_write, (const char*)path ) == enet_false ) {
+        printf( "> Can't store local copy of receive file.\n" );
+        
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            printf( "> Client %p lost.\n", &thread_context->socket );
+
+        return;
+    }
+
+    const uint32_t previous_size = file.size;
+
+    if ( file.size > 0 )
+        net_file_jump( &file, file.size );
+
+    uint32_t crc = 0;
+    const enet_booleans is_stored = entry_store( &file, &message.name, &message.content, &thread_context->compress_buffer, &crc );
+    const uint32_t size = (uint32_t)ftell( file.file );
+
+    net_file_close( &file );
+
+    if ( is_stored == enet_false ) {
+        printf( "> Can't store file %s.\n", message.name.data );
+
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    const char* name = (const char*)message.name.data;
+
+    bloom_update( path, previous_size, size, &name, 1 );
+
+    printf( "> File %s writing completed ( crc32c %08x ).\n", message.name.data, crc );
+
+    if ( net_send_checksum( thread_context, crc ) == enet_false )
+        server_lost_client( thread, thread_context );
+}
+
+void server_send_many(
+    net_thread_t* thread,
+    net_thread_context_t* thread_context,
+    net_frame_t* frame,
+    char* path
+) {
+    printf( "> Client %p : send_many\n", &thread_context->socket );
+
+    if ( path == NULL ) {
+        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    // Every item is checked before the first one is stored.
+    net_frame_t items = (*frame);
+    net_message_send_item_t message;
+    uint32_t count = 0;
+
+    while ( items.head < items.end ) {
+        if ( net_message_send_item_decode( &items, &message ) == enet_false ) {
+            if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+                server_lost_client( thread, thread_context );
+            return;
+        }
+
+        count += 1;
+    }
+
+    net_file_t file;
+    memset( &file, 0x00, sizeof( net_file_t ) );
+
+    net_buffer_t reply;
+    memset( &reply, 0x00, sizeof( net_buffer_t ) );
+
+    const char** name_list = (const char**)malloc( sizeof( const char* ) * ( count + 1 ) );
+
+    if ( 
+        name_list == NULL ||
+        net_buffer_create( &reply, NET_FRAME_HEADER_SIZE + count * 2 * sizeof( uint32_t ) ) == enet_false ||
+        net_file_open( &file, enet_buffer_io_read_write, (const char*)path ) == enet_false
+    ) {
+        printf( "> Can't store local copy of receive files.\n" );
+
+        if ( net_buffer_is_valid( &reply ) == enet_true )
+            net_buffer_destroy( &reply );
+
+        free( name_list );
+
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    const uint32_t previous_size = file.size;
+
+    if ( file.size > 0 )
+        net_file_jump( &file, file.size );
+
+    net_frame_encode( &reply, net_frame_header( enet_command_ok, 0, thread_context->request_id ) );
+
+    enet_booleans is_stored = enet_true;
+    uint32_t stored_count = 0;
+
+    while ( is_stored == enet_true && frame->head < frame->end ) {
+        net_message_send_item_decode( frame, &message );
+
+        uint32_t crc = 0;
+        is_stored = entry_store( &file, &message.name, &message.content, &thread_context->compress_buffer, &crc );
+
+        const net_message_list_entry_t entry = { crc, message.name };
+
+        net_message_list_entry_write( &reply, &entry );
+
+        if ( is_stored == enet_true )
+            name_list[ stored_count++ ] = (const char*)message.name.data;
+    }
+
+    const uint32_t size = (uint32_t)ftell( file.file );
+
+    net_file_close( &file );
+
+    // The names point into the frame, still valid until the reply is sent.
+    bloom_update( path, previous_size, size, name_list, stored_count );
+
+    free( name_list );
+
+    // The items stored before the failure stay, like a batch cut by a lost client.
+    if ( is_stored == enet_false )
+        net_frame_encode( &reply, net_frame_header( enet_command_bad, 0, thread_context->request_id ) );
+    else
+        net_frame_seal( &reply );
+
+    printf( "> %u files writing completed.\n", count );
+
+    if ( net_send( thread_context, &reply ) == enet_false )
+        server_lost_client( thread, thread_context );
+
+    net_buffer_destroy( &reply );
+}
+
+/**
+ * server_read_chunks function
+ * @note : Decode the chunk list following a send_hash head, chunk_ref messages or
+ * delta_item ones for a send_delta. Delta items carrying content are checked
+ * against their hash then stored, their bit is set in held_map.
+ * @return : Allocated list of count chunks, NULL for an invalid payload.
+ **/
+entry_chunk_t* server_read_chunks(
+    net_thread_context_t* thread_context,
+    net_frame_t* frame,
+    const net_message_send_hash_t* head,
+    const enet_booleans is_delta,
+    uint32_t* count,
+    uint8_t** held_map
+) {
+    const uint32_t max_count = (uint32_t)( frame->end - frame->head ) / ( 2 * sizeof( uint32_t ) + NET_SHA256_SIZE );
+    entry_chunk_t* chunk_list = malloc( ( max_count > 0 ) ? max_count * sizeof( entry_chunk_t ) : 1 );
+    uint64_t size = 0;
+
+    (*count) = 0;
+    (*held_map) = calloc( max_count / 8 + 1, sizeof( uint8_t ) );
+
+    if ( chunk_list == NULL || (*held_map) == NULL ) {
+        free( chunk_list );
+        return NULL;
+    }
+
+    while ( frame->head < frame->end ) {
+        net_message_delta_item_t item;
+        enet_booleans is_valid = enet_false;
+
+        memset( &item, 0x00, sizeof( net_message_delta_item_t ) );
+
+        if ( is_delta == enet_true )
+            is_valid = net_message_delta_item_decode( frame, &item );
+        else {
+            net_message_chunk_ref_t ref;
+
+            is_valid = net_message_chunk_ref_decode( frame, &ref );
+            item.hash = ref.hash;
+            item.size = ref.size;
+        }
+
+        if ( 
+            is_valid == enet_false || 
+            item.hash.size != NET_SHA256_SIZE || item.size == 0 || item.size > NET_CDC_MAX_SIZE ||
+            ( item.content.size > 0 && item.content.size != item.size )
+        )
+            break;
+
+        entry_chunk_t* chunk = chunk_list + (*count);
+
+        memcpy( chunk->hash, item.hash.data, NET_SHA256_SIZE );
+        chunk->size = item.size;
+
+        // The store is keyed by content, a chunk is only taken under the hash it has.
+        if ( item.content.size > 0 ) {
+            uint8_t hash[ NET_SHA256_SIZE ];
+
+            net_sha256( item.content.data, item.content.size, hash );
+
+            if ( 
+                memcmp( hash, chunk->hash, NET_SHA256_SIZE ) != 0 ||
+                store_put( item.content.data, item.content.size, hash, enet_true, &thread_context->compress_buffer ) == enet_false 
+            )
+                break;
+
+            (*held_map)[ (*count) / 8 ] |= (uint8_t)( 1 << ( (*count) % 8 ) );
+        }
+
+        size += item.size;
+        (*count) += 1;
+    }
+
+    if ( frame->head < frame->end || size != head->size ) {
+        store_release_list( chunk_list, (*count), *held_map );
+
+        free( chunk_list );
+        free( *held_map );
+
+        (*held_map) = NULL;
+
+        return NULL;
+    }
+
+    return chunk_list;
+}
+
+/**
+ * server_send_hash function
+ * @note : Store an entry from the chunk list of its content. For a send_hash the
+ * server answers missing with the chunks it lacks, the client then uploads only
+ * those with a send_delta.
+ **/
+void server_send_hash(
+    net_thread_t* thread,
+    net_thread_context_t* thread_context,
+    net_frame_t* frame,
+    char* path,
+    const enet_booleans is_delta
+) {
+    printf( "> Client %p : %s\n", &thread_context->socket, ( is_delta == enet_true ) ? "send_delta" : "send_hash" );
+
+    if ( path == NULL ) {
+        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    net_message_send_hash_t message;
+    entry_chunk_t* chunk_list = NULL;
+    uint8_t* held_map = NULL;
+    uint32_t count = 0;
+
+    if ( net_message_send_hash_decode( frame, &message ) == enet_true )
+        chunk_list = server_read_chunks( thread_context, frame, &message, is_delta, &count, &held_map );
+
+    if ( chunk_list == NULL ) {
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    server_user_t* user = user_find( path );
+    net_buffer_t* reply = &thread_context->compress_buffer;
+    const uint32_t map_size = ( count + 7 ) / 8;
+
+    reply->size = 0;
+
+    if ( user == NULL || net_buffer_reserve( reply, map_size + 1 ) == enet_false ) {
+        store_release_list( chunk_list, count, held_map );
+
+        free( chunk_list );
+        free( held_map );
+
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    uint8_t* missing_map = net_buffer_get_raw( reply );
+
+    memset( missing_map, 0x00, map_size );
+
+    // Chunks named by hash only are linked when the user already has them, others are
+    // missing even when stored for another user.
+    user_own_list( user, chunk_list, count, held_map );
+    user_scan( user, path );
+    user_mark_foreign( user, chunk_list, count, held_map, missing_map );
+
+    const uint32_t missing_count = store_acquire_list( chunk_list, count, held_map, missing_map );
+
+    // Chunks of a delta were just stored, none can be missing but for a broken client.
+    if ( missing_count > 0 ) {
+        store_release_list( chunk_list, count, held_map );
+
+        free( held_map );
+        free( chunk_list );
+
+        net_buffer_t buffer;
+        memset( &buffer, 0x00, sizeof( net_buffer_t ) );
+
+        const net_message_missing_t missing = { { missing_map, map_size } };
+        enet_booleans result = net_buffer_create( &buffer, NET_FRAME_HEADER_SIZE + map_size + 1 );
+
+        if ( is_delta == enet_true )
+            result = ( result == enet_true ) ? net_frame_encode( &buffer, net_frame_header( enet_command_bad, 0, thread_context->request_id ) ) : enet_false;
+        else if ( result == enet_true )
+            result = net_message_missing_encode( &buffer, net_frame_header( enet_command_missing, 0, thread_context->request_id ), &missing );
+
+        if ( result == enet_false || net_send( thread_context, &buffer ) == enet_false )
+            server_lost_client( thread, thread_context );
+
+        if ( net_buffer_is_valid( &buffer ) == enet_true )
+            net_buffer_destroy( &buffer );
+        return;
+    }
+
+    free( held_map );
+
+    net_file_t file;
+    memset( &file, 0x00, sizeof( net_file_t ) );
+
+    entry_meta_t meta;
+    memset( &meta, 0x00, sizeof( entry_meta_t ) );
+
+    meta.flags = ENTRY_FLAG_CHUNKS;
+    meta.size  = message.size;
+
+    // The checksum is taken from the stored chunks, the client one only has to match.
+    enet_booleans is_stored = store_checksum_list( chunk_list, count, &meta.crc );
+
+    if ( is_stored == enet_true && meta.crc != message.crc ) {
+        printf( "> Checksum of file %s doesn't match its chunks.\n", message.name.data );
+
+        is_stored = enet_false;
+    }
+
+    if ( is_stored == enet_true )
+        is_stored = net_file_open( &file, enet_buffer_io_read_write, (const char*)path );
+
+    uint32_t previous_size = 0;
+    uint32_t size = 0;
+
+    if ( is_stored == enet_true ) {
+        previous_size = file.size;
+
+        if ( file.size > 0 )
+            net_file_jump( &file, file.size );
+
+        is_stored = entry_write_chunks( &file, &message.name, &meta, chunk_list, count );
+        size = (uint32_t)ftell( file.file );
+        net_file_close( &file );
+    }
+
+    // Every chunk of the list is held once acquired, the entry was their reference.
+    if ( is_stored == enet_false )
+        store_release_list( chunk_list, count, NULL );
+
+    free( chunk_list );
+
+    if ( is_stored == enet_false ) {
+        printf( "> Can't store file %s.\n", message.name.data );
+
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    const char* name = (const char*)message.name.data;
+
+    bloom_update( path, previous_size, size, &name, 1 );
+
+    printf( "> File %s linked from %u chunks ( crc32c %08x ).\n", message.name.data, count, meta.crc );
+
+    if ( net_send_checksum( thread_context, meta.crc ) == enet_false )
+        server_lost_client( thread, thread_context );
+}
+
+/**
+ * server_put_chunks function
+ * @note : Store uploaded chunks ahead of the send_delta naming them, without taking
+ * a reference. A large upload goes in parts, the chunks of the parts received before
+ * a lost connection aren't missing anymore when the client sends the file again.
+ * Parts no entry ever names are reclaimed by store_expire.
+ **/
+void server_put_chunks(
+    net_thread_t* thread,
+    net_thread_context_t* thread_context,
+    net_frame_t* frame,
+    char* path
+) {
+    printf( "> Client %p : put_chunks\n", &thread_context->socket );
+
+    if ( path == NULL ) {
+        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    server_user_t* user = user_find( path );
+    uint32_t count = 0;
+
+    while ( user != NULL && frame->head < frame->end ) {
+        net_message_delta_item_t item;
+        uint8_t hash[ NET_SHA256_SIZE ];
+
+        if ( 
+            net_message_delta_item_decode( frame, &item ) == enet_false ||
+            item.hash.size != NET_SHA256_SIZE || item.size == 0 || item.size > NET_CDC_MAX_SIZE ||
+            item.content.size != item.size 
+        )
+            break;
+
+        net_sha256( item.content.data, item.content.size, hash );
+
+        if ( 
+            memcmp( hash, item.hash.data, NET_SHA256_SIZE ) != 0 ||
+            store_put( item.content.data, item.content.size, hash, enet_false, &thread_context->compress_buffer ) == enet_false 
+        )
+            break;
+
+        user_own( user, hash );
+        count += 1;
+    }
+
+    const enet_command_t status = ( user == NULL || frame->head < frame->end ) ? enet_command_bad : enet_command_ok;
 
-    printf( "> File %s writing completed.\n", (const char*)name.data );
+    printf( "> Stored %u chunks for client %p.\n", count, &thread_context->socket );
 
-    if ( net_send_status( thread_context, enet_command_ok ) == enet_false )
+    if ( net_send_status( thread_context, status ) == enet_false )
         server_lost_client( thread, thread_context );
 }
 
 void server_list(
     net_thread_t* thread,
     net_thread_context_t* thread_context,
+    net_frame_t* frame,
     char* path
 ) {
+    const enet_booleans has_stat = ( frame->header.flags & NET_FRAME_FLAG_STAT ) ? enet_true : enet_false;
+
     printf( "> Client %p : list\n", &thread_context->socket );
 
     if ( path == NULL ) {
-        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false ) {
+        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false )
             server_lost_client( thread, thread_context );
-            return;
-        }
+        return;
     }
 
     net_file_t file;
@@ -429,72 +3374,207 @@ void server_list(
         return;
     }
 
-    net_buffer_io_t buffer_io = net_buffer_io_acquire( &decypher_buffer, enet_buffer_io_write );
+    net_buffer_t name;
+    memset( &name, 0x00, sizeof( net_buffer_t ) );
 
-    uint32_t count = 0;
-    uint32_t total_length = 2 * (uint32_t)sizeof( uint32_t );
+    net_frame_encode( &decypher_buffer, net_frame_header( enet_command_ok, 0, thread_context->request_id ) );
 
-    net_buffer_resize( &decypher_buffer, total_length );
-    net_buffer_io_jump( &buffer_io, total_length );
+    entry_t entry;
+    uint32_t offset = 0;
 
-    uint32_t length = 0;
-    while ( fread( &length, sizeof( uint32_t ), 1, file.file ) ) {
-        if ( decypher_buffer.length < decypher_buffer.size + length + 2*(uint32_t)sizeof( uint32_t) ) {
-            if ( net_buffer_create( buffer_io.buffer, 2 * decypher_buffer.length ) == enet_false ) {
-                printf( "> Can't create entry list buffer.\n" );
+    // Records without meta block are listed with a 0 checksum, reading them all costs too much.
+    for ( ; entry_read( &file, &entry, &name ) == enet_true; offset = (uint32_t)ftell( file.file ) ) {
+        const net_message_list_entry_t message = { entry.meta.crc, net_frame_str( (const char*)name.data ) };
+        const net_message_stat_t info = entry_stat( &entry, offset );
 
-                net_file_close( &file );
+        if ( 
+            net_message_list_entry_write( &decypher_buffer, &message ) == enet_false ||
+            ( has_stat == enet_true && net_message_stat_write( &decypher_buffer, &info ) == enet_false )
+        ) {
+            printf( "> Can't create entry list buffer.\n" );
 
-                if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
-                    server_lost_client( thread, thread_context );
-                return;
-            }
+            net_buffer_destroy( &name );
+            net_buffer_destroy( &decypher_buffer );
+            net_file_close( &file );
+
+            if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+                server_lost_client( thread, thread_context );
+            return;
         }
 
-        net_buffer_io_write_uint32( &buffer_io, length );
-        net_buffer_resize( &decypher_buffer, decypher_buffer.size + length );
-        net_buffer_io_jump( &buffer_io, length );
+        entry_skip( &file, &entry );
+    }
 
-        total_length += (uint32_t)sizeof( uint32_t );
-        char* in = (char*)net_buffer_get_raw( &decypher_buffer ) + total_length;
+    net_buffer_destroy( &name );
+    net_frame_seal( &decypher_buffer );
+    net_file_close( &file );
 
-        fread( in, sizeof( char ), length, file.file );
-        in[ length ] = '\0';
+    if ( net_send( thread_context, &decypher_buffer ) == enet_false )
+        server_lost_client( thread, thread_context );
 
-        total_length += length;
+    net_buffer_destroy( &decypher_buffer );
+}
 
-        fread( &length, sizeof( uint32_t ), 1, file.file );
-        net_file_jump( &file, length );
+/**
+ * server_stat function
+ * @note : Answer the metadata of the entry a pull of the same name would return,
+ * without its content.
+ **/
+void server_stat(
+    net_thread_t* thread,
+    net_thread_context_t* thread_context,
+    net_frame_t* frame,
+    char* path
+) {
+    net_message_name_t message;
 
-        count += 1;
+    if ( net_message_name_decode( frame, &message ) == enet_false ) {
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
     }
 
-    net_buffer_io_reset( &buffer_io );
-    net_buffer_io_write_uint32( &buffer_io, (uint32_t)enet_command_ok );
-    net_buffer_io_write_uint32( &buffer_io, count );
-    net_buffer_resize( &decypher_buffer, total_length );
-    net_file_close( &file );
+    printf( "> Client %p : stat %s\n", &thread_context->socket, message.name.data );
 
-    if ( net_send( thread_context, &decypher_buffer ) == enet_false )
+    if ( path == NULL ) {
+        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    if ( bloom_is_absent( path, message.name.data ) == enet_true ) {
+        printf( "> No file %s for client %p.\n", message.name.data, &thread_context->socket );
+
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    net_file_t file;
+    memset( &file, 0x00, sizeof( net_file_t ) );
+
+    net_buffer_t name;
+    memset( &name, 0x00, sizeof( net_buffer_t ) );
+
+    enet_booleans is_found = enet_false;
+    net_message_stat_t info;
+
+    memset( &info, 0x00, sizeof( net_message_stat_t ) );
+
+    if ( net_file_open( &file, enet_buffer_io_read, path ) == enet_true ) {
+        entry_t entry;
+        uint32_t offset = 0;
+
+        for ( ; is_found == enet_false && entry_read( &file, &entry, &name ) == enet_true; offset = (uint32_t)ftell( file.file ) ) {
+            if ( net_buffer_contain( &name, message.name.data ) == enet_true ) {
+                entry_load_crc( &file, &entry );
+
+                info = entry_stat( &entry, offset );
+                is_found = enet_true;
+            } else
+                entry_skip( &file, &entry );
+        }
+
+        net_file_close( &file );
+    }
+
+    if ( net_buffer_is_valid( &name ) == enet_true )
+        net_buffer_destroy( &name );
+
+    if ( is_found == enet_false ) {
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    net_buffer_t buffer;
+    memset( &buffer, 0x00, sizeof( net_buffer_t ) );
+
+    const enet_booleans result = (
+        net_buffer_create( &buffer, NET_FRAME_HEADER_SIZE + net_message_stat_size( &info ) ) == enet_true &&
+        net_message_stat_encode( &buffer, net_frame_header( enet_command_ok, 0, thread_context->request_id ), &info ) == enet_true &&
+        net_send( thread_context, &buffer ) == enet_true
+    ) ? enet_true : enet_false;
+
+    if ( net_buffer_is_valid( &buffer ) == enet_true )
+        net_buffer_destroy( &buffer );
+
+    if ( result == enet_false )
         server_lost_client( thread, thread_context );
+}
 
-    net_buffer_destroy( &decypher_buffer );
+/**
+ * server_read_range function
+ * @note : Decode the range following a pull flagged NET_FRAME_FLAG_RANGE, the whole
+ * entry otherwise.
+ **/
+enet_booleans server_read_range( net_frame_t* frame, net_message_range_t* range ) {
+    memset( range, 0x00, sizeof( net_message_range_t ) );
+
+    if ( ( frame->header.flags & NET_FRAME_FLAG_RANGE ) == 0 )
+        return enet_true;
+
+    return net_message_range_decode( frame, range );
+}
+
+/**
+ * server_read_validator function
+ * @note : Decode the validator following the range of a pull flagged
+ * NET_FRAME_FLAG_VALIDATOR, has_validator is cleared otherwise.
+ **/
+enet_booleans server_read_validator( 
+    net_frame_t* frame, 
+    net_message_validator_t* validator, 
+    enet_booleans* has_validator 
+) {
+    memset( validator, 0x00, sizeof( net_message_validator_t ) );
+
+    (*has_validator) = ( frame->header.flags & NET_FRAME_FLAG_VALIDATOR ) ? enet_true : enet_false;
+
+    if ( (*has_validator) == enet_false )
+        return enet_true;
+
+    return net_message_validator_decode( frame, validator );
 }
 
 void server_pull(
     net_thread_t* thread,
     net_thread_context_t* thread_context,
-    net_buffer_io_t* client_input,
-    char* path
+    net_frame_t* frame,
+    server_connection_t* connection
 ) {
-    const char* name = (const char*)client_input->buffer->data + 2 * sizeof( uint32_t );
+    const char* path = connection->path;
+    net_message_pull_t message;
+    net_message_range_t range;
+    net_message_validator_t validator;
+    enet_booleans has_validator = enet_false;
+
+    if ( 
+        net_message_pull_decode( frame, &message ) == enet_false || 
+        server_read_range( frame, &range ) == enet_false ||
+        server_read_validator( frame, &validator, &has_validator ) == enet_false
+    ) {
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    const char* name = message.name.data;
     printf( "> Client %p : pull %s\n", &thread_context->socket, name );
 
     if ( path == NULL ) {
-        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false ) {
+        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false )
             server_lost_client( thread, thread_context );
-            return;
-        }
+        return;
+    }
+
+    // Unknown names are answered from the filter, without reading the user file.
+    if ( bloom_is_absent( path, name ) == enet_true ) {
+        printf( "> No file %s for client %p.\n", name, &thread_context->socket );
+
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
     }
 
     net_file_t file;
@@ -529,50 +3609,64 @@ void server_pull(
         return;
     }
 
-    net_buffer_io_t buffer_io = net_buffer_io_acquire( &decypher_buffer, enet_buffer_io_write );
-
-    uint32_t length = 0;
-    while ( fread( &length, sizeof( uint32_t ), 1, file.file ) ) {
-        if ( decypher_buffer.size + length > decypher_buffer.length ) {
-            if ( net_buffer_create( &decypher_buffer, 2 * decypher_buffer.length ) == enet_false ) {
-                printf( "> Can't create entry name buffer.\n" );
+    entry_t entry;
+    while ( entry_read( &file, &entry, &decypher_buffer ) == enet_true ) {
+        if ( net_buffer_contain( &decypher_buffer, name ) == enet_true ) {
+            entry_load_crc( &file, &entry );
 
+            if ( has_validator == enet_true && entry_is_unchanged( &entry, &validator ) == enet_true ) {
                 net_file_close( &file );
+                net_buffer_destroy( &decypher_buffer );
 
-                if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+                if ( net_send_status( thread_context, enet_command_not_modified ) == enet_false )
                     server_lost_client( thread, thread_context );
                 return;
             }
-        }
-        
-        net_buffer_resize( &decypher_buffer, length );
-        net_file_read( &file, &decypher_buffer );
 
-        fread( &length, sizeof( uint32_t ), 1, file.file );
+            const uint32_t entry_size = entry_get_size( &entry );
+            uint32_t size = ( range.offset < entry_size ) ? entry_size - range.offset : 0;
 
-        if ( net_buffer_contain( &decypher_buffer, name ) == enet_true ) {
-            const uint32_t total_length = 2 * (uint32_t)sizeof( uint32_t ) + length;
+            if ( range.length > 0 && range.length < size )
+                size = range.length;
 
-            if ( net_buffer_create( &decypher_buffer, total_length ) == enet_false ) {
-                printf( "> Can't create entry buffer.\n" );
+            const net_message_entry_t reply = { entry.meta.crc, { NULL, size } };
 
+            // Entries too big for a single frame can only be pulled as a stream.
+            if ( 
+                range.offset > entry_size ||
+                NET_FRAME_HEADER_SIZE + net_message_entry_size( &reply ) > connection->caps.max_frame 
+            ) {
                 net_file_close( &file );
+                net_buffer_destroy( &decypher_buffer );
 
                 if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
                     server_lost_client( thread, thread_context );
                 return;
             }
 
-            char* out = (char*)net_buffer_get_raw( &decypher_buffer ) + 2 * (uint32_t)sizeof( uint32_t );
+            if ( net_message_entry_encode( &decypher_buffer, net_frame_header( enet_command_ok, 0, thread_context->request_id ), &reply ) == enet_false ) {
+                printf( "> Can't create entry buffer.\n" );
+
+                net_file_close( &file );
+
+                if ( net_buffer_is_valid( &decypher_buffer ) == enet_true )
+                    net_buffer_destroy( &decypher_buffer );
+
+                if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+                    server_lost_client( thread, thread_context );
+                return;
+            }
 
-            fread( out, sizeof( uint8_t ), length, file.file );
+            uint8_t* out = net_buffer_get_raw( &decypher_buffer ) + decypher_buffer.size - size;
+            const enet_booleans is_read = entry_read_content( &file, &entry, range.offset, size, out, &thread_context->compress_buffer );
 
-            net_buffer_io_reset( &buffer_io );
-            net_buffer_io_write_uint32( &buffer_io, (uint32_t)enet_command_ok );
-            net_buffer_io_write_uint32( &buffer_io, length );
-            net_buffer_resize( &decypher_buffer, total_length );
             net_file_close( &file );
 
+            if ( is_read == enet_false ) {
+                printf( "> Can't read entry %s.\n", name );
+                net_frame_encode( &decypher_buffer, net_frame_header( enet_command_bad, 0, thread_context->request_id ) );
+            }
+
             if ( net_send( thread_context, &decypher_buffer ) == enet_false )
                 server_lost_client( thread, thread_context );
             
@@ -580,7 +3674,7 @@ void server_pull(
 
             return;
         } else
-            net_file_jump( &file, length );
+            entry_skip( &file, &entry );
     }
 
     net_file_close( &file );
@@ -594,21 +3688,19 @@ void server_pull(
 void server_name(
     net_thread_t* thread,
     net_thread_context_t* thread_context,
-    net_buffer_io_t* client_input,
+    net_frame_t* frame,
     char** path
 ) {
-    const char* name = (const char*)client_input->buffer->data + 2 * sizeof( uint32_t );
-    printf( "> Client %p : name %s\n", &thread_context->socket, name );
+    net_message_name_t message;
 
-    uint32_t length = 0;
-    net_buffer_io_read_uint32( client_input, &length );
-
-    if ( length == 0 ) {
-        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false ) {
+    if ( net_message_name_decode( frame, &message ) == enet_false || message.name.length < 2 ) {
+        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false )
             server_lost_client( thread, thread_context );
-            return;
-        }
+        return;
     }
+
+    const char* name = message.name.data;
+    printf( "> Client %p : name %s\n", &thread_context->socket, name );
     
     (*path) = acquire_user( name );
 
@@ -627,37 +3719,224 @@ void server_name(
     }
 }
 
+void server_pull_stream(
+    net_thread_t* thread,
+    net_thread_context_t* thread_context,
+    net_frame_t* frame,
+    server_connection_t* connection
+) {
+    net_message_pull_t message;
+    net_message_range_t range;
+    net_message_validator_t validator;
+    enet_booleans has_validator = enet_false;
+
+    if ( 
+        net_message_pull_decode( frame, &message ) == enet_false || 
+        server_read_range( frame, &range ) == enet_false ||
+        server_read_validator( frame, &validator, &has_validator ) == enet_false
+    ) {
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    const char* name = message.name.data;
+    printf( "> Client %p : pull %s (stream %u)\n", &thread_context->socket, name, thread_context->request_id );
+
+    if ( connection->path == NULL ) {
+        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    if ( connection->stream_count == STREAM_CAPACITY || message.name.length > STREAM_NAME_LENGTH ) {
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    stream_t* stream = connection->stream_list + connection->stream_count;
+    memset( stream, 0x00, sizeof( stream_t ) );
+
+    stream->id     = thread_context->request_id;
+    stream->path   = connection->path;
+    stream->window = message.window;
+    stream->offset = range.offset;
+    stream->length = range.length;
+    stream->has_validator = has_validator;
+    stream->validator = validator;
+    memcpy( stream->name, name, message.name.length );
+
+    connection->stream_count += 1;
+}
+
+void server_pull_many(
+    net_thread_t* thread,
+    net_thread_context_t* thread_context,
+    net_frame_t* frame,
+    server_connection_t* connection
+) {
+    printf( "> Client %p : pull_many (stream %u)\n", &thread_context->socket, thread_context->request_id );
+
+    if ( connection->path == NULL ) {
+        if ( net_send_status( thread_context, enet_command_bad_name ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    net_message_pull_many_t message;
+    stream_t* stream = connection->stream_list + connection->stream_count;
+
+    if ( connection->stream_count < STREAM_CAPACITY )
+        memset( stream, 0x00, sizeof( stream_t ) );
+
+    if ( 
+        connection->stream_count == STREAM_CAPACITY ||
+        net_message_pull_many_decode( frame, &message ) == enet_false ||
+        stream_create_many( stream, frame ) == enet_false
+    ) {
+        if ( connection->stream_count < STREAM_CAPACITY )
+            free( stream->name_list );
+
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    stream->id     = thread_context->request_id;
+    stream->path   = connection->path;
+    stream->window = message.window;
+
+    connection->stream_count += 1;
+}
+
+void server_window(
+    net_thread_context_t* thread_context,
+    net_frame_t* frame,
+    server_connection_t* connection
+) {
+    net_message_window_t message;
+
+    if ( net_message_window_decode( frame, &message ) == enet_false )
+        return;
+
+    for ( uint32_t i = 0; i < connection->stream_count; i++ ) {
+        stream_t* stream = connection->stream_list + i;
+
+        if ( stream->id != thread_context->request_id )
+            continue;
+
+        // A wrapped window would stall the stream, overflowing grants saturate it.
+        if ( message.increment > UINT32_MAX - stream->window ) {
+            printf( "> Client %p : window increment %u rejected.\n", &thread_context->socket, message.increment );
+
+            stream->window = UINT32_MAX;
+        } else
+            stream->window += message.increment;
+        break;
+    }
+}
+
 void thread_run_client(
     net_thread_t* thread,
     net_thread_context_t* thread_context,
-    net_buffer_t* cypher_buffer,
-    net_buffer_t* decypher_buffer,
-    char** path
+    server_connection_t* connection
 ) {
     assert( thread != NULL );
     assert( thread_context != NULL );
 
-    if ( net_socket_recv( &thread_context->socket, cypher_buffer ) == enet_false ) {
+    const enet_booleans has_ready = stream_has_ready( connection );
+    int has_input = 1;
+
+    if ( has_ready == enet_true || thread_context->output_buffer.size > 0 ) {
+        struct pollfd poll_fd = { .fd = thread_context->socket.descriptor, .events = POLLIN, .revents = 0 };
+
+        has_input = poll( &poll_fd, 1, 0 );
+    }
+
+    // The pass is over once nothing is left but waiting for the client, queued replies leave together.
+    if ( 
+        ( has_input == 0 && has_ready == enet_false ) || 
+        output_is_late( thread_context ) == enet_true
+    ) {
+        if ( output_flush( thread_context ) == enet_false ) {
+            server_lost_client( thread, thread_context );
+            return;
+        }
+    }
+
+    // Commands go first so small replies overtake pending chunks, streams advance when idle.
+    if ( has_input == 0 && has_ready == enet_true ) {
+        if ( stream_pump( thread_context, connection ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    net_buffer_t* decypher_buffer = &connection->decypher_buffer;
+
+    // Frames over the agreed limit drop the connection before their payload is read.
+    if ( net_socket_recv_decrypted( &thread_context->socket, &thread_context->crypto, decypher_buffer, connection->caps.max_frame ) == enet_false ) {
         net_socket_destroy( &thread_context->socket );
         net_thread_set_status( thread, enet_thread_pending );
         return;
     }
 
-    net_crypto_decrypt( &thread_context->crypto_client, cypher_buffer, decypher_buffer );
+    net_frame_t frame;
+
+    const enet_booleans is_valid = net_frame_decode( decypher_buffer, &frame );
+
+    // Replies echo the request id, the client matches them with its pending requests.
+    thread_context->request_id = frame.header.request_id;
+
+    if ( is_valid == enet_false ) {
+        printf( "> Client %p : invalid frame ( version %u ).\n", &thread_context->socket, frame.header.version );
+
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
+
+    if ( net_frame_inflate( &frame, &connection->inflate_buffer, connection->caps.max_frame ) == enet_false ) {
+        printf( "> Client %p : corrupted compressed frame.\n", &thread_context->socket );
+
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
 
-    net_buffer_io_t buffer_read = net_buffer_io_acquire( decypher_buffer, enet_buffer_io_read );
+    if ( NET_FRAME_HEADER_SIZE + frame.header.length > connection->caps.max_frame ) {
+        printf( "> Client %p : frame of %u bytes over the agreed limit.\n", &thread_context->socket, frame.header.length );
 
-    uint32_t cmd = 0;
-    net_buffer_io_read_uint32( &buffer_read, &cmd );
+        if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+            server_lost_client( thread, thread_context );
+        return;
+    }
 
-    switch ( cmd ) {
+    switch ( frame.header.command ) {
         case enet_command_quit : server_quit( thread, thread_context ); break;
-        case enet_command_send : server_send( thread, thread_context, &buffer_read, *path ); break;
-        case enet_command_list : server_list( thread, thread_context, *path ); break;
-        case enet_command_pull : server_pull( thread, thread_context, &buffer_read, *path ); break;
-        case enet_command_name : server_name( thread, thread_context, &buffer_read, path ); break;
+        case enet_command_send : server_send( thread, thread_context, &frame, connection->path ); break;
+        case enet_command_list : server_list( thread, thread_context, &frame, connection->path ); break;
+        case enet_command_name : server_name( thread, thread_context, &frame, &connection->path ); break;
+
+        case enet_command_pull : 
+            if ( frame.header.flags & NET_FRAME_FLAG_STREAM )
+                server_pull_stream( thread, thread_context, &frame, connection );
+            else
+                server_pull( thread, thread_context, &frame, connection );
+            break;
+
+        case enet_command_window : server_window( thread_context, &frame, connection ); break;
+        case enet_command_send_many : server_send_many( thread, thread_context, &frame, connection->path ); break;
+        case enet_command_pull_many : server_pull_many( thread, thread_context, &frame, connection ); break;
+        case enet_command_send_hash : server_send_hash( thread, thread_context, &frame, connection->path, enet_false ); break;
+        case enet_command_send_delta : server_send_hash( thread, thread_context, &frame, connection->path, enet_true ); break;
+        case enet_command_put_chunks : server_put_chunks( thread, thread_context, &frame, connection->path ); break;
+        case enet_command_stat : server_stat( thread, thread_context, &frame, connection->path ); break;
 
-        default : break;
+        default :
+            if ( net_send_status( thread_context, enet_command_bad ) == enet_false )
+                server_lost_client( thread, thread_context );
+            break;
     }
 }
 
@@ -665,24 +3944,38 @@ void* thread_loop( void* argument ) {
     const uint32_t buffer_length = (uint32_t)16 * sizeof( uint32_t );
     net_thread_t* thread = (net_thread_t*)argument;
 
-    net_buffer_t cypher_buffer;
-    memset( &cypher_buffer, 0x00, sizeof( net_buffer_t ) );
+    server_connection_t* connection = calloc( 1, sizeof( server_connection_t ) );
 
-    if ( net_buffer_create( &cypher_buffer, buffer_length ) == enet_false ) {
-        printf( "Fail to create default cypher buffer(%ub) for thread %p\n", buffer_length, thread );
+    if ( connection == NULL ) {
+        printf( "Fail to create connection state for thread %p\n", thread );
         return NULL;
     }
 
-    net_buffer_t decypher_buffer;
-    memset( &decypher_buffer, 0x00, sizeof( net_buffer_t ) );
-
-    if ( net_buffer_create( &decypher_buffer, buffer_length ) == enet_false ) {
+    if ( 
+        net_buffer_create( &connection->decypher_buffer, buffer_length ) == enet_false ||
+        net_buffer_create( &connection->chunk_buffer, buffer_length ) == enet_false ||
+        net_buffer_create( &thread->context.output_buffer, OUTPUT_SIZE ) == enet_false ||
+        net_buffer_create( &thread->context.compress_buffer, buffer_length ) == enet_false ||
+        net_buffer_create( &connection->inflate_buffer, buffer_length ) == enet_false
+    ) {
         printf( "Fail to create default cypher buffer(%ub) for thread %p\n", buffer_length, thread );
-        net_buffer_destroy( &cypher_buffer );
+
+        if ( net_buffer_is_valid( &connection->decypher_buffer ) == enet_true )
+            net_buffer_destroy( &connection->decypher_buffer );
+
+        if ( net_buffer_is_valid( &connection->chunk_buffer ) == enet_true )
+            net_buffer_destroy( &connection->chunk_buffer );
+
+        if ( net_buffer_is_valid( &thread->context.output_buffer ) == enet_true )
+            net_buffer_destroy( &thread->context.output_buffer );
+
+        if ( net_buffer_is_valid( &thread->context.compress_buffer ) == enet_true )
+            net_buffer_destroy( &thread->context.compress_buffer );
+
+        free( connection );
+
         return NULL;
     }
-    
-    char* path = NULL;
 
     while ( enet_true ) {
         enet_thread_status status = net_thread_get_status( thread );
@@ -691,15 +3984,34 @@ void* thread_loop( void* argument ) {
             break;
 
         if ( status == enet_thread_init ) {
-            path = NULL;
+            connection->path = NULL;
+            stream_reset( connection );
+
+            // Replies left by a lost client must not reach the next one.
+            thread->context.output_buffer.size = 0;
             
-            thread_init_client( thread, &thread->context );
-        } else if ( status == enet_thread_running )
-            thread_run_client( thread, &thread->context, &cypher_buffer, &decypher_buffer, &path );
+            thread_init_client( thread, &thread->context, &connection->caps );
+        } else if ( status == enet_thread_running ) {
+            thread_run_client( thread, &thread->context, connection );
+
+            // The filter changes of a client are saved once it is gone.
+            if ( net_thread_get_status( thread ) != enet_thread_running && connection->path != NULL ) {
+                bloom_flush( connection->path );
+                connection->path = NULL;
+            }
+        }
     }
 
-    net_buffer_destroy( &cypher_buffer );
-    net_buffer_destroy( &decypher_buffer );
+    if ( connection->path != NULL )
+        bloom_flush( connection->path );
+
+    stream_reset( connection );
+    net_buffer_destroy( &connection->inflate_buffer );
+    net_buffer_destroy( &thread->context.compress_buffer );
+    net_buffer_destroy( &thread->context.output_buffer );
+    net_buffer_destroy( &connection->chunk_buffer );
+    net_buffer_destroy( &connection->decypher_buffer );
+    free( connection );
 
     return NULL;
 }
@@ -722,20 +4034,57 @@ int main( int argc, char **argv ) {
     uint32_t port = LOCAL_PORT;
     uint32_t thread_count = TCP_MAX_CLIENT_COUNT;
     uint32_t crypto_seed = (uint32_t)time( NULL );
-
-    parse_arguments( argc, argv, &port, &thread_count, &crypto_seed );
+    uint32_t crypto_modes = enet_crypto_all;
+    uint32_t crypto_bits = 0;
+    uint32_t crypto_workers = net_crypto_get_default_workers( );
+    uint32_t ticket_lifetime = TICKET_LIFETIME;
+    uint32_t caps_flags = NET_CAPS_FLAG_ALL;
+    uint32_t compression_modes = enet_compression_all;
+
+    parse_arguments( 
+        argc, argv, &port, &thread_count, &crypto_seed, &crypto_modes, &crypto_bits, 
+        &crypto_workers, &ticket_lifetime, &caps_flags, &compression_modes 
+    );
 
     net_crypto_init_seed( crypto_seed );
+    net_crypto_init_key_size( crypto_bits );
+
+    if ( net_crypto_init_workers( crypto_workers ) == enet_false )
+        return -1;
     
     if ( load_db( ) == enet_false ) {
         printf( "> Can't load database.\n" );
         return -1;
     }
 
-    if ( net_socket_create_server( &socket, port, thread_count, enet_socket_tcp ) == enet_false )
+    if ( store_open( ) == enet_false ) {
+        printf( "> Can't open chunk store %s.\n", STORE_FILE );
+        return -1;
+    }
+
+    context->crypto_modes = crypto_modes;
+    context->caps_flags   = caps_flags;
+    context->compression_modes = compression_modes;
+
+    if ( net_crypto_key_pool_create( &context->key_pool, 2 * thread_count, KEY_POOL_THREAD_COUNT ) == enet_false )
+        return -1;
+
+    if ( net_crypto_ticket_cache_create( &context->ticket_cache, TICKET_CAPACITY, ticket_lifetime ) == enet_false ) {
+        net_crypto_key_pool_destroy( &context->key_pool );
+
+        return -1;
+    }
+
+    if ( net_socket_create_server( &socket, port, thread_count, enet_socket_tcp ) == enet_false ) {
+        net_crypto_ticket_cache_destroy( &context->ticket_cache );
+        net_crypto_key_pool_destroy( &context->key_pool );
+
         return -1;
+    }
 
     if ( net_thread_pool_create( &thread_pool, thread_count, thread_loop ) == enet_false ) {
+        net_crypto_ticket_cache_destroy( &context->ticket_cache );
+        net_crypto_key_pool_destroy( &context->key_pool );
         net_socket_destroy( &socket );
         
         return -1;
@@ -760,7 +4109,8 @@ int main( int argc, char **argv ) {
     while ( enet_true ) {
         if ( net_thread_pool_is_empty( &thread_pool ) == enet_true ) {
             printf( "s> " );
-            net_read_input( &input_buffer, enet_true );
+            if ( net_read_input( &input_buffer, enet_true ) == enet_false && feof( stdin ) )
+                break;
 
             if ( net_buffer_contain( &input_buffer, "quit" ) == enet_true )
                 break;
@@ -775,9 +4125,10 @@ int main( int argc, char **argv ) {
 
         net_thread_t* thread = net_thread_pool_acquire( &thread_pool );
 
-        if ( thread != NULL )
+        if ( thread != NULL ) {
+            net_crypto_key_pool_request( &context->key_pool, &thread->context.key_request );
             net_thread_start( thread, &client );
-        else {
+        } else {
             net_buffer_t response = net_buffer_immutable( "Connection refused by the server." );
             net_buffer_t buffer;
             memset( &buffer, 0x00, sizeof( net_buffer_t ) );
@@ -791,10 +4142,14 @@ int main( int argc, char **argv ) {
     }
 
     net_thread_pool_destroy( &thread_pool );
+    net_crypto_ticket_cache_destroy( &context->ticket_cache );
+    net_crypto_key_pool_destroy( &context->key_pool );
+    net_crypto_destroy_workers( );
 
     printf( "> Server closed with %u user stored\n", context->count );
 
     save_db( );
+    store_close( );
 
     return 0;
 }
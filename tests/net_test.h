@@ -0,0 +1,71 @@
+/************************************************************************************************
+ *
+ *  _   _      _                      _
+ * | \ | | ___| |___      _____  _ __| | __
+ * |  \| |/ _ \ __\ \ /\ / / _ \| '__| |/ /
+ * | |\  |  __/ |_ \ V  V / (_) | |  |   <
+ * |_| \_|\___|\__| \_/\_/ \___/|_|  |_|\_\
+ *
+ * @author ALVES Quentin
+ * @license MIT
+ *
+ ***********************************************************************************************/
+
+#ifndef _NET_TEST_H_
+#define _NET_TEST_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// TEST
+/////////////////////////////////////////////////////////////////////////////////////////////////
+static uint32_t net_test_count = 0;
+static uint32_t net_test_failures = 0;
+
+/**
+ * Check a condition, a failed one is reported with its location and the test goes on.
+ **/
+#define NET_TEST_CHECK( condition )                                                   \
+    do {                                                                              \
+        net_test_count += 1;                                                          \
+                                                                                      \
+        if ( !( condition ) ) {                                                       \
+            printf( "> %s:%d : %s failed.\n", __FILE__, __LINE__, #condition );       \
+            net_test_failures += 1;                                                   \
+        }                                                                             \
+    } while ( 0 )
+
+/**
+ * Parse a hexadecimal string into bytes, for the known answer vectors.
+ **/
+static inline size_t net_test_hex( const char* hex, uint8_t* bytes, const size_t capacity ) {
+    size_t count = 0;
+
+    for ( ; hex[ 0 ] != '\0' && hex[ 1 ] != '\0' && count < capacity; hex += 2 ) {
+        unsigned int value = 0;
+
+        if ( sscanf( hex, "%2x", &value ) != 1 )
+            break;
+
+        bytes[ count++ ] = (uint8_t)value;
+    }
+
+    return count;
+}
+
+/**
+ * Print the result of a test program.
+ * @return : Exit code of the test program, 0 when every check passed.
+ **/
+static inline int net_test_report( const char* name ) {
+    printf(
+        "> %s : %u checks, %u failed.\n",
+        name, net_test_count, net_test_failures
+    );
+
+    return ( net_test_failures == 0 ) ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,274 @@
+/************************************************************************************************
+ *
+ *  _   _      _                      _
+ * | \ | | ___| |___      _____  _ __| | __
+ * |  \| |/ _ \ __\ \ /\ / / _ \| '__| |/ /
+ * | |\  |  __/ |_ \ V  V / (_) | |  |   <
+ * |_| \_|\___|\__| \_/\_/ \___/|_|  |_|\_\
+ *
+ * @author ALVES Quentin
+ * @license MIT
+ *
+ ***********************************************************************************************/
+
+#include "../src/net_global.h"
+#include "../src/net_protocol.h"
+#include "net_test.h"
+
+net_buffer_t test_buffer( ) {
+    net_buffer_t buffer;
+
+    memset( &buffer, 0x00, sizeof( net_buffer_t ) );
+    net_buffer_create( &buffer, 16 );
+
+    return buffer;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// FRAME
+/////////////////////////////////////////////////////////////////////////////////////////////////
+void test_codec_header( ) {
+    net_buffer_t buffer = test_buffer( );
+    net_message_checksum_t checksum = { 0xA1B2C3D4 };
+
+    NET_TEST_CHECK( net_message_checksum_encode( &buffer, net_frame_header( enet_command_ok, NET_FRAME_FLAG_LAST, 0x01020304 ), &checksum ) == enet_true );
+    NET_TEST_CHECK( buffer.size == NET_FRAME_HEADER_SIZE + sizeof( uint32_t ) );
+
+    // Every field is big endian on the wire.
+    const uint8_t* raw = net_buffer_get_raw( &buffer );
+    const uint8_t expected[ NET_FRAME_HEADER_SIZE + 4 ] = {
+        0x4E, 0x57, NET_FRAME_VERSION, NET_FRAME_FLAG_LAST,
+        0x00, 0x00, 0x00, (uint8_t)enet_command_ok,
+        0x01, 0x02, 0x03, 0x04,
+        0x00, 0x00, 0x00, 0x04,
+        0xA1, 0xB2, 0xC3, 0xD4
+    };
+
+    NET_TEST_CHECK( memcmp( raw, expected, sizeof( expected ) ) == 0 );
+
+    net_frame_t frame;
+
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_true );
+    NET_TEST_CHECK( frame.header.command == enet_command_ok );
+    NET_TEST_CHECK( frame.header.flags == NET_FRAME_FLAG_LAST );
+    NET_TEST_CHECK( frame.header.request_id == 0x01020304 );
+    NET_TEST_CHECK( frame.header.length == sizeof( uint32_t ) );
+
+    // A header alone and a frame sealed once messages were appended.
+    NET_TEST_CHECK( net_frame_encode( &buffer, net_frame_header( enet_command_pull, 0, 7 ) ) == enet_true );
+    NET_TEST_CHECK( buffer.size == NET_FRAME_HEADER_SIZE );
+
+    net_message_window_t window = { 4096 };
+
+    NET_TEST_CHECK( net_message_window_write( &buffer, &window ) == enet_true );
+    NET_TEST_CHECK( net_message_window_write( &buffer, &window ) == enet_true );
+    net_frame_seal( &buffer );
+
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_true );
+    NET_TEST_CHECK( frame.header.length == 2 * sizeof( uint32_t ) );
+
+    net_buffer_destroy( &buffer );
+}
+
+void test_codec_rejects( ) {
+    net_buffer_t buffer = test_buffer( );
+    net_message_name_t name = { net_frame_str( "file.txt" ) };
+    net_frame_t frame;
+
+    NET_TEST_CHECK( net_message_name_encode( &buffer, net_frame_header( enet_command_pull, 0, 1 ), &name ) == enet_true );
+
+    uint8_t* raw = net_buffer_get_raw( &buffer );
+    const uint32_t size = buffer.size;
+
+    // Truncated header and payload.
+    buffer.size = NET_FRAME_HEADER_SIZE - 1;
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_false );
+
+    buffer.size = size - 1;
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_false );
+    buffer.size = size;
+
+    // Foreign magic and other protocol versions.
+    raw[ 0 ] ^= 0xFF;
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_false );
+    raw[ 0 ] ^= 0xFF;
+
+    raw[ 2 ] = NET_FRAME_VERSION + 1;
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_false );
+    raw[ 2 ] = NET_FRAME_VERSION;
+
+    // Strings must end with their zero inside the payload.
+    net_message_name_t decoded;
+
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_true );
+    NET_TEST_CHECK( net_message_name_decode( &frame, &decoded ) == enet_true );
+    NET_TEST_CHECK( strcmp( decoded.name.data, "file.txt" ) == 0 );
+
+    raw[ size - 1 ] = 'x';
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_true );
+    NET_TEST_CHECK( net_message_name_decode( &frame, &decoded ) == enet_false );
+
+    // A string length past the payload, then a zero length.
+    net_frame_put_u32( raw + NET_FRAME_HEADER_SIZE, 0xFFFFFFFF );
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_true );
+    NET_TEST_CHECK( net_message_name_decode( &frame, &decoded ) == enet_false );
+
+    net_frame_put_u32( raw + NET_FRAME_HEADER_SIZE, 0 );
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_true );
+    NET_TEST_CHECK( net_message_name_decode( &frame, &decoded ) == enet_false );
+
+    // Fixed fields past the end of the payload.
+    net_message_stat_t stat;
+
+    NET_TEST_CHECK( net_frame_encode( &buffer, net_frame_header( enet_command_ok, 0, 1 ) ) == enet_true );
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_true );
+    NET_TEST_CHECK( net_message_stat_decode( &frame, &stat ) == enet_false );
+
+    net_buffer_destroy( &buffer );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// MESSAGES
+/////////////////////////////////////////////////////////////////////////////////////////////////
+void test_codec_messages( ) {
+    net_buffer_t buffer = test_buffer( );
+    const uint8_t hash[ NET_SHA256_SIZE ] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    const char content[ ] = "chunk content";
+    net_frame_t frame;
+
+    // Every kind of field, the bin fields are length prefixed and the blob takes the rest.
+    net_message_delta_item_t item;
+
+    item.hash.data    = hash;
+    item.hash.size    = sizeof( hash );
+    item.size         = 123456;
+    item.content.data = (const uint8_t*)content;
+    item.content.size = sizeof( content );
+
+    NET_TEST_CHECK( net_message_delta_item_encode( &buffer, net_frame_header( enet_command_ok, 0, 9 ), &item ) == enet_true );
+    NET_TEST_CHECK( buffer.size == NET_FRAME_HEADER_SIZE + net_message_delta_item_size( &item ) );
+    NET_TEST_CHECK( net_message_delta_item_size( &item ) == 4 + sizeof( hash ) + 4 + 4 + sizeof( content ) );
+
+    net_message_send_t send = { net_frame_str( "name" ), { (const uint8_t*)content, sizeof( content ) } };
+
+    NET_TEST_CHECK( net_message_send_write( &buffer, &send ) == enet_true );
+    net_frame_seal( &buffer );
+
+    net_message_delta_item_t decoded_item;
+    net_message_send_t decoded_send;
+
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_true );
+    NET_TEST_CHECK( net_message_delta_item_decode( &frame, &decoded_item ) == enet_true );
+    NET_TEST_CHECK( decoded_item.hash.size == sizeof( hash ) );
+    NET_TEST_CHECK( memcmp( decoded_item.hash.data, hash, sizeof( hash ) ) == 0 );
+    NET_TEST_CHECK( decoded_item.size == 123456 );
+    NET_TEST_CHECK( decoded_item.content.size == sizeof( content ) );
+    NET_TEST_CHECK( memcmp( decoded_item.content.data, content, sizeof( content ) ) == 0 );
+
+    NET_TEST_CHECK( net_message_send_decode( &frame, &decoded_send ) == enet_true );
+    NET_TEST_CHECK( strcmp( decoded_send.name.data, "name" ) == 0 );
+    NET_TEST_CHECK( decoded_send.content.size == sizeof( content ) );
+    NET_TEST_CHECK( frame.head == frame.end );
+
+    // A bin longer than the payload.
+    net_message_chunk_ref_t ref = { { hash, sizeof( hash ) }, 42 };
+    net_message_chunk_ref_t decoded_ref;
+
+    NET_TEST_CHECK( net_message_chunk_ref_encode( &buffer, net_frame_header( enet_command_ok, 0, 1 ), &ref ) == enet_true );
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_true );
+    NET_TEST_CHECK( net_message_chunk_ref_decode( &frame, &decoded_ref ) == enet_true );
+    NET_TEST_CHECK( decoded_ref.size == 42 );
+
+    net_frame_put_u32( net_buffer_get_raw( &buffer ) + NET_FRAME_HEADER_SIZE, sizeof( hash ) + 1 );
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_true );
+    NET_TEST_CHECK( net_message_chunk_ref_decode( &frame, &decoded_ref ) == enet_false );
+
+    net_buffer_destroy( &buffer );
+}
+
+void test_codec_caps( ) {
+    net_message_caps_t local = { NET_FRAME_VERSION, NET_CAPS_FLAG_ALL, NET_CAPS_MAX_FRAME, 64 * 1024, 3, 8 };
+    net_message_caps_t remote = { NET_FRAME_VERSION, NET_CAPS_FLAG_STREAM | NET_CAPS_FLAG_HASH, 1024 * 1024, 16 * 1024, 1, 4 };
+
+    const net_message_caps_t caps = net_caps_select( &local, &remote );
+    const net_message_caps_t swapped = net_caps_select( &remote, &local );
+
+    NET_TEST_CHECK( caps.flags == ( NET_CAPS_FLAG_STREAM | NET_CAPS_FLAG_HASH ) );
+    NET_TEST_CHECK( caps.max_frame == 1024 * 1024 );
+    NET_TEST_CHECK( caps.chunk_size == 16 * 1024 );
+    NET_TEST_CHECK( memcmp( &caps, &swapped, sizeof( net_message_caps_t ) ) == 0 );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// COMPRESSION
+/////////////////////////////////////////////////////////////////////////////////////////////////
+void test_codec_compress( ) {
+    net_buffer_t buffer = test_buffer( );
+    net_buffer_t packed = test_buffer( );
+    net_buffer_t inflated = test_buffer( );
+    static uint8_t content[ 16 * 1024 ];
+    net_frame_t frame;
+
+    for ( uint32_t i = 0; i < sizeof( content ); i++ )
+        content[ i ] = (uint8_t)"compressible payload "[ i % 21 ];
+
+    net_message_chunk_t chunk = { { content, sizeof( content ) } };
+
+    NET_TEST_CHECK( net_message_chunk_encode( &buffer, net_frame_header( enet_command_chunk, NET_FRAME_FLAG_STREAM, 5 ), &chunk ) == enet_true );
+    NET_TEST_CHECK( net_frame_compress( &buffer, &packed ) == enet_true );
+    NET_TEST_CHECK( packed.size < buffer.size );
+
+    NET_TEST_CHECK( net_frame_decode( &packed, &frame ) == enet_true );
+    NET_TEST_CHECK( frame.header.flags == ( NET_FRAME_FLAG_STREAM | NET_FRAME_FLAG_LZ ) );
+    NET_TEST_CHECK( frame.header.request_id == 5 );
+
+    // Payloads inflating past the limit are refused before being decoded.
+    NET_TEST_CHECK( net_frame_inflate( &frame, &inflated, sizeof( content ) - 1 ) == enet_false );
+
+    NET_TEST_CHECK( net_frame_decode( &packed, &frame ) == enet_true );
+    NET_TEST_CHECK( net_frame_inflate( &frame, &inflated, sizeof( content ) ) == enet_true );
+    NET_TEST_CHECK( frame.header.flags == NET_FRAME_FLAG_STREAM );
+    NET_TEST_CHECK( frame.header.length == sizeof( content ) );
+
+    net_message_chunk_t decoded;
+
+    NET_TEST_CHECK( net_message_chunk_decode( &frame, &decoded ) == enet_true );
+    NET_TEST_CHECK( decoded.content.size == sizeof( content ) );
+    NET_TEST_CHECK( memcmp( decoded.content.data, content, sizeof( content ) ) == 0 );
+
+    // Small frames, encoded content and frames that are already compressed are kept as is.
+    NET_TEST_CHECK( net_frame_compress( &packed, &inflated ) == enet_false );
+
+    net_message_window_t window = { 1 };
+
+    NET_TEST_CHECK( net_message_window_encode( &buffer, net_frame_header( enet_command_window, 0, 5 ), &window ) == enet_true );
+    NET_TEST_CHECK( net_frame_compress( &buffer, &packed ) == enet_false );
+
+    NET_TEST_CHECK( net_message_chunk_encode( &buffer, net_frame_header( enet_command_chunk, NET_FRAME_FLAG_ENCODED, 5 ), &chunk ) == enet_true );
+    NET_TEST_CHECK( net_frame_compress( &buffer, &packed ) == enet_false );
+
+    // Frames without NET_FRAME_FLAG_LZ pass through inflate untouched.
+    NET_TEST_CHECK( net_frame_decode( &buffer, &frame ) == enet_true );
+
+    const uint8_t* head = frame.head;
+
+    NET_TEST_CHECK( net_frame_inflate( &frame, &inflated, 0 ) == enet_true );
+    NET_TEST_CHECK( frame.head == head );
+
+    net_buffer_destroy( &inflated );
+    net_buffer_destroy( &packed );
+    net_buffer_destroy( &buffer );
+}
+
+int main( int argc, char** argv ) {
+    (void)argc;
+    (void)argv;
+
+    test_codec_header( );
+    test_codec_rejects( );
+    test_codec_messages( );
+    test_codec_caps( );
+    test_codec_compress( );
+
+    return net_test_report( "codec" );
+}
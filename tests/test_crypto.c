@@ -0,0 +1,156 @@
+/************************************************************************************************
+ *
+ *  _   _      _                      _
+ * | \ | | ___| |___      _____  _ __| | __
+ * |  \| |/ _ \ __\ \ /\ / / _ \| '__| |/ /
+ * | |\  |  __/ |_ \ V  V / (_) | |  |   <
+ * |_| \_|\___|\__| \_/\_/ \___/|_|  |_|\_\
+ *
+ * @author ALVES Quentin
+ * @license MIT
+ *
+ ***********************************************************************************************/
+
+#include "../src/net_utils.h"
+#include "net_test.h"
+
+uint32_t net_crc32c_table_kernel( uint32_t crc, const uint8_t* data, size_t size );
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CHACHA20
+/////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * RFC 8439 section 2.4.2, encryption of the sunscreen plaintext.
+ **/
+void test_chacha20_vector( ) {
+    const char* plain =
+        "Ladies and Gentlemen of the class of '99: If I could offer you only one tip "
+        "for the future, sunscreen would be it.";
+    const char* cypher_hex =
+        "6e2e359a2568f98041ba0728dd0d6981e97e7aec1d4360c20a27afccfd9fae0b"
+        "f91b65c5524733ab8f593dabcd62b3571639d624e65152ab8f530c359f0861d8"
+        "07ca0dbf500d6a6156a38e088a22b65e52bc514d16ccf806818ce91ab7793736"
+        "5af90bbf74a35be6b40b8eedf2785e42874d";
+
+    uint8_t key[ NET_CHACHA20_KEY_SIZE ];
+    uint8_t nonce[ NET_CHACHA20_NONCE_SIZE ] = { 0, 0, 0, 0, 0, 0, 0, 0x4A, 0, 0, 0, 0 };
+    uint8_t expected[ 114 ];
+    uint8_t output[ 114 ];
+    const size_t size = strlen( plain );
+
+    for ( uint32_t i = 0; i < NET_CHACHA20_KEY_SIZE; i++ )
+        key[ i ] = (uint8_t)i;
+
+    NET_TEST_CHECK( size == sizeof( expected ) );
+    NET_TEST_CHECK( net_test_hex( cypher_hex, expected, sizeof( expected ) ) == sizeof( expected ) );
+
+    net_chacha20_t chacha;
+
+    net_chacha20_init( &chacha, key, nonce, 1 );
+    net_chacha20_xor( &chacha, (const uint8_t*)plain, output, size );
+
+    NET_TEST_CHECK( memcmp( output, expected, size ) == 0 );
+
+    // The keystream carries over between calls, any split gives the same bytes.
+    net_chacha20_init( &chacha, key, nonce, 1 );
+    net_chacha20_xor( &chacha, (const uint8_t*)plain, output, 7 );
+    net_chacha20_xor( &chacha, (const uint8_t*)plain + 7, output + 7, 64 );
+    net_chacha20_xor( &chacha, (const uint8_t*)plain + 71, output + 71, size - 71 );
+
+    NET_TEST_CHECK( memcmp( output, expected, size ) == 0 );
+
+    // Applying the same keystream again gives the plaintext back.
+    net_chacha20_init( &chacha, key, nonce, 1 );
+    net_chacha20_xor( &chacha, output, output, size );
+
+    NET_TEST_CHECK( memcmp( output, plain, size ) == 0 );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// SHA-256
+/////////////////////////////////////////////////////////////////////////////////////////////////
+enet_booleans test_sha256_equals( const void* data, const size_t size, const char* digest_hex ) {
+    uint8_t expected[ NET_SHA256_SIZE ];
+    uint8_t digest[ NET_SHA256_SIZE ];
+
+    net_test_hex( digest_hex, expected, sizeof( expected ) );
+    net_sha256( data, size, digest );
+
+    return ( memcmp( digest, expected, NET_SHA256_SIZE ) == 0 ) ? enet_true : enet_false;
+}
+
+/**
+ * FIPS 180-2 vectors, the two block message crosses the padding boundary.
+ **/
+void test_sha256_vector( ) {
+    const char* two_block = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+    NET_TEST_CHECK( test_sha256_equals( "", 0, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" ) == enet_true );
+    NET_TEST_CHECK( test_sha256_equals( "abc", 3, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" ) == enet_true );
+    NET_TEST_CHECK( test_sha256_equals( two_block, strlen( two_block ), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" ) == enet_true );
+
+    static uint8_t million[ 1000000 ];
+
+    memset( million, 'a', sizeof( million ) );
+
+    NET_TEST_CHECK( test_sha256_equals( million, sizeof( million ), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" ) == enet_true );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// CRC32C
+/////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Check value of the Castagnoli CRC and the RFC 3720 section B.4 vectors, on the kernel
+ * picked at run time and on the table one.
+ **/
+void test_crc32c_vector( ) {
+    uint8_t zeros[ 32 ];
+    uint8_t ones[ 32 ];
+    uint8_t ramp[ 32 ];
+
+    memset( zeros, 0x00, sizeof( zeros ) );
+    memset( ones, 0xFF, sizeof( ones ) );
+
+    for ( uint32_t i = 0; i < sizeof( ramp ); i++ )
+        ramp[ i ] = (uint8_t)i;
+
+    NET_TEST_CHECK( net_crc32c( "123456789", 9 ) == 0xE3069283 );
+    NET_TEST_CHECK( net_crc32c( zeros, sizeof( zeros ) ) == 0x8A9136AA );
+    NET_TEST_CHECK( net_crc32c( ones, sizeof( ones ) ) == 0x62A8AB43 );
+    NET_TEST_CHECK( net_crc32c( ramp, sizeof( ramp ) ) == 0x46DD794E );
+    NET_TEST_CHECK( net_crc32c( NULL, 0 ) == 0 );
+
+    NET_TEST_CHECK( ~net_crc32c_table_kernel( ~0u, (const uint8_t*)"123456789", 9 ) == 0xE3069283 );
+    NET_TEST_CHECK( ~net_crc32c_table_kernel( ~0u, ramp, sizeof( ramp ) ) == 0x46DD794E );
+
+    // Checksumming by pieces, or combining the pieces, gives the whole checksum.
+    uint32_t crc = net_crc32c_update( 0, "12345", 5 );
+
+    NET_TEST_CHECK( net_crc32c_update( crc, "6789", 4 ) == 0xE3069283 );
+    NET_TEST_CHECK( net_crc32c_combine( crc, net_crc32c( "6789", 4 ), 4 ) == 0xE3069283 );
+    NET_TEST_CHECK( net_crc32c_combine( net_crc32c( ramp, 0 ), net_crc32c( ramp, 32 ), 32 ) == 0x46DD794E );
+    NET_TEST_CHECK( net_crc32c_combine( net_crc32c( ramp, 32 ), net_crc32c( ramp, 0 ), 0 ) == 0x46DD794E );
+
+    static uint8_t large[ 200000 ];
+
+    for ( uint32_t i = 0; i < sizeof( large ); i++ )
+        large[ i ] = (uint8_t)( i * 2654435761u >> 24 );
+
+    const uint32_t split = 123457;
+
+    NET_TEST_CHECK(
+        net_crc32c_combine( net_crc32c( large, split ), net_crc32c( large + split, sizeof( large ) - split ), sizeof( large ) - split ) ==
+        net_crc32c( large, sizeof( large ) )
+    );
+}
+
+int main( int argc, char** argv ) {
+    (void)argc;
+    (void)argv;
+
+    test_chacha20_vector( );
+    test_sha256_vector( );
+    test_crc32c_vector( );
+
+    return net_test_report( "crypto" );
+}
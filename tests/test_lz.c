@@ -0,0 +1,261 @@
+/************************************************************************************************
+ *
+ *  _   _      _                      _
+ * | \ | | ___| |___      _____  _ __| | __
+ * |  \| |/ _ \ __\ \ /\ / / _ \| '__| |/ /
+ * | |\  |  __/ |_ \ V  V / (_) | |  |   <
+ * |_| \_|\___|\__| \_/\_/ \___/|_|  |_|\_\
+ *
+ * @author ALVES Quentin
+ * @license MIT
+ *
+ ***********************************************************************************************/
+
+#include "../src/net_utils.h"
+#include "net_test.h"
+
+#define TEST_LZ_MAX_SIZE ( 256 * 1024 )
+
+static uint8_t test_src[ TEST_LZ_MAX_SIZE ];
+static uint8_t test_block[ TEST_LZ_MAX_SIZE + TEST_LZ_MAX_SIZE / 128 + 64 ];
+static uint8_t test_dst[ TEST_LZ_MAX_SIZE ];
+
+static uint32_t test_seed = 0x2545F491;
+
+uint8_t test_random( ) {
+    test_seed ^= test_seed << 13;
+    test_seed ^= test_seed >> 17;
+    test_seed ^= test_seed << 5;
+
+    return (uint8_t)test_seed;
+}
+
+/**
+ * Walk the sequences of a block and check the LZ4 end of block rules : the last
+ * sequence is made of at least 5 literals and no match starts in the last 12 bytes.
+ **/
+enet_booleans test_lz_end_rules( const uint8_t* block, const uint32_t block_size, const uint32_t raw_size ) {
+    const uint8_t* src = block;
+    const uint8_t* end = block + block_size;
+    uint32_t pos = 0;
+
+    while ( src < end ) {
+        const uint8_t token = *src++;
+        uint32_t literals = token >> 4;
+
+        if ( literals == 15 ) {
+            for ( uint8_t extra = 255; extra == 255 && src < end; literals += extra )
+                extra = *src++;
+        }
+
+        src += literals;
+        pos += literals;
+
+        if ( src >= end )
+            return ( src == end && ( raw_size < 13 || literals >= 5 ) ) ? enet_true : enet_false;
+
+        if ( pos + 12 > raw_size )
+            return enet_false;
+
+        uint32_t length = ( token & 0x0F ) + 4;
+
+        src += 2;
+
+        if ( ( token & 0x0F ) == 15 ) {
+            for ( uint8_t extra = 255; extra == 255 && src < end; length += extra )
+                extra = *src++;
+        }
+
+        pos += length;
+
+        if ( pos + 5 > raw_size )
+            return enet_false;
+    }
+
+    return enet_false;
+}
+
+enet_booleans test_lz_round_trip( const uint8_t* src, const uint32_t size ) {
+    const uint32_t block_size = net_lz_compress( src, size, test_block, net_lz_bound( size ) );
+
+    if ( block_size == 0 || block_size > net_lz_bound( size ) )
+        return enet_false;
+
+    if ( test_lz_end_rules( test_block, block_size, size ) == enet_false )
+        return enet_false;
+
+    memset( test_dst, 0xCD, size );
+
+    if ( net_lz_decompress( test_block, block_size, test_dst, size ) == enet_false )
+        return enet_false;
+
+    return ( memcmp( test_dst, src, size ) == 0 ) ? enet_true : enet_false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// BLOCK
+/////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Under 13 bytes nothing may be matched, even a run of a single byte.
+ **/
+void test_lz_short( ) {
+    for ( uint32_t size = 0; size < 13; size++ ) {
+        memset( test_src, 'a', size );
+
+        const uint32_t block_size = net_lz_compress( test_src, size, test_block, net_lz_bound( size ) );
+
+        NET_TEST_CHECK( block_size == size + 1 );
+        NET_TEST_CHECK( test_block[ 0 ] == ( size << 4 ) );
+        NET_TEST_CHECK( test_lz_round_trip( test_src, size ) == enet_true );
+    }
+
+    // Past the limit the same run does compress.
+    memset( test_src, 'a', 64 );
+
+    NET_TEST_CHECK( net_lz_compress( test_src, 64, test_block, net_lz_bound( 64 ) ) < 64 );
+    NET_TEST_CHECK( test_lz_round_trip( test_src, 64 ) == enet_true );
+}
+
+void test_lz_compressible( ) {
+    const char* words[ 4 ] = { "chunk ", "store ", "frame ", "window " };
+    uint32_t size = 0;
+
+    while ( size + 8 < TEST_LZ_MAX_SIZE ) {
+        const char* word = words[ test_random( ) & 3 ];
+
+        memcpy( test_src + size, word, strlen( word ) );
+        size += (uint32_t)strlen( word );
+    }
+
+    NET_TEST_CHECK( net_lz_compress( test_src, size, test_block, net_lz_bound( size ) ) < size / 2 );
+
+    // Every size around the end of block limits, and longer lengths needing extensions.
+    for ( uint32_t length = 13; length < 300; length++ )
+        NET_TEST_CHECK( test_lz_round_trip( test_src, length ) == enet_true );
+
+    NET_TEST_CHECK( test_lz_round_trip( test_src, size ) == enet_true );
+
+    memset( test_src, 0x00, TEST_LZ_MAX_SIZE );
+
+    NET_TEST_CHECK( test_lz_round_trip( test_src, TEST_LZ_MAX_SIZE ) == enet_true );
+}
+
+void test_lz_incompressible( ) {
+    for ( uint32_t i = 0; i < TEST_LZ_MAX_SIZE; i++ )
+        test_src[ i ] = test_random( );
+
+    NET_TEST_CHECK( test_lz_round_trip( test_src, TEST_LZ_MAX_SIZE ) == enet_true );
+    NET_TEST_CHECK( test_lz_round_trip( test_src, 1000 ) == enet_true );
+
+    // The encoding gives up instead of growing the content.
+    net_buffer_t out;
+
+    memset( &out, 0x00, sizeof( net_buffer_t ) );
+    net_buffer_create( &out, 16 );
+
+    NET_TEST_CHECK( net_lz_encode( test_src, TEST_LZ_MAX_SIZE, &out ) == enet_false );
+    NET_TEST_CHECK( out.size == 0 );
+    NET_TEST_CHECK( net_lz_encode( test_src, 4, &out ) == enet_false );
+
+    net_buffer_destroy( &out );
+}
+
+void test_lz_corrupted( ) {
+    memset( test_src, 'z', 1024 );
+
+    const uint32_t block_size = net_lz_compress( test_src, 1024, test_block, net_lz_bound( 1024 ) );
+
+    NET_TEST_CHECK( net_lz_decompress( test_block, block_size, test_dst, 1024 ) == enet_true );
+
+    // Wrong raw size, truncated block and offset pointing before the output.
+    NET_TEST_CHECK( net_lz_decompress( test_block, block_size, test_dst, 1023 ) == enet_false );
+    NET_TEST_CHECK( net_lz_decompress( test_block, block_size, test_dst, 1025 ) == enet_false );
+    NET_TEST_CHECK( net_lz_decompress( test_block, block_size - 1, test_dst, 1024 ) == enet_false );
+
+    const uint8_t bad_offset[ 4 ] = { 0x10, 'z', 0x10, 0x00 };
+
+    NET_TEST_CHECK( net_lz_decompress( bad_offset, sizeof( bad_offset ), test_dst, 5 ) == enet_false );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// ENCODING
+/////////////////////////////////////////////////////////////////////////////////////////////////
+void test_lz_encoding( ) {
+    for ( uint32_t i = 0; i < TEST_LZ_MAX_SIZE; i++ )
+        test_src[ i ] = (uint8_t)( ( i % 251 ) ^ ( i / 4096 ) );
+
+    net_buffer_t out;
+
+    memset( &out, 0x00, sizeof( net_buffer_t ) );
+    net_buffer_create( &out, 16 );
+
+    NET_TEST_CHECK( net_lz_encode( test_src, TEST_LZ_MAX_SIZE, &out ) == enet_true );
+    NET_TEST_CHECK( out.size < TEST_LZ_MAX_SIZE );
+
+    const uint8_t* encoded = net_buffer_get_raw( &out );
+
+    NET_TEST_CHECK( net_lz_get_raw_size( encoded, out.size ) == TEST_LZ_MAX_SIZE );
+    NET_TEST_CHECK( net_lz_get_raw_size( encoded, 3 ) == 0 );
+
+    memset( test_dst, 0x00, TEST_LZ_MAX_SIZE );
+
+    NET_TEST_CHECK( net_lz_decode( encoded, out.size, test_dst ) == enet_true );
+    NET_TEST_CHECK( memcmp( test_dst, test_src, TEST_LZ_MAX_SIZE ) == 0 );
+
+    // The stream decoder gives the same bytes whatever the slices, skipped or read.
+    const uint32_t slices[ 4 ] = { 1, 13, 4096, 65535 };
+
+    for ( uint32_t s = 0; s < 4; s++ ) {
+        net_lz_stream_t stream;
+        uint32_t offset = 0;
+
+        memset( test_dst, 0x00, TEST_LZ_MAX_SIZE );
+
+        NET_TEST_CHECK( net_lz_stream_begin( &stream, encoded, out.size ) == enet_true );
+
+        while ( offset < TEST_LZ_MAX_SIZE ) {
+            uint32_t length = slices[ s ] + ( offset % 7 );
+
+            if ( length > TEST_LZ_MAX_SIZE - offset )
+                length = TEST_LZ_MAX_SIZE - offset;
+
+            if ( ( offset / length ) % 3 == 1 ) {
+                if ( net_lz_stream_skip( &stream, length ) == enet_false )
+                    break;
+
+                memcpy( test_dst + offset, test_src + offset, length );
+            } else if ( net_lz_stream_read( &stream, test_dst + offset, length ) == enet_false )
+                break;
+
+            offset += length;
+        }
+
+        NET_TEST_CHECK( offset == TEST_LZ_MAX_SIZE );
+        NET_TEST_CHECK( memcmp( test_dst, test_src, TEST_LZ_MAX_SIZE ) == 0 );
+        NET_TEST_CHECK( net_lz_stream_read( &stream, test_dst, 1 ) == enet_false );
+
+        net_lz_stream_end( &stream );
+    }
+
+    // A truncated encoding fails once the stream reaches the missing bytes.
+    net_lz_stream_t stream;
+
+    NET_TEST_CHECK( net_lz_stream_begin( &stream, encoded, out.size / 2 ) == enet_true );
+    NET_TEST_CHECK( net_lz_stream_skip( &stream, TEST_LZ_MAX_SIZE ) == enet_false );
+
+    net_lz_stream_end( &stream );
+    net_buffer_destroy( &out );
+}
+
+int main( int argc, char** argv ) {
+    (void)argc;
+    (void)argv;
+
+    test_lz_short( );
+    test_lz_compressible( );
+    test_lz_incompressible( );
+    test_lz_corrupted( );
+    test_lz_encoding( );
+
+    return net_test_report( "lz" );
+}
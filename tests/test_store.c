@@ -0,0 +1,300 @@
+/************************************************************************************************
+ *
+ *  _   _      _                      _
+ * | \ | | ___| |___      _____  _ __| | __
+ * |  \| |/ _ \ __\ \ /\ / / _ \| '__| |/ /
+ * | |\  |  __/ |_ \ V  V / (_) | |  |   <
+ * |_| \_|\___|\__| \_/\_/ \___/|_|  |_|\_\
+ *
+ * @author ALVES Quentin
+ * @license MIT
+ *
+ ***********************************************************************************************/
+
+// The store lives in the server translation unit, it is built in with its main renamed.
+#define main server_main
+#include "../src/server_tcp.c"
+#undef main
+
+#include "net_test.h"
+
+#define TEST_CHUNK_COUNT 6
+#define TEST_CHUNK_SIZE 4000
+
+static uint8_t test_data[ TEST_CHUNK_COUNT ][ TEST_CHUNK_SIZE ];
+static entry_chunk_t test_chunk_list[ TEST_CHUNK_COUNT ];
+static net_buffer_t test_scratch;
+
+void test_store_fill( const enet_booleans is_compressible ) {
+    uint32_t seed = 0x9E3779B9;
+
+    for ( uint32_t i = 0; i < TEST_CHUNK_COUNT; i++ ) {
+        for ( uint32_t j = 0; j < TEST_CHUNK_SIZE; j++ ) {
+            seed = seed * 1664525 + 1013904223;
+
+            test_data[ i ][ j ] = ( is_compressible == enet_true ) ? (uint8_t)( 'a' + ( j / 64 + i ) % 26 ) : (uint8_t)( seed >> 24 );
+        }
+
+        test_chunk_list[ i ].size = TEST_CHUNK_SIZE - i;
+        net_sha256( test_data[ i ], test_chunk_list[ i ].size, test_chunk_list[ i ].hash );
+    }
+}
+
+uint32_t test_store_refcount( const uint32_t i ) {
+    const uint32_t index = store_find( test_chunk_list[ i ].hash );
+
+    return ( index != STORE_NONE ) ? context->store.item_list[ index ].chunk.refcount : 0;
+}
+
+enet_booleans test_store_put( const uint32_t i, const enet_booleans is_referenced ) {
+    return store_put( test_data[ i ], test_chunk_list[ i ].size, test_chunk_list[ i ].hash, is_referenced, &test_scratch );
+}
+
+enet_booleans test_store_matches( const uint32_t i ) {
+    static uint8_t content[ TEST_CHUNK_SIZE ];
+
+    if ( store_load( test_chunk_list[ i ].hash, test_chunk_list[ i ].size, content, &test_scratch ) == enet_false )
+        return enet_false;
+
+    return ( memcmp( content, test_data[ i ], test_chunk_list[ i ].size ) == 0 ) ? enet_true : enet_false;
+}
+
+void test_store_reopen( ) {
+    store_close( );
+
+    NET_TEST_CHECK( store_open( ) == enet_true );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// LINK
+/////////////////////////////////////////////////////////////////////////////////////////////////
+void test_store_link( ) {
+    server_store_t* store = &context->store;
+
+    test_store_fill( enet_false );
+
+    // Storing the same content twice only takes a second reference.
+    NET_TEST_CHECK( test_store_put( 0, enet_true ) == enet_true );
+    NET_TEST_CHECK( test_store_put( 0, enet_true ) == enet_true );
+    NET_TEST_CHECK( store->item_count == 1 );
+    NET_TEST_CHECK( test_store_refcount( 0 ) == 2 );
+    NET_TEST_CHECK( test_store_matches( 0 ) == enet_true );
+
+    // Chunks uploaded ahead of their entry are kept without reference.
+    NET_TEST_CHECK( test_store_put( 1, enet_false ) == enet_true );
+    NET_TEST_CHECK( store->item_count == 2 );
+    NET_TEST_CHECK( test_store_refcount( 1 ) == 0 );
+
+    pthread_mutex_lock( &store->mutex );
+    NET_TEST_CHECK( store_acquire( test_chunk_list[ 1 ].hash ) == enet_true );
+    NET_TEST_CHECK( store_acquire( test_chunk_list[ 2 ].hash ) == enet_false );
+    pthread_mutex_unlock( &store->mutex );
+
+    NET_TEST_CHECK( test_store_refcount( 1 ) == 1 );
+
+    // Loading checks the size and never reads a missing chunk.
+    uint8_t content[ TEST_CHUNK_SIZE ];
+
+    NET_TEST_CHECK( store_load( test_chunk_list[ 0 ].hash, test_chunk_list[ 0 ].size - 1, content, &test_scratch ) == enet_false );
+    NET_TEST_CHECK( store_load( test_chunk_list[ 2 ].hash, test_chunk_list[ 2 ].size, content, &test_scratch ) == enet_false );
+
+    // The counts are written in place and the index is rebuilt from the pack.
+    test_store_reopen( );
+
+    NET_TEST_CHECK( store->item_count == 2 );
+    NET_TEST_CHECK( test_store_refcount( 0 ) == 2 );
+    NET_TEST_CHECK( test_store_refcount( 1 ) == 1 );
+    NET_TEST_CHECK( test_store_matches( 0 ) == enet_true );
+    NET_TEST_CHECK( test_store_matches( 1 ) == enet_true );
+
+    // A chunk is reclaimed with its last reference only.
+    pthread_mutex_lock( &store->mutex );
+    store_release( test_chunk_list[ 0 ].hash );
+    pthread_mutex_unlock( &store->mutex );
+
+    NET_TEST_CHECK( test_store_refcount( 0 ) == 1 );
+
+    store_release_list( test_chunk_list, 2, NULL );
+
+    NET_TEST_CHECK( store->item_count == 0 );
+    NET_TEST_CHECK( store_find( test_chunk_list[ 0 ].hash ) == STORE_NONE );
+    NET_TEST_CHECK( store_find( test_chunk_list[ 1 ].hash ) == STORE_NONE );
+    NET_TEST_CHECK( store->end == 0 );
+
+    // Releasing a chunk that isn't there is harmless.
+    pthread_mutex_lock( &store->mutex );
+    store_release( test_chunk_list[ 0 ].hash );
+    pthread_mutex_unlock( &store->mutex );
+
+    test_store_reopen( );
+
+    NET_TEST_CHECK( store->item_count == 0 );
+    NET_TEST_CHECK( store->hole_count == 0 );
+}
+
+void test_store_acquire_list( ) {
+    server_store_t* store = &context->store;
+    uint8_t missing_map[ 1 ] = { 0 };
+
+    test_store_fill( enet_false );
+
+    for ( uint32_t i = 0; i < TEST_CHUNK_COUNT; i += 2 )
+        NET_TEST_CHECK( test_store_put( i, enet_false ) == enet_true );
+
+    // Nothing is taken while a chunk is missing.
+    NET_TEST_CHECK( store_acquire_list( test_chunk_list, TEST_CHUNK_COUNT, NULL, missing_map ) == TEST_CHUNK_COUNT / 2 );
+    NET_TEST_CHECK( missing_map[ 0 ] == 0x2A );
+    NET_TEST_CHECK( test_store_refcount( 0 ) == 0 );
+
+    for ( uint32_t i = 1; i < TEST_CHUNK_COUNT; i += 2 )
+        NET_TEST_CHECK( test_store_put( i, enet_false ) == enet_true );
+
+    NET_TEST_CHECK( store_acquire_list( test_chunk_list, TEST_CHUNK_COUNT, NULL, NULL ) == 0 );
+
+    for ( uint32_t i = 0; i < TEST_CHUNK_COUNT; i++ )
+        NET_TEST_CHECK( test_store_refcount( i ) == 1 );
+
+    // The entry checksum is combined from the chunk checksums.
+    static uint8_t content[ TEST_CHUNK_COUNT * TEST_CHUNK_SIZE ];
+    uint32_t size = 0;
+    uint32_t crc = 0;
+
+    for ( uint32_t i = 0; i < TEST_CHUNK_COUNT; i++ ) {
+        memcpy( content + size, test_data[ i ], test_chunk_list[ i ].size );
+        size += test_chunk_list[ i ].size;
+    }
+
+    NET_TEST_CHECK( store_checksum_list( test_chunk_list, TEST_CHUNK_COUNT, &crc ) == enet_true );
+    NET_TEST_CHECK( crc == net_crc32c( content, size ) );
+
+    test_chunk_list[ 3 ].size -= 1;
+    NET_TEST_CHECK( store_checksum_list( test_chunk_list, TEST_CHUNK_COUNT, &crc ) == enet_false );
+    test_chunk_list[ 3 ].size += 1;
+
+    store_release_list( test_chunk_list, TEST_CHUNK_COUNT, NULL );
+
+    NET_TEST_CHECK( store->item_count == 0 );
+    NET_TEST_CHECK( store->end == 0 );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// HOLES
+/////////////////////////////////////////////////////////////////////////////////////////////////
+void test_store_holes( ) {
+    server_store_t* store = &context->store;
+
+    test_store_fill( enet_false );
+
+    for ( uint32_t i = 0; i < TEST_CHUNK_COUNT; i++ )
+        NET_TEST_CHECK( test_store_put( i, enet_true ) == enet_true );
+
+    const uint64_t end = store->end;
+    const uint32_t record_size = (uint32_t)sizeof( store_chunk_t ) + test_chunk_list[ 1 ].size;
+
+    // Neighbouring holes become one.
+    store_release_list( test_chunk_list + 1, 1, NULL );
+    store_release_list( test_chunk_list + 3, 1, NULL );
+
+    NET_TEST_CHECK( store->hole_count == 2 );
+
+    store_release_list( test_chunk_list + 2, 1, NULL );
+
+    NET_TEST_CHECK( store->hole_count == 1 );
+    NET_TEST_CHECK( store->hole_list[ 0 ].offset == sizeof( store_chunk_t ) + test_chunk_list[ 0 ].size );
+    NET_TEST_CHECK( store->end == end );
+
+    test_store_reopen( );
+
+    NET_TEST_CHECK( store->item_count == 3 );
+    NET_TEST_CHECK( store->hole_count == 1 );
+    NET_TEST_CHECK( test_store_matches( 4 ) == enet_true );
+
+    // A chunk fits in the merged hole instead of growing the pack.
+    NET_TEST_CHECK( test_store_put( 1, enet_true ) == enet_true );
+    NET_TEST_CHECK( store->end == end );
+    NET_TEST_CHECK( store->item_list[ store_find( test_chunk_list[ 1 ].hash ) ].offset == store->hole_list[ 0 ].offset - record_size );
+
+    // A hole reaching the end of the pack gives its space back.
+    store_release_list( test_chunk_list + 5, 1, NULL );
+    store_release_list( test_chunk_list + 4, 1, NULL );
+
+    NET_TEST_CHECK( store->hole_count == 0 );
+    NET_TEST_CHECK( store->end == sizeof( store_chunk_t ) * 2 + test_chunk_list[ 0 ].size + test_chunk_list[ 1 ].size );
+
+    test_store_reopen( );
+
+    NET_TEST_CHECK( store->item_count == 2 );
+    NET_TEST_CHECK( store->hole_count == 0 );
+    NET_TEST_CHECK( test_store_matches( 0 ) == enet_true );
+    NET_TEST_CHECK( test_store_matches( 1 ) == enet_true );
+
+    store_release_list( test_chunk_list, 2, NULL );
+
+    NET_TEST_CHECK( store->end == 0 );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// COMPRESSION
+/////////////////////////////////////////////////////////////////////////////////////////////////
+void test_store_compression( ) {
+    server_store_t* store = &context->store;
+
+    context->compression_modes = enet_compression_lz;
+
+    test_store_fill( enet_true );
+    NET_TEST_CHECK( test_store_put( 0, enet_true ) == enet_true );
+
+    const store_chunk_t* chunk = &store->item_list[ store_find( test_chunk_list[ 0 ].hash ) ].chunk;
+
+    NET_TEST_CHECK( ( chunk->flags & STORE_FLAG_LZ ) != 0 );
+    NET_TEST_CHECK( chunk->stored_size < chunk->raw_size );
+    NET_TEST_CHECK( chunk->crc == net_crc32c( test_data[ 0 ], test_chunk_list[ 0 ].size ) );
+    NET_TEST_CHECK( test_store_matches( 0 ) == enet_true );
+
+    // Content that doesn't shrink is stored as is.
+    test_store_fill( enet_false );
+    NET_TEST_CHECK( test_store_put( 0, enet_true ) == enet_true );
+
+    chunk = &store->item_list[ store_find( test_chunk_list[ 0 ].hash ) ].chunk;
+
+    NET_TEST_CHECK( ( chunk->flags & STORE_FLAG_LZ ) == 0 );
+    NET_TEST_CHECK( chunk->stored_size == chunk->raw_size );
+
+    test_store_reopen( );
+
+    NET_TEST_CHECK( test_store_matches( 0 ) == enet_true );
+
+    test_store_fill( enet_true );
+
+    NET_TEST_CHECK( test_store_matches( 0 ) == enet_true );
+
+    context->compression_modes = 0;
+}
+
+int main( int argc, char** argv ) {
+    (void)argc;
+    (void)argv;
+
+    char directory[ ] = "/tmp/net_test_store_XXXXXX";
+
+    if ( mkdtemp( directory ) == NULL || chdir( directory ) != 0 || load_db( ) == enet_false || store_open( ) == enet_false ) {
+        printf( "> Can't open a chunk store in %s.\n", directory );
+        return 1;
+    }
+
+    memset( &test_scratch, 0x00, sizeof( net_buffer_t ) );
+    net_buffer_create( &test_scratch, 16 );
+
+    test_store_link( );
+    test_store_acquire_list( );
+    test_store_holes( );
+    test_store_compression( );
+
+    net_buffer_destroy( &test_scratch );
+    store_close( );
+
+    unlink( STORE_FILE );
+    rmdir( directory );
+
+    return net_test_report( "store" );
+}